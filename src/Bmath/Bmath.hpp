@@ -377,6 +377,7 @@ namespace Rmath{
   double pwilcox(double, double, double, int, int);
   double qwilcox(double, double, double, int, int);
   double rwilcox(double, double);
+  double rwilcox_mt(RNG &, double, double);
 
   /* Wilcoxon Signed Rank Distribution */
 
@@ -384,6 +385,7 @@ namespace Rmath{
   double psignrank(double, double, int, int);
   double qsignrank(double, double, int, int);
   double rsignrank(double);
+  double rsignrank_mt(RNG &, double);
 
   /* Gamma and Related Functions */
   inline double	gammafn(double x){return ::tgamma(x);}
@@ -52,7 +52,7 @@ namespace Rmath{
   double rbeta_mt(BOOM::RNG & rng, double aa, double bb);
 
   double rbeta(double a, double b){
-    return rbeta_mt(BOOM::GlobalRng::rng, a,b);
+    return rbeta_mt(BOOM::default_rng(), a,b);
   }
 
   double rbeta_mt(BOOM::RNG & rng, double aa, double bb){
@@ -143,8 +143,8 @@ unsigned int rbinom(int  nin, double pp)
     /*-------------------------- np = n*p >= 30 : ------------------- */
     //    repeat {
     while(true){
-      u = unif_rand(BOOM::GlobalRng::rng) * p4;
-      v = unif_rand(BOOM::GlobalRng::rng);
+      u = unif_rand(BOOM::default_rng()) * p4;
+      v = unif_rand(BOOM::default_rng());
       /* triangular region */
       if (u <= p1) {
 	ix = static_cast<int>(xm - p1 * v + u);
@@ -215,7 +215,7 @@ unsigned int rbinom(int  nin, double pp)
     //    repeat {
      ix = 0;
      f = qn;
-     u = unif_rand(BOOM::GlobalRng::rng);
+     u = unif_rand(BOOM::default_rng());
      //     repeat {
      while(true){
 	 if (u < f)
@@ -59,7 +59,7 @@ double rcauchy_mt(BOOM::RNG & rng, double location, double scale)
 }
 
 double rcauchy(double location, double scale){
-  return rcauchy_mt(BOOM::GlobalRng::rng, location, scale);
+  return rcauchy_mt(BOOM::default_rng(), location, scale);
 }
 
 }
@@ -60,7 +60,7 @@ double rchisq_mt(BOOM::RNG & rng, double df){
 }
 
 double rchisq(double df){
-  return rchisq_mt(BOOM::GlobalRng::rng, df);
+  return rchisq_mt(BOOM::default_rng(), df);
 }
 
 
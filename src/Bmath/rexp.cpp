@@ -59,7 +59,7 @@ double rexp_mt(BOOM::RNG & rng, double scale)
 }
 
 double rexp(double scale){
-  return rexp_mt(BOOM::GlobalRng::rng, scale);
+  return rexp_mt(BOOM::default_rng(), scale);
 }
 
 
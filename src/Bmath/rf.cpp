@@ -53,7 +53,7 @@
 namespace Rmath{
 
 double rf(double n1, double n2){
-  return rf_mt(BOOM::GlobalRng::rng, n1, n2);
+  return rf_mt(BOOM::default_rng(), n1, n2);
 }
 
 double rf_mt(RNG & rng, double n1, double n2)
@@ -241,7 +241,7 @@ double rgamma_mt(BOOM::RNG & rng, double a, double scale)
 }
 
 double rgamma(double a, double b){
-  return rgamma_mt(BOOM::GlobalRng::rng, a, b);
+  return rgamma_mt(BOOM::default_rng(), a, b);
 }
 
 
@@ -68,6 +68,6 @@ double rgeom_mt(BOOM::RNG & rng, double p)
 }
 
 double rgeom(double p){
-  return rgeom_mt(BOOM::GlobalRng::rng, p);
+  return rgeom_mt(BOOM::default_rng(), p);
 }
 }
@@ -92,7 +92,7 @@ static double afc(int i)
 }
 
 double rhyper(double nn1in, double nn2in, double kkin){
-  return rhyper_mt(BOOM::GlobalRng::rng, nn1in, nn2in, kkin); }
+  return rhyper_mt(BOOM::default_rng(), nn1in, nn2in, kkin); }
 
 double rhyper_mt(BOOM::RNG & rng, double nn1in, double nn2in, double kkin)
 {
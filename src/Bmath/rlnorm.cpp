@@ -49,7 +49,7 @@
 namespace Rmath{
 
 double rlnorm(double logmean, double logsd){
-  return rlnorm_mt(BOOM::GlobalRng::rng, logmean, logsd); }
+  return rlnorm_mt(BOOM::default_rng(), logmean, logsd); }
 
 double rlnorm_mt(RNG & rng, double logmean, double logsd)
 {
@@ -53,6 +53,6 @@ double rlogis_mt(BOOM::RNG & rng, double location, double scale)
     return location + scale * log(u / (1. - u));
 }
 double rlogis(double location, double scale){
-  return rlogis_mt(BOOM::GlobalRng::rng, location, scale);
+  return rlogis_mt(BOOM::default_rng(), location, scale);
 }
 }
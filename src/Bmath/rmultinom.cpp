@@ -70,12 +70,12 @@ namespace Rmath{
   }
 
   void rmultinom(int n, const std::vector<double> &prob, std::vector<int> &result){
-    rmultinom_mt(BOOM::GlobalRng::rng, n, prob, result);
+    rmultinom_mt(BOOM::default_rng(), n, prob, result);
   }
 
   std::vector<int> rmultinom(int n, const std::vector<double> &prob){
     std::vector<int> result;
-    rmultinom_mt(BOOM::GlobalRng::rng, n, prob, result);
+    rmultinom_mt(BOOM::default_rng(), n, prob, result);
     return result;
   }
 
@@ -64,7 +64,7 @@
 namespace Rmath{
 
 double rnbinom(double n /* size */, double p /* prob */){
-  return rnbinom_mt(BOOM::GlobalRng::rng, n,p);
+  return rnbinom_mt(BOOM::default_rng(), n,p);
 }
 
 double rnbinom_mt(RNG & rng, double n /* size */, double p /* prob */)
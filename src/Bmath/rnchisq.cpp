@@ -76,7 +76,7 @@
 namespace Rmath{
 
 double rnchisq(double df, double lambda){
-  return rnchisq_mt(BOOM::GlobalRng::rng, df, lambda);
+  return rnchisq_mt(BOOM::default_rng(), df, lambda);
 } 
 
 double rnchisq_mt(RNG & rng, double df, double lambda)
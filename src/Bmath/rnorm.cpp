@@ -67,7 +67,7 @@ namespace Rmath{
   }
 
   double rnorm(double mu, double sigma){
-    return rnorm_mt(BOOM::GlobalRng::rng, mu, sigma);
+    return rnorm_mt(BOOM::default_rng(), mu, sigma);
   }
 
 }
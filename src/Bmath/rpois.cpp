@@ -136,7 +136,7 @@ double rpois(double mu)
 
 	    repeat {
 		/* Step U. uniform sample for inversion method */
-		u = unif_rand(BOOM::GlobalRng::rng);
+		u = unif_rand(BOOM::default_rng());
 		if (u <= p0)
 		    return 0.;
 
@@ -171,7 +171,7 @@ double rpois(double mu)
 /* Only if mu >= 10 : ----------------------- */
 
     /* Step N. normal sample */
-    g = mu + s * norm_rand(BOOM::GlobalRng::rng);/* norm_rand() ~ N(0,1), standard normal */
+    g = mu + s * norm_rand(BOOM::default_rng());/* norm_rand() ~ N(0,1), standard normal */
 
     if (g >= 0.) {
 	pois = FLOOR(g);
@@ -181,7 +181,7 @@ double rpois(double mu)
 	/* Step S. squeeze acceptance */
 	fk = pois;
 	difmuk = mu - fk;
-	u = unif_rand(BOOM::GlobalRng::rng); /* ~ U(0,1) - sample */
+	u = unif_rand(BOOM::default_rng()); /* ~ U(0,1) - sample */
 	if (d * u >= difmuk * difmuk * difmuk)
 	    return pois;
     }
@@ -217,11 +217,11 @@ double rpois(double mu)
     repeat {
 	/* Step E. Exponential Sample */
 
-	E = exp_rand(BOOM::GlobalRng::rng);	/* ~ Exp(1) (standard exponential) */
+	E = exp_rand(BOOM::default_rng());	/* ~ Exp(1) (standard exponential) */
 
 	/*  sample t from the laplace 'hat'
 	    (if t <= -0.6744 then pk < fk for all mu >= 10.) */
-	u = 2 * unif_rand(BOOM::GlobalRng::rng) - 1.;
+	u = 2 * unif_rand(BOOM::default_rng()) - 1.;
 	t = 1.8 + fsign(E, u);
 	if (t > -0.6744) {
 	    pois = FLOOR(mu + s * t);
@@ -63,6 +63,6 @@ double rt_mt(BOOM::RNG & rng, double df)
 }
 
 double rt(double df){
-  return rt_mt(BOOM::GlobalRng::rng, df);
+  return rt_mt(BOOM::default_rng(), df);
 }
 }
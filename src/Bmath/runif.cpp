@@ -53,6 +53,6 @@ double runif_mt(BOOM::RNG & rng, double a, double b)
 }
 
 double runif(double a, double b){
-  return runif_mt(BOOM::GlobalRng::rng, a, b);
+  return runif_mt(BOOM::default_rng(), a, b);
 }
 }
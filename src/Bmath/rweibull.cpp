@@ -53,6 +53,6 @@ double rweibull_mt(BOOM::RNG & rng, double shape, double scale)
 }
 
 double rweibull(double shape, double scale){
-  return rweibull_mt(BOOM::GlobalRng::rng, shape, scale);
+  return rweibull_mt(BOOM::default_rng(), shape, scale);
 }
 }
@@ -265,7 +265,11 @@ double qsignrank(double x, double n, int lower_tail, int log_p)
     return(q);
 }
 
-double rsignrank(double n)
+double rsignrank(double n){
+  return rsignrank_mt(BOOM::default_rng(), n);
+}
+
+double rsignrank_mt(BOOM::RNG &rng, double n)
 {
     int i, k;
     double r;
@@ -282,7 +286,7 @@ double rsignrank(double n)
     r = 0.0;
     k = (int) n;
     for (i = 0; i < k; ) {
-      r += (++i) * FLOOR(unif_rand(BOOM::GlobalRng::rng) + 0.5);
+      r += (++i) * FLOOR(unif_rand(rng) + 0.5);
     }
     return(r);
 }
@@ -303,7 +303,11 @@ double qwilcox(double x, double m, double n, int lower_tail, int log_p)
     return(q);
 }
 
-double rwilcox(double m, double n)
+double rwilcox(double m, double n){
+  return rwilcox_mt(BOOM::default_rng(), m, n);
+}
+
+double rwilcox_mt(BOOM::RNG &rng, double m, double n)
 {
     int i, j, k, *x;
     double r;
@@ -329,7 +333,7 @@ double rwilcox(double m, double n)
     for (i = 0; i < k; i++)
 	x[i] = i;
     for (i = 0; i < n; i++) {
-        j = FLOOR(k * unif_rand(BOOM::GlobalRng::rng));
+        j = FLOOR(k * unif_rand(rng));
 	r += x[j];
 	x[j] = x[--k];
     }
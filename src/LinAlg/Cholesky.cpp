@@ -18,6 +18,8 @@
 #include "Cholesky.hpp"
 #include <cpputil/report_error.hpp>
 #include <sstream>
+#include <algorithm>
+#include <cmath>
 #include "Vector.hpp"
 
 extern "C"{
@@ -47,7 +49,7 @@ namespace BOOM{
       if(!m.is_square()){
 	pos_def=false;
 	dcmp = Matrix();
-      } else{
+      } else if(m.nrow() > 0){
 	int info=0;
 	int n = m.nrow();
 	dpotrf_("L", &n, dcmp.data(), &n, &info);
@@ -128,6 +130,81 @@ namespace BOOM{
       return ans;
     }
 
+    Vector Chol::Lsolve(const Vector &b)const{
+      check();
+      if(dim() == 0) return b;
+      return BOOM::Lsolve(dcmp, b);
+    }
+
+    bool Chol::add_row(const Vector &row){
+      check();
+      uint n = dim();
+      if(row.size() != n + 1){
+        std::ostringstream err;
+        err << "Chol::add_row expects a row of length " << n + 1
+            << " but got one of length " << row.size() << "." << std::endl;
+        report_error(err.str());
+      }
+      // If L is the current factor, the new last row of the factor is
+      // (l^T, d) with L l = a and d^2 = alpha - l^T l.
+      Vector l(n);
+      std::copy(row.begin(), row.begin() + n, l.begin());
+      if(n > 0) BOOM::Lsolve_inplace(dcmp, l);
+      double d2 = row[n] - l.normsq();
+      if(!(d2 > 0)) return false;
+
+      Matrix ans(n + 1, n + 1, 0.0);
+      for(uint j = 0; j < n; ++j){
+        std::copy(dcmp.col_begin(j) + j, dcmp.col_end(j),
+                  ans.col_begin(j) + j);
+        ans(n, j) = l[j];
+      }
+      ans(n, n) = std::sqrt(d2);
+      dcmp.swap(ans);
+      return true;
+    }
+
+    void Chol::drop_row(uint i){
+      check();
+      uint n = dim();
+      if(i >= n){
+        std::ostringstream err;
+        err << "Chol::drop_row cannot drop row " << i
+            << " from a decomposition of dimension " << n << "." << std::endl;
+        report_error(err.str());
+      }
+      // Deleting row i of L leaves the leading columns lower
+      // triangular.  The trailing block L33 loses its contribution
+      // from column i, so it must satisfy L33' L33'^T = L33 L33^T + x
+      // x^T, where x is the part of column i below the diagonal.  That
+      // is a rank one update, done here with Givens rotations.
+      Matrix ans(n - 1, n - 1, 0.0);
+      for(uint j = 0; j < n; ++j){
+        if(j == i) continue;
+        uint col = j < i ? j : j - 1;
+        for(uint r = j; r < n; ++r){
+          if(r == i) continue;
+          ans(r < i ? r : r - 1, col) = dcmp(r, j);
+        }
+      }
+      uint m = n - 1 - i;
+      Vector x(m);
+      for(uint r = 0; r < m; ++r) x[r] = dcmp(i + 1 + r, i);
+      for(uint k = 0; k < m; ++k){
+        double &Lkk(ans(i + k, i + k));
+        double r = ::hypot(Lkk, x[k]);
+        double c = r / Lkk;
+        double s = x[k] / Lkk;
+        Lkk = r;
+        for(uint j = k + 1; j < m; ++j){
+          double &Ljk(ans(i + j, i + k));
+          Ljk = (Ljk + s * x[j]) / c;
+          x[j] = c * x[j] - s * Ljk;
+        }
+      }
+      dcmp.swap(ans);
+    }
+
     // returns the log of the determinant of A
     double Chol::logdet()const{
       ConstVectorView d(diag(dcmp));
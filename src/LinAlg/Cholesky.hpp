@@ -38,6 +38,19 @@ namespace BOOM{
       double logdet()const;  // log(det(A))
       bool is_pos_def()const{return pos_def;}
       Chol & operator *= (double a);
+
+      // If *this is the decomposition of A then L^{-1} b.
+      Vector Lsolve(const Vector &b)const;
+
+      // Updates the decomposition of the n x n matrix A to that of
+      // the (n+1) x (n+1) matrix [A a; a^T alpha], where 'row' is
+      // (a^T, alpha).  Costs O(n^2).  Returns false, and leaves *this
+      // unchanged, if the enlarged matrix is not positive definite.
+      bool add_row(const Vector &row);
+
+      // Updates the decomposition of A to that of A with row and
+      // column i removed.  Costs O(n^2).
+      void drop_row(uint i);
      private:
       Matrix dcmp;
       bool pos_def;
@@ -513,9 +513,9 @@ namespace BOOM{
      int n = R.nrow();
      int k = R.ncol();
      cblas_dsyrk(CblasColMajor, CblasUpper, CblasTrans,
-       	  n,k, a,
+       	  k,n, a,
        	  R.data(), n,
-       	  0.0, ans.data(), n);
+       	  0.0, ans.data(), k);
      ans.reflect();
      return ans;
    }
@@ -321,6 +321,140 @@ namespace BOOM {
       return ans;
     }
 
+    //======================================================================
+    BinnedPredictorStore::BinnedPredictorStore()
+        : number_of_rows_(0),
+          finalized_(false),
+          stale_(false)
+    {}
+
+    //----------------------------------------------------------------------
+    void BinnedPredictorStore::add_row(const ConstVectorView &x) {
+      if (finalized_) {
+        clear();
+        stale_ = true;
+      }
+      if (stale_) return;
+      if (columns_.empty()) {
+        columns_.resize(x.size());
+      } else if (x.size() != columns_.size()) {
+        report_error("Wrong sized predictor vector passed to "
+                     "BinnedPredictorStore::add_row.");
+      }
+      for (int i = 0; i < x.size(); ++i) {
+        add_value(columns_[i], x[i]);
+      }
+      ++number_of_rows_;
+    }
+
+    //----------------------------------------------------------------------
+    void BinnedPredictorStore::add_value(Column &column, double x) {
+      if (column.raw) {
+        column.values.push_back(x);
+        return;
+      }
+      std::map<double, int>::iterator it = column.codes_by_value.lower_bound(x);
+      int code;
+      if (it != column.codes_by_value.end() && it->first == x) {
+        code = it->second;
+      } else {
+        code = column.distinct_values.size();
+        if (code == 65536) {
+          // Too many distinct values for a compact code.
+          convert_to_raw(column);
+          column.values.push_back(x);
+          return;
+        }
+        column.codes_by_value.insert(it, std::make_pair(x, code));
+        column.distinct_values.push_back(x);
+        if (code == 256) {
+          column.short_codes.assign(column.byte_codes.begin(),
+                                    column.byte_codes.end());
+          std::vector<unsigned char>().swap(column.byte_codes);
+        }
+      }
+      if (column.distinct_values.size() > 256) {
+        column.short_codes.push_back(code);
+      } else {
+        column.byte_codes.push_back(code);
+      }
+    }
+
+    //----------------------------------------------------------------------
+    void BinnedPredictorStore::convert_to_raw(Column &column) {
+      column.values.reserve(number_of_rows_ + 1);
+      for (int row = 0; row < number_of_rows_; ++row) {
+        int code = column.short_codes.empty() ?
+            column.byte_codes[row] : column.short_codes[row];
+        column.values.push_back(column.distinct_values[code]);
+      }
+      std::vector<unsigned char>().swap(column.byte_codes);
+      std::vector<unsigned short>().swap(column.short_codes);
+      std::map<double, int>().swap(column.codes_by_value);
+      Vector().swap(column.distinct_values);
+      column.raw = true;
+    }
+
+    //----------------------------------------------------------------------
+    // Codes are assigned in order of first appearance as rows are
+    // added.  Finalizing sorts the distinct values and maps each code
+    // to the rank of the value it encodes.
+    void BinnedPredictorStore::finalize() {
+      if (finalized_ || stale_) return;
+      for (int i = 0; i < columns_.size(); ++i) {
+        Column &column(columns_[i]);
+        if (column.raw) continue;
+        std::vector<int> rank(column.distinct_values.size());
+        int r = 0;
+        for (std::map<double, int>::const_iterator it =
+                 column.codes_by_value.begin();
+             it != column.codes_by_value.end(); ++it, ++r) {
+          rank[it->second] = r;
+          column.distinct_values[r] = it->first;
+        }
+        for (int row = 0; row < column.byte_codes.size(); ++row) {
+          column.byte_codes[row] = rank[column.byte_codes[row]];
+        }
+        for (int row = 0; row < column.short_codes.size(); ++row) {
+          column.short_codes[row] = rank[column.short_codes[row]];
+        }
+        std::map<double, int>().swap(column.codes_by_value);
+      }
+      finalized_ = true;
+    }
+
+    //----------------------------------------------------------------------
+    void BinnedPredictorStore::clear() {
+      columns_.clear();
+      number_of_rows_ = 0;
+      finalized_ = false;
+      stale_ = false;
+    }
+
+    //----------------------------------------------------------------------
+    BinnedPredictorStore::ColumnSplit BinnedPredictorStore::split(
+        int variable_index, double cutpoint) const {
+      if (!finalized_) {
+        report_error("BinnedPredictorStore::split called before "
+                     "finalize().");
+      }
+      const Column &column(columns_[variable_index]);
+      if (column.raw) {
+        return ColumnSplit(NULL, NULL, &column.values[0], 0, cutpoint);
+      }
+      int threshold = std::lower_bound(column.distinct_values.begin(),
+                                       column.distinct_values.end(),
+                                       cutpoint)
+          - column.distinct_values.begin();
+      if (!column.byte_codes.empty()) {
+        return ColumnSplit(&column.byte_codes[0], NULL, NULL,
+                           threshold, cutpoint);
+      } else {
+        return ColumnSplit(NULL, &column.short_codes[0], NULL,
+                           threshold, cutpoint);
+      }
+    }
+
     //======================================================================
 
     TreeNode::TreeNode(double mean_value, TreeNode *parent)
@@ -969,7 +1103,8 @@ namespace BOOM {
   BartModelBase::BartModelBase(const BartModelBase &rhs)
       : Model(rhs),
         variable_summaries_(rhs.variable_summaries_),
-        trees_(rhs.trees_)
+        trees_(rhs.trees_),
+        predictor_store_(rhs.predictor_store_)
   {
     for (int i = 0; i < trees_.size(); ++i) {
       trees_[i].reset(new Bart::Tree(*(rhs.trees_[i])));
@@ -1031,6 +1166,7 @@ namespace BOOM {
       variable_summaries_[i].finalize(discrete_distribution_cutoff,
                                       strategy);
     }
+    predictor_store_.finalize();
   }
 
   //----------------------------------------------------------------------
@@ -1059,6 +1195,11 @@ namespace BOOM {
     return trees_[which_tree].get();
   }
 
+  //----------------------------------------------------------------------
+  const Bart::BinnedPredictorStore & BartModelBase::predictor_store() const {
+    return predictor_store_;
+  }
+
   //----------------------------------------------------------------------
   void BartModelBase::observe_data(const Vector &x) {
     ConstVectorView view(x);
@@ -1072,6 +1213,7 @@ namespace BOOM {
     for (int i = 0; i < xdim; ++i) {
       variable_summaries_[i].observe_value(x[i]);
     }
+    predictor_store_.add_row(x);
   }
 
   //----------------------------------------------------------------------
@@ -19,6 +19,7 @@
 #ifndef BOOM_BART_HPP_
 #define BOOM_BART_HPP_
 
+#include <map>
 #include <set>
 #include <distributions/rng.hpp>
 #include <Models/Policies/ParamPolicy_1.hpp>
@@ -63,6 +64,14 @@ namespace BOOM {
       // Add relevant functions of data to the sufficient statistics
       // being modeled.
       virtual void update(const ResidualRegressionData &data) = 0;
+
+      // Add the information in rhs to *this.  This allows sufficient
+      // statistics to be accumulated over disjoint subsets of the
+      // data (e.g. in different threads) and then reduced.  It is an
+      // error to combine sufficient statistics of different concrete
+      // types.
+      virtual void combine(const SufficientStatisticsBase &rhs) = 0;
+
       virtual SufficientStatisticsBase * create() const {
         SufficientStatisticsBase * ans = clone();
         ans->clear();
@@ -231,6 +240,112 @@ namespace BOOM {
       double hi_;
     };
 
+    //======================================================================
+    // A column-major copy of the predictors observed by a Bart model,
+    // used to evaluate candidate splits without touching each
+    // observation's full predictor vector.  Each variable is encoded
+    // by the rank of its value among the distinct values observed for
+    // that variable.  The encoding preserves order, so x < cutpoint
+    // exactly when rank(x) < (number of distinct values < cutpoint).
+    // Ranks are stored in 8 or 16 bits when there are few enough
+    // distinct values.  Variables with more than 65536 distinct values
+    // are stored as raw doubles.
+    //
+    // Rows are encoded as they are added with add_row(), so the store
+    // never holds a full copy of the predictors.  Until finalize() is
+    // called a value's code is its order of first appearance.
+    // finalize() replaces these with ranks, in place.  A variable is
+    // only converted to raw doubles when it sees its 65537th distinct
+    // value.  Adding rows after finalize() leaves the store out of
+    // date, so it is emptied and ignores further rows until clear()
+    // is called.  Callers should check finalized() and
+    // number_of_rows() before using the store.
+    class BinnedPredictorStore {
+     public:
+      // A split on a single variable, ready to be applied to rows of
+      // the store.
+      class ColumnSplit {
+       public:
+        ColumnSplit(const unsigned char *byte_codes,
+                    const unsigned short *short_codes,
+                    const double *values,
+                    int threshold,
+                    double cutpoint)
+            : byte_codes_(byte_codes),
+              short_codes_(short_codes),
+              values_(values),
+              threshold_(threshold),
+              cutpoint_(cutpoint)
+        {}
+
+        // Returns true iff x[variable] < cutpoint for the observation
+        // in the given row.
+        bool goes_left(int row) const {
+          if (byte_codes_) return byte_codes_[row] < threshold_;
+          if (short_codes_) return short_codes_[row] < threshold_;
+          return values_[row] < cutpoint_;
+        }
+
+       private:
+        // Exactly one of the three column pointers is non-NULL.
+        const unsigned char *byte_codes_;
+        const unsigned short *short_codes_;
+        const double *values_;
+        int threshold_;
+        double cutpoint_;
+      };
+
+      BinnedPredictorStore();
+
+      // Append an observation to the store.  All rows must have the
+      // same dimension.
+      void add_row(const ConstVectorView &x);
+
+      // Build the compact encoding for each variable.
+      void finalize();
+
+      // Remove all rows and encodings.
+      void clear();
+
+      bool finalized() const {return finalized_;}
+      int number_of_rows() const {return number_of_rows_;}
+      int number_of_variables() const {return columns_.size();}
+
+      // Returns the split rule x[variable_index] < cutpoint.  The
+      // store must be finalized.
+      ColumnSplit split(int variable_index, double cutpoint) const;
+
+     private:
+      struct Column {
+        Column() : raw(false) {}
+        // The distinct values of the variable.  Sorted once the store
+        // is finalized, and in order of first appearance before that.
+        // Empty if the variable is stored as raw values.
+        Vector distinct_values;
+        // Maps each distinct value to its code while rows are being
+        // added.  Emptied by finalize().
+        std::map<double, int> codes_by_value;
+        // Codes are kept in byte_codes while there are at most 256
+        // distinct values, and in short_codes after that.
+        std::vector<unsigned char> byte_codes;
+        std::vector<unsigned short> short_codes;
+        // Used instead of the codes if 'raw' is set.
+        std::vector<double> values;
+        bool raw;
+      };
+      // Appends the code for x (or x itself) to the column, widening
+      // or abandoning the code if x is a new distinct value.
+      void add_value(Column &column, double x);
+      // Replaces the codes in 'column' with the values they encode.
+      void convert_to_raw(Column &column);
+
+      std::vector<Column> columns_;
+      int number_of_rows_;
+      bool finalized_;
+      // Set if rows were added after finalize().
+      bool stale_;
+    };
+
     //======================================================================
     // A TreeNode is one node in a Tree.  The node can be either a
     // leaf or an interior node.
@@ -649,6 +764,11 @@ namespace BOOM {
     // Return a pointer to a specific tree.
     Bart::Tree *tree(int which_tree);
     const Bart::Tree *tree(int which_tree)const;
+
+    // A compact, column-major copy of the predictors for each
+    // observation, in the order the data were observed.  The store is
+    // finalized by finalize_data().
+    const Bart::BinnedPredictorStore & predictor_store()const;
    protected:
     void observe_data(const ConstVectorView & predictor);
     void observe_data(const Vector & predictor);
@@ -672,6 +792,7 @@ namespace BOOM {
     // the set of cutpoints available to the model.
     std::vector<Bart::VariableSummary> variable_summaries_;
     std::vector<boost::shared_ptr<Bart::Tree> > trees_;
+    Bart::BinnedPredictorStore predictor_store_;
   };
 
 }  // namespace BOOM
@@ -0,0 +1,171 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <Models/Bart/CompiledBartModel.hpp>
+#include <cpputil/report_error.hpp>
+#include <sstream>
+
+namespace BOOM {
+
+  const int CompiledBartModel::block_size_(256);
+
+  CompiledBartModel::CompiledBartModel()
+      : max_variable_index_(-1)
+  {}
+
+  //----------------------------------------------------------------------
+  CompiledBartModel::CompiledBartModel(const BartModelBase &model)
+      : max_variable_index_(-1)
+  {
+    for (int i = 0; i < model.number_of_trees(); ++i) {
+      add_tree(*model.tree(i));
+    }
+  }
+
+  //----------------------------------------------------------------------
+  void CompiledBartModel::add_tree(const Bart::Tree &tree) {
+    Matrix tree_matrix(tree.to_matrix());
+    add_tree(ConstSubMatrix(tree_matrix));
+  }
+
+  //----------------------------------------------------------------------
+  void CompiledBartModel::add_tree(const ConstSubMatrix &tree_matrix) {
+    if (tree_matrix.ncol() != 4) {
+      report_error("The matrix passed to CompiledBartModel::add_tree "
+                   "must have 4 columns.");
+    }
+    int number_of_nodes = tree_matrix.nrow();
+    if (number_of_nodes < 1) {
+      report_error("A tree must have at least one node.");
+    }
+    int offset = nodes_.size();
+    nodes_.resize(offset + number_of_nodes);
+    for (int id = 0; id < number_of_nodes; ++id) {
+      int parent_id = lround(tree_matrix(id, 0));
+      if ((id == 0 && parent_id != -1)
+          || (id > 0 && (parent_id < 0 || parent_id >= id))) {
+        std::ostringstream err;
+        err << "Node " << id << " has an illegal parent id ("
+            << parent_id << ") in CompiledBartModel::add_tree.";
+        report_error(err.str());
+      }
+      Node &node(nodes_[offset + id]);
+      node.variable_index = -1;
+      node.right_child = -1;
+      node.value = tree_matrix(id, 1);
+      if (parent_id >= 0 && id != parent_id + 1) {
+        // Left children immediately follow their parents, so any
+        // other child is a right child.
+        nodes_[offset + parent_id].right_child = offset + id;
+      }
+    }
+
+    // Once the children have been assigned, the interior nodes can be
+    // identified and given their splitting rules.
+    for (int id = 0; id < number_of_nodes; ++id) {
+      Node &node(nodes_[offset + id]);
+      if (node.right_child >= 0) {
+        node.variable_index = lround(tree_matrix(id, 2));
+        node.value = tree_matrix(id, 3);
+        if (node.variable_index < 0) {
+          report_error("Interior node with a negative variable index in "
+                       "CompiledBartModel::add_tree.");
+        }
+        max_variable_index_ = std::max(max_variable_index_,
+                                       node.variable_index);
+      }
+    }
+    roots_.push_back(offset);
+  }
+
+  //----------------------------------------------------------------------
+  int CompiledBartModel::number_of_trees() const {
+    return roots_.size();
+  }
+
+  int CompiledBartModel::number_of_nodes() const {
+    return nodes_.size();
+  }
+
+  //----------------------------------------------------------------------
+  template <class VECTOR>
+  double CompiledBartModel::predict_tree(int root, const VECTOR &x) const {
+    const Node *node = &nodes_[root];
+    while (node->variable_index >= 0) {
+      node = (x[node->variable_index] <= node->value) ?
+          node + 1 : &nodes_[node->right_child];
+    }
+    return node->value;
+  }
+
+  //----------------------------------------------------------------------
+  double CompiledBartModel::predict(const Vector &x) const {
+    return predict(ConstVectorView(x));
+  }
+
+  double CompiledBartModel::predict(const VectorView &x) const {
+    return predict(ConstVectorView(x));
+  }
+
+  double CompiledBartModel::predict(const ConstVectorView &x) const {
+    check_dimension(x.size());
+    double ans = 0;
+    for (int i = 0; i < roots_.size(); ++i) {
+      ans += predict_tree(roots_[i], x);
+    }
+    return ans;
+  }
+
+  //----------------------------------------------------------------------
+  Vector CompiledBartModel::predict(const Matrix &X) const {
+    check_dimension(X.ncol());
+    int nrow = X.nrow();
+    Vector ans(nrow, 0.0);
+    // Matrix storage is column major, so element (i, j) is at
+    // data[i + j * nrow].
+    const double *data = X.data();
+    const Node *nodes = nodes_.empty() ? NULL : &nodes_[0];
+    for (int block_start = 0; block_start < nrow; block_start += block_size_) {
+      int block_end = std::min(nrow, block_start + block_size_);
+      for (int tree = 0; tree < roots_.size(); ++tree) {
+        const Node *root = nodes + roots_[tree];
+        for (int i = block_start; i < block_end; ++i) {
+          const Node *node = root;
+          while (node->variable_index >= 0) {
+            double x = data[i + node->variable_index * nrow];
+            node = (x <= node->value) ? node + 1 : nodes + node->right_child;
+          }
+          ans[i] += node->value;
+        }
+      }
+    }
+    return ans;
+  }
+
+  //----------------------------------------------------------------------
+  void CompiledBartModel::check_dimension(int dimension) const {
+    if (dimension <= max_variable_index_) {
+      std::ostringstream err;
+      err << "The trees in this CompiledBartModel split on variable "
+          << max_variable_index_ << ", but the predictors only have "
+          << dimension << " elements.";
+      report_error(err.str());
+    }
+  }
+
+}  // namespace BOOM
@@ -0,0 +1,110 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_COMPILED_BART_MODEL_HPP_
+#define BOOM_COMPILED_BART_MODEL_HPP_
+
+#include <vector>
+#include <Models/Bart/Bart.hpp>
+#include <LinAlg/Matrix.hpp>
+#include <LinAlg/SubMatrix.hpp>
+
+namespace BOOM {
+
+  // A read-only representation of a sum of trees, for scoring large
+  // numbers of observations.  A Bart::Tree is a set of pointer-linked
+  // TreeNodes allocated on the heap, which is convenient for MCMC but
+  // slow for prediction.  A CompiledBartModel packs the nodes of all
+  // trees into a single contiguous array in the same pre-order used
+  // by Tree::to_matrix(), so the left child of a node is always the
+  // next element in the array and only the position of the right
+  // child needs to be stored.
+  //
+  // A CompiledBartModel can be built directly from serialized trees,
+  // so it is possible to score data without constructing a
+  // BartModelBase.
+  class CompiledBartModel {
+   public:
+    // An empty model that predicts zero.  Use add_tree() to populate it.
+    CompiledBartModel();
+
+    // Compile all the trees in 'model'.  Later changes to 'model' are
+    // not reflected in *this.
+    explicit CompiledBartModel(const BartModelBase &model);
+
+    // Add a tree to the ensemble.
+    // Args:
+    //   tree_matrix: A 4-column matrix in the format produced by
+    //     Bart::Tree::to_matrix().  Columns are (parent_id, mean,
+    //     variable, cutpoint), and each row's parent_id must be less
+    //     than the row number (except for the root, whose parent_id
+    //     is -1).
+    void add_tree(const ConstSubMatrix &tree_matrix);
+    void add_tree(const Bart::Tree &tree);
+
+    int number_of_trees() const;
+    int number_of_nodes() const;
+
+    // Predictions are on the "sum of trees" scale, exactly as in
+    // BartModelBase::predict().
+    double predict(const Vector &x) const;
+    double predict(const VectorView &x) const;
+    double predict(const ConstVectorView &x) const;
+
+    // Returns the vector of predictions for each row of X.  Rows are
+    // processed in blocks, and each tree is applied to a whole block
+    // before moving to the next tree, so the nodes of the tree being
+    // evaluated stay in cache.
+    Vector predict(const Matrix &X) const;
+
+   private:
+    struct Node {
+      // The index of the variable to split on, or -1 if the node is a
+      // leaf.
+      int variable_index;
+      // The position in nodes_ of the right child.  The left child is
+      // at the position immediately after the node.  Unused for
+      // leaves.
+      int right_child;
+      // The cutpoint for interior nodes, or the mean for leaves.
+      // Observations with x[variable_index] <= cutpoint go left.
+      double value;
+    };
+
+    // Returns the mean of the leaf reached by following x down the
+    // tree rooted at nodes_[root].
+    template <class VECTOR>
+    double predict_tree(int root, const VECTOR &x) const;
+
+    // Throws an exception if 'dimension' is too small for the
+    // variables used by the trees.
+    void check_dimension(int dimension) const;
+
+    std::vector<Node> nodes_;
+    // The position in nodes_ of the root of each tree.
+    std::vector<int> roots_;
+    // The largest variable index used by any split.
+    int max_variable_index_;
+
+    // The number of rows evaluated per tree in predict(Matrix).
+    static const int block_size_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_COMPILED_BART_MODEL_HPP_
@@ -20,6 +20,8 @@
 #include <Models/Bart/PosteriorSamplers/BartPosteriorSampler.hpp>
 #include <distributions.hpp>
 #include <cpputil/math_utils.hpp>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
 
 namespace {
   // Returns the log of the integer d.  This is a compiler
@@ -138,6 +140,80 @@ namespace BOOM {
   using Bart::TreeNode;
   using Bart::VariableSummary;
 
+  namespace {
+    // Accumulates sufficient statistics for the observations in
+    // data[begin, end).  If 'right' is NULL then every observation is
+    // added to 'left'.  Otherwise observations are sent left or right
+    // according to the split rule (variable_index, cutpoint).  If
+    // 'split' is non-NULL it is used to evaluate the split rule from
+    // the compact predictor columns owned by the model, rather than
+    // from each observation's predictor vector.
+    class SufficientStatisticsShard {
+     public:
+      SufficientStatisticsShard(
+          const std::vector<ResidualRegressionData *> *data,
+          int begin,
+          int end,
+          int variable_index,
+          double cutpoint,
+          const Bart::BinnedPredictorStore::ColumnSplit *split,
+          Bart::SufficientStatisticsBase *left,
+          Bart::SufficientStatisticsBase *right)
+          : data_(data),
+            begin_(begin),
+            end_(end),
+            variable_index_(variable_index),
+            cutpoint_(cutpoint),
+            split_(split),
+            left_(left),
+            right_(right)
+      {}
+
+      void operator()() {
+        const std::vector<ResidualRegressionData *> &data(*data_);
+        if (!right_) {
+          for (int i = begin_; i < end_; ++i) {
+            left_->update(*data[i]);
+          }
+        } else if (split_) {
+          for (int i = begin_; i < end_; ++i) {
+            const ResidualRegressionData *dp = data[i];
+            if (split_->goes_left(dp->row_index())) {
+              left_->update(*dp);
+            } else {
+              right_->update(*dp);
+            }
+          }
+        } else {
+          for (int i = begin_; i < end_; ++i) {
+            const ResidualRegressionData *dp = data[i];
+            if (dp->x()[variable_index_] < cutpoint_) {
+              left_->update(*dp);
+            } else {
+              right_->update(*dp);
+            }
+          }
+        }
+      }
+
+     private:
+      const std::vector<ResidualRegressionData *> *data_;
+      int begin_;
+      int end_;
+      int variable_index_;
+      double cutpoint_;
+      const Bart::BinnedPredictorStore::ColumnSplit *split_;
+      Bart::SufficientStatisticsBase *left_;
+      Bart::SufficientStatisticsBase *right_;
+    };
+
+    // A ThreadPool task that fills shard number 'shard'.
+    void accumulate_shard(std::vector<SufficientStatisticsShard> *shards,
+                          int shard, int) {
+      (*shards)[shard]();
+    }
+  }  // namespace
+
   const Vector BartPosteriorSamplerBase::move_probabilities(".5 .5");
   const double BartPosteriorSamplerBase::
   log_probability_of_proposing_birth_move(
@@ -147,6 +223,8 @@ namespace BOOM {
   log_probability_of_proposing_death_move(
       log(BartPosteriorSamplerBase::move_probabilities[1]));
 
+  const int BartPosteriorSamplerBase::minimum_shard_size_(10000);
+
   BartPosteriorSamplerBase::BartPosteriorSamplerBase(
       BartModelBase *model,
       double prior_mean_guess,
@@ -159,7 +237,8 @@ namespace BOOM {
         prior_tree_depth_beta_(prior_tree_depth_beta),
         node_mean_prior_(new GaussianModel(
             prior_mean_guess,
-            square(prior_mean_sd)))
+            square(prior_mean_sd))),
+        number_of_threads_(1)
   {
     if (prior_tree_depth_alpha <= 0
         || prior_tree_depth_alpha >= 1) {
@@ -208,6 +287,7 @@ namespace BOOM {
       clear_data_from_trees();
       for (int i = 0; i < model_->sample_size(); ++i) {
         Bart::ResidualRegressionData *data = create_and_store_residual(i);
+        data->set_row_index(i);
         for (int j = 0; j < model_->number_of_trees(); ++j) {
           model_->tree(j)->populate_data(data);
         }
@@ -323,7 +403,7 @@ namespace BOOM {
 
       double cutpoint = 0;
       node_can_split = variable_summary.random_cutpoint(
-          BOOM::GlobalRng::rng,
+          rng(),
           leaf,
           &cutpoint);
 
@@ -413,20 +493,15 @@ namespace BOOM {
       TreeNode *leaf) {
     // First, fill the sufficient statistics that would be computed if
     // we split on leaf.
-    const std::vector<ResidualRegressionData *> &node_data(leaf->data());
     boost::shared_ptr<Bart::SufficientStatisticsBase>
         left_suf(create_suf());
     boost::shared_ptr<Bart::SufficientStatisticsBase>
         right_suf(create_suf());
-    int variable_index = leaf->variable_index();
-    double cutpoint = leaf->cutpoint();
-    for (int i = 0;  i < node_data.size(); ++i) {
-      ResidualRegressionData *dp(node_data[i]);
-      bool left = dp->x()[variable_index] < cutpoint;
-      Bart::SufficientStatisticsBase *suf =
-          left ? left_suf.get() : right_suf.get();
-      suf->update(*dp);
-    }
+    accumulate_sufficient_statistics(leaf->data(),
+                                     leaf->variable_index(),
+                                     leaf->cutpoint(),
+                                     left_suf.get(),
+                                     right_suf.get());
 
     // Compute the log of 'p(split here) * p(no split below)^2'.
     int depth = leaf->depth();
@@ -459,6 +534,13 @@ namespace BOOM {
     // Note that p(variable | node) * p(cutpoint | variable, node)
     // will cancel in the MH proposal, so their contribution is not
     // computed.
+    if (number_of_threads_ > 1
+        && leaf->data().size() >= 2 * minimum_shard_size_) {
+      boost::shared_ptr<Bart::SufficientStatisticsBase> suf(create_suf());
+      accumulate_sufficient_statistics(leaf->data(), -1, 0, suf.get(), NULL);
+      return log_probability_of_no_split(leaf->depth())
+          + log_integrated_likelihood(suf.get());
+    }
     return log_probability_of_no_split(leaf->depth())
         + log_integrated_likelihood(leaf->compute_suf());
   }
@@ -581,6 +663,91 @@ namespace BOOM {
     return node_mean_prior_.get();
   }
 
+  //----------------------------------------------------------------------
+  void BartPosteriorSamplerBase::set_number_of_threads(
+      int number_of_threads) {
+    if (number_of_threads < 1) {
+      report_error("The number of threads must be positive.");
+    }
+    number_of_threads_ = number_of_threads;
+    thread_pool_.set_number_of_threads(number_of_threads);
+  }
+
+  //----------------------------------------------------------------------
+  int BartPosteriorSamplerBase::number_of_threads() const {
+    return number_of_threads_;
+  }
+
+  //----------------------------------------------------------------------
+  void BartPosteriorSamplerBase::accumulate_sufficient_statistics(
+      const std::vector<ResidualRegressionData *> &data,
+      int variable_index,
+      double cutpoint,
+      Bart::SufficientStatisticsBase *left,
+      Bart::SufficientStatisticsBase *right) {
+    left->clear();
+    if (right) right->clear();
+    int sample_size = data.size();
+    int number_of_shards = std::min<int>(
+        number_of_threads_, sample_size / minimum_shard_size_);
+#ifdef NO_BOOST_THREADS
+    number_of_shards = 1;
+#endif
+
+    // If the model's predictor store lines up with the residuals then
+    // the split can be evaluated from its compact columns.
+    boost::scoped_ptr<Bart::BinnedPredictorStore::ColumnSplit> split;
+    const Bart::BinnedPredictorStore &store(model_->predictor_store());
+    if (right
+        && store.finalized()
+        && store.number_of_rows() == residual_size()) {
+      split.reset(new Bart::BinnedPredictorStore::ColumnSplit(
+          store.split(variable_index, cutpoint)));
+    }
+
+    if (number_of_shards <= 1) {
+      SufficientStatisticsShard(&data, 0, sample_size, variable_index,
+                                cutpoint, split.get(), left, right)();
+      return;
+    }
+
+    // Shard 0 accumulates directly into left and right.  The other
+    // shards get their own empty copies, which are combined in shard
+    // order once the thread pool has finished, so the result does not
+    // depend on which thread handled which shard.
+    std::vector<boost::shared_ptr<Bart::SufficientStatisticsBase> >
+        left_partials, right_partials;
+    std::vector<SufficientStatisticsShard> shards;
+    shards.reserve(number_of_shards);
+    int shard_size = sample_size / number_of_shards;
+    shards.push_back(SufficientStatisticsShard(
+        &data, 0, shard_size, variable_index, cutpoint, split.get(),
+        left, right));
+    for (int shard = 1; shard < number_of_shards; ++shard) {
+      int begin = shard * shard_size;
+      int end = (shard + 1 == number_of_shards) ?
+          sample_size : begin + shard_size;
+      left_partials.push_back(
+          boost::shared_ptr<Bart::SufficientStatisticsBase>(left->create()));
+      Bart::SufficientStatisticsBase *right_partial = NULL;
+      if (right) {
+        right_partials.push_back(
+            boost::shared_ptr<Bart::SufficientStatisticsBase>(
+                right->create()));
+        right_partial = right_partials.back().get();
+      }
+      shards.push_back(SufficientStatisticsShard(
+          &data, begin, end, variable_index, cutpoint, split.get(),
+          left_partials.back().get(), right_partial));
+    }
+    thread_pool_.parallel_for(
+        number_of_shards, boost::bind(accumulate_shard, &shards, _1, _2));
+    for (int i = 0; i < left_partials.size(); ++i) {
+      left->combine(*left_partials[i]);
+      if (right) right->combine(*right_partials[i]);
+    }
+  }
+
   //----------------------------------------------------------------------
   void BartPosteriorSamplerBase::clear_data_from_trees() {
     for (int i = 0; i < model_->number_of_trees(); ++i) {
@@ -22,6 +22,7 @@
 #include <Models/Bart/Bart.hpp>
 #include <Models/GaussianModel.hpp>
 #include <Models/PosteriorSamplers/PosteriorSampler.hpp>
+#include <cpputil/ThreadPool.hpp>
 
 namespace BOOM {
   // This is the base class for PosteriorSampler classes for drawing
@@ -196,17 +197,57 @@ namespace BOOM {
     // The prior distribution for the mean parameter at each node.
     const GaussianModel * node_mean_prior()const;
 
+    // Sets the number of threads used to accumulate the sufficient
+    // statistics needed by split_log_posterior() and
+    // nosplit_log_posterior().  The data assigned to a node is split
+    // into contiguous shards, each thread accumulates sufficient
+    // statistics for its shard, and the partial results are combined
+    // in shard order.  The worker threads make no random draws, so
+    // for a fixed seed and number of threads the sequence of draws is
+    // reproducible.  Nodes with too little data to be worth sharding
+    // are handled in the calling thread.  The default is 1 thread.
+    void set_number_of_threads(int number_of_threads);
+    int number_of_threads() const;
+
    protected:
     // Removes all pointers to residuals_ from the trees owned by
     // model_.
     void clear_data_from_trees();
    private:
+    // Accumulate sufficient statistics for 'data' into 'left' and
+    // 'right', which are cleared first.  If 'right' is NULL then all
+    // observations are added to 'left'.  Otherwise observations with
+    // x[variable_index] < cutpoint go to 'left' and the rest go to
+    // 'right'.  The work is spread across number_of_threads_ threads
+    // when there is enough data to justify it.
+    //
+    // Sharding happens here rather than in
+    // TreeNode::populate_sufficient_statistics(), because that function
+    // only attaches empty statistics objects to the nodes.  The pass
+    // over the data happens when a move is evaluated, and the split
+    // side of a birth move never exists as a node at all.
+    void accumulate_sufficient_statistics(
+        const std::vector<Bart::ResidualRegressionData *> &data,
+        int variable_index,
+        double cutpoint,
+        Bart::SufficientStatisticsBase *left,
+        Bart::SufficientStatisticsBase *right);
+
     BartModelBase *model_;
     // We keep alpha on both the log scale and the raw scale.
     double log_prior_tree_depth_alpha_;
     double prior_tree_depth_alpha_;
     double prior_tree_depth_beta_;
     Ptr<GaussianModel> node_mean_prior_;
+    int number_of_threads_;
+    // Threads for accumulate_sufficient_statistics().  They persist
+    // between calls, so sharding a node costs a hand-off to the pool
+    // rather than creating and joining threads.
+    ThreadPool thread_pool_;
+
+    // Nodes with fewer than this many observations per thread are
+    // processed in the calling thread.
+    static const int minimum_shard_size_;
 
     // The types of moves considered by the Metropolis-Hastings
     // algorithm.
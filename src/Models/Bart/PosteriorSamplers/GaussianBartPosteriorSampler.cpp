@@ -36,6 +36,17 @@ namespace BOOM {
       suf.update(*this);
     }
 
+    void GaussianBartSufficientStatistics::combine(
+        const SufficientStatisticsBase &rhs) {
+      const GaussianBartSufficientStatistics *gaussian_rhs =
+          dynamic_cast<const GaussianBartSufficientStatistics *>(&rhs);
+      if (!gaussian_rhs) {
+        report_error("GaussianBartSufficientStatistics can only be "
+                     "combined with other GaussianBartSufficientStatistics.");
+      }
+      suf_.combine(gaussian_rhs->suf_);
+    }
+
   }  // namespace Bart
 
   GaussianBartPosteriorSampler::GaussianBartPosteriorSampler(
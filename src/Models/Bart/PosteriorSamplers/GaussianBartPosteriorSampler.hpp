@@ -67,6 +67,7 @@ namespace BOOM {
       virtual void update(const GaussianResidualRegressionData &data) {
         suf_.update_raw(data.residual());
       }
+      virtual void combine(const SufficientStatisticsBase &rhs);
       double n() const {return suf_.n();}
       double ybar() const {return suf_.ybar();}
       double sum() const {return suf_.sum();}
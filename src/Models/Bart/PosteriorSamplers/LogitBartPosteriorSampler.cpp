@@ -71,6 +71,20 @@ namespace BOOM {
       information_weighted_sum_ += data.information_weighted_sum();
     }
 
+    void LogitSufficientStatistics::combine(
+        const SufficientStatisticsBase &rhs) {
+      const LogitSufficientStatistics *logit_rhs =
+          dynamic_cast<const LogitSufficientStatistics *>(&rhs);
+      if (!logit_rhs) {
+        report_error("LogitSufficientStatistics can only be combined "
+                     "with other LogitSufficientStatistics.");
+      }
+      sum_of_information_ += logit_rhs->sum_of_information_;
+      information_weighted_prediction_ +=
+          logit_rhs->information_weighted_prediction_;
+      information_weighted_sum_ += logit_rhs->information_weighted_sum_;
+    }
+
     double LogitSufficientStatistics::sum_of_information() const {
       return sum_of_information_;
     }
@@ -101,6 +101,7 @@ namespace BOOM {
       virtual void clear();
       virtual void update(const ResidualRegressionData &abstract_data);
       virtual void update(const LogitResidualData &data);
+      virtual void combine(const SufficientStatisticsBase &rhs);
 
       double sum_of_information() const;
       double information_weighted_sum() const;
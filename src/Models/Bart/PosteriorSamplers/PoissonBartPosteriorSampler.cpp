@@ -117,6 +117,19 @@ namespace BOOM {
         weighted_sum_of_residuals_ += weight * data.internal_residual();
       }
     }
+
+    //----------------------------------------------------------------------
+    void PoissonSufficientStatistics::combine(
+        const SufficientStatisticsBase &rhs) {
+      const PoissonSufficientStatistics *poisson_rhs =
+          dynamic_cast<const PoissonSufficientStatistics *>(&rhs);
+      if (!poisson_rhs) {
+        report_error("PoissonSufficientStatistics can only be combined "
+                     "with other PoissonSufficientStatistics.");
+      }
+      sum_of_weights_ += poisson_rhs->sum_of_weights_;
+      weighted_sum_of_residuals_ += poisson_rhs->weighted_sum_of_residuals_;
+    }
   }  // namespace Bart
 
 
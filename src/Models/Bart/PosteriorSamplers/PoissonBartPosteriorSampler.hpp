@@ -167,6 +167,7 @@ namespace BOOM {
       // contributions to the sufficient statistics.
       virtual void update(const ResidualRegressionData &data);
       virtual void update(const PoissonResidualRegressionData &data);
+      virtual void combine(const SufficientStatisticsBase &rhs);
 
       double sum_of_weights() const {return sum_of_weights_;}
       double weighted_sum_of_residuals() const {
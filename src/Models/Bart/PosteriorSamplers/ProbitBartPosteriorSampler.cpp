@@ -70,6 +70,18 @@ namespace BOOM {
       sum_ += data.sum_of_residuals();
     }
 
+    void ProbitSufficientStatistics::combine(
+        const SufficientStatisticsBase &rhs) {
+      const ProbitSufficientStatistics *probit_rhs =
+          dynamic_cast<const ProbitSufficientStatistics *>(&rhs);
+      if (!probit_rhs) {
+        report_error("ProbitSufficientStatistics can only be combined "
+                     "with other ProbitSufficientStatistics.");
+      }
+      n_ += probit_rhs->n_;
+      sum_ += probit_rhs->sum_;
+    }
+
     int ProbitSufficientStatistics::sample_size() const { return n_; }
 
     double ProbitSufficientStatistics::sum() const { return sum_; }
@@ -71,6 +71,7 @@ namespace BOOM {
       virtual void clear();
       virtual void update(const ResidualRegressionData &abstract_data);
       virtual void update(const ProbitResidualData &data);
+      virtual void combine(const SufficientStatisticsBase &rhs);
       int sample_size() const;
       double sum() const;
      private:
@@ -23,7 +23,8 @@ namespace BOOM {
   namespace Bart {
 
     ResidualRegressionData::ResidualRegressionData(const VectorData *x)
-        : predictor_(x)
+        : predictor_(x),
+          row_index_(-1)
     {}
 
     //----------------------------------------------------------------------
@@ -49,6 +49,13 @@ namespace BOOM{
       // The vector of predictors associated with this observation.
       const Vector &x()const;
 
+      // The position of this observation in the data set of the model
+      // that owns it, which is also its row in the model's
+      // BinnedPredictorStore.  The row index is -1 until it is set by
+      // the posterior sampler.
+      int row_index()const {return row_index_;}
+      void set_row_index(int row_index) {row_index_ = row_index;}
+
       // Adjust the residual at this data point by the specified
       // value.  The notion is
       //
@@ -74,6 +81,7 @@ namespace BOOM{
 
      private:
       const VectorData *predictor_;
+      int row_index_;
     };
 
   }  // namespace Bart
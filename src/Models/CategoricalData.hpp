@@ -68,7 +68,7 @@ namespace BOOM{
 
     friend void intrusive_ptr_add_ref(CatKey *k){ k->up_count();}
     friend void intrusive_ptr_release(CatKey *k){
-      k->down_count(); if(k->ref_count()==0) delete k;}
+      if(k->down_count()==0) delete k;}
     std::vector<uint> map_levels(const StringVec &sv)const;
   };
 
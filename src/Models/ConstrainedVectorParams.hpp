@@ -24,7 +24,7 @@ namespace BOOM{
   public:
     friend void intrusive_ptr_add_ref(VectorConstraint *d){d->up_count();}
     friend void intrusive_ptr_release(VectorConstraint *d){
-      d->down_count(); if(d->ref_count()==0) delete d;}
+      if(d->down_count()==0) delete d;}
 
     virtual ~VectorConstraint(){}
 
@@ -0,0 +1,180 @@
+/*
+  Copyright (C) 2005-2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <Models/FiniteMixtureDataImputer.hpp>
+#include <LinAlg/VectorView.hpp>
+#include <cpputil/lse.hpp>
+#include <distributions.hpp>
+#include <algorithm>
+
+namespace BOOM{
+
+  namespace {
+    // The number of observations whose log densities are computed
+    // together.
+    const int block_size = 256;
+  }
+
+  typedef FiniteMixtureDataImputer FMDI;
+
+  FMDI::FiniteMixtureDataImputer(FiniteMixtureModel *model)
+      : model_(model),
+        mixing_distribution_(model->mixing_distribution()->clone()),
+        begin_(0),
+        end_(0),
+        em_(false),
+        loglike_(0),
+        rng_(seed_rng())
+  {
+    int S = model->number_of_mixture_components();
+    for(int s = 0; s < S; ++s){
+      Ptr<MixtureComponent> component(model->mixture_component(s)->clone());
+      mix_.push_back(component);
+      em_mix_.push_back(component.dcast<EmMixtureComponent>());
+    }
+  }
+
+  void FMDI::setup(int begin, int end, bool em){
+    begin_ = begin;
+    end_ = end;
+    em_ = em;
+    logpi_ = model_->logpi();
+    int S = mix_.size();
+    for(int s = 0; s < S; ++s){
+      Vec theta = model_->mixture_component(s)->vectorize_params();
+      mix_[s]->unvectorize_params(theta);
+    }
+  }
+
+  void FMDI::operator()(){
+    error_message_.clear();
+    try{
+      // Random numbers drawn without an explicit RNG (e.g. inside a
+      // mixture component) come from rng_ rather than GlobalRng.
+      ThreadRngScope rng_scope(rng_);
+      clear_client_data();
+      if(em_){
+        estep();
+      } else {
+        impute_latent_data();
+      }
+    }catch(const std::exception &e){
+      error_message_ = e.what();
+    }catch(...){
+      error_message_ = "Unknown exception in FiniteMixtureDataImputer.";
+    }
+  }
+
+  double FMDI::loglike()const{ return loglike_; }
+
+  const std::string & FMDI::error_message()const{ return error_message_; }
+
+  Ptr<MixtureComponent> FMDI::mixture_component(int s){ return mix_[s]; }
+
+  Ptr<MultinomialModel> FMDI::mixing_distribution(){
+    return mixing_distribution_;
+  }
+
+  void FMDI::clear_client_data(){
+    mixing_distribution_->clear_data();
+    for(int s = 0; s < mix_.size(); ++s) mix_[s]->clear_data();
+  }
+
+  void FMDI::fill_log_density(int begin, int end){
+    const std::vector<Ptr<Data> > &data(model_->dat());
+    int S = mix_.size();
+    log_density_.resize(block_size * S);
+    for(int s = 0; s < S; ++s){
+      const MixtureComponent *component = mix_[s].get();
+      double logpi = logpi_[s];
+      for(int i = begin; i < end; ++i){
+        const Data *dp = data[i].get();
+        if(dp->missing() || model_->which_mixture_component(i) >= 0){
+          continue;
+        }
+        log_density_[(i - begin) * S + s] = logpi + component->pdf(dp, true);
+      }
+    }
+  }
+
+  void FMDI::impute_latent_data(){
+    const std::vector<Ptr<Data> > &data(model_->dat());
+    std::vector<Ptr<CategoricalData> > &latent(model_->latent_data());
+    bool store = model_->store_class_membership_probabilities_;
+    Mat &probs(model_->class_membership_probabilities_);
+    int S = mix_.size();
+    loglike_ = 0;
+    for(int block = begin_; block < end_; block += block_size){
+      int block_end = std::min(end_, block + block_size);
+      fill_log_density(block, block_end);
+      for(int i = block; i < block_end; ++i){
+        Ptr<Data> dp = data[i];
+        Ptr<CategoricalData> cd = latent[i];
+        int source = model_->which_mixture_component(i);
+        if(source >= 0 && !dp->missing()){
+          loglike_ += mix_[source]->pdf(dp.get(), true);
+          if(store){
+            probs.row(i) = 0;
+            probs(i, source) = 1.0;
+          }
+          cd->set(source);
+          mixing_distribution_->add_data(cd);
+          mix_[source]->add_data(dp);
+          continue;
+        }
+        double *log_density = &log_density_[(i - block) * S];
+        if(dp->missing()){
+          std::copy(logpi_.begin(), logpi_.end(), log_density);
+        }
+        loglike_ += softmax_in_place(log_density, S);
+        ConstVectorView membership_probs(log_density, S, 1);
+        if(store) probs.row(i) = membership_probs;
+        uint h = rmulti_mt(rng_, membership_probs);
+        cd->set(h);
+        mix_[h]->add_data(dp);
+        mixing_distribution_->add_data(cd);
+      }
+    }
+  }
+
+  void FMDI::estep(){
+    const std::vector<Ptr<Data> > &data(model_->dat());
+    int S = mix_.size();
+    loglike_ = 0;
+    for(int block = begin_; block < end_; block += block_size){
+      int block_end = std::min(end_, block + block_size);
+      fill_log_density(block, block_end);
+      for(int i = block; i < block_end; ++i){
+        Ptr<Data> dp = data[i];
+        double *log_density = &log_density_[(i - block) * S];
+        if(dp->missing() || model_->which_mixture_component(i) >= 0){
+          // EmFiniteMixtureModel::EStep does not treat these cases
+          // specially, so neither does the threaded version.
+          for(int s = 0; s < S; ++s){
+            log_density[s] = logpi_[s] + mix_[s]->pdf(dp.get(), true);
+          }
+        }
+        loglike_ += softmax_in_place(log_density, S);
+        for(int s = 0; s < S; ++s){
+          em_mix_[s]->add_mixture_data(dp, log_density[s]);
+        }
+      }
+    }
+  }
+
+}
@@ -0,0 +1,91 @@
+/*
+  Copyright (C) 2005-2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_FINITE_MIXTURE_DATA_IMPUTER_HPP
+#define BOOM_FINITE_MIXTURE_DATA_IMPUTER_HPP
+
+#include <Models/FiniteMixtureModel.hpp>
+#include <distributions/rng.hpp>
+#include <string>
+
+namespace BOOM{
+
+  // One worker in the multithreaded version of
+  // FiniteMixtureModel::impute_latent_data() and
+  // EmFiniteMixtureModel::EStep().  Each worker handles a contiguous
+  // range of observations using private copies of the mixture
+  // components and the mixing distribution, so the threads never
+  // write to shared models.  The owning model combines the workers'
+  // sufficient statistics once they have all finished.
+  //
+  // Log densities are computed in blocks of observations, one
+  // component at a time, so each component's parameters stay in cache
+  // while its pdf is evaluated across the block.
+  class FiniteMixtureDataImputer {
+   public:
+    FiniteMixtureDataImputer(FiniteMixtureModel *model);
+
+    // Copies the current parameters from the model, and assigns
+    // observations [begin, end) to this worker.  If 'em' is true the
+    // worker runs an E-step instead of a posterior draw.  Call from
+    // the main thread before starting the worker.
+    void setup(int begin, int end, bool em);
+
+    // Impute latent data (or run the E-step) for the assigned
+    // observations.  Exceptions are caught, and reported through
+    // error_message().
+    void operator()();
+
+    // The observed data log likelihood of the assigned observations.
+    double loglike()const;
+
+    // Empty unless the most recent call to operator() threw.
+    const std::string & error_message()const;
+
+    Ptr<MixtureComponent> mixture_component(int s);
+    Ptr<MultinomialModel> mixing_distribution();
+
+   private:
+    void clear_client_data();
+    void impute_latent_data();
+    void estep();
+
+    // Fill log_density_ with logpi[s] + log p(y[i] | component s) for
+    // i in [begin, end).  Row i - begin holds observation i.
+    // Observations that are missing or have a known source are
+    // skipped.
+    void fill_log_density(int begin, int end);
+
+    FiniteMixtureModel *model_;
+    std::vector<Ptr<MixtureComponent> > mix_;
+    std::vector<Ptr<EmMixtureComponent> > em_mix_;
+    Ptr<MultinomialModel> mixing_distribution_;
+
+    int begin_;
+    int end_;
+    bool em_;
+    double loglike_;
+    std::string error_message_;
+
+    Vec logpi_;
+    std::vector<double> log_density_;
+    RNG rng_;
+  };
+
+}
+#endif// BOOM_FINITE_MIXTURE_DATA_IMPUTER_HPP
@@ -17,19 +17,32 @@
 */
 
 #include <Models/FiniteMixtureModel.hpp>
+#include <Models/FiniteMixtureDataImputer.hpp>
 #include <cpputil/lse.hpp>
+#include <cpputil/report_error.hpp>
 #include <boost/bind.hpp>
 #include <distributions.hpp>
 #include <stdexcept>
+#include <sstream>
 
 namespace BOOM{
 
+  namespace {
+    // A ThreadPool task running the data imputation worker for chunk
+    // 'chunk' of the data.
+    void run_imputer(
+        std::vector<boost::shared_ptr<FiniteMixtureDataImputer> > *workers,
+        int chunk, int){
+      (*(*workers)[chunk])();
+    }
+  }
 
   typedef FiniteMixtureModel FMM;
 
   FMM::FiniteMixtureModel(Ptr<MixtureComponent> mcomp, uint S)
     : MixtureDataPolicy(S),
-      mixing_dist_(new MultinomialModel(S))
+      mixing_dist_(new MultinomialModel(S)),
+      store_class_membership_probabilities_(true)
   {
     mixture_components_.reserve(S);
     for(uint s=0; s<S; ++s){
@@ -41,7 +54,8 @@ namespace BOOM{
 
   FMM::FiniteMixtureModel(Ptr<MixtureComponent> mcomp, Ptr<MultinomialModel> pi)
     : MixtureDataPolicy(pi->size()),
-      mixing_dist_(pi)
+      mixing_dist_(pi),
+      store_class_membership_probabilities_(true)
   {
     uint S = pi->size();
     for(uint s=0; s<S; ++s){
@@ -57,12 +71,15 @@ namespace BOOM{
       ParamPolicy(rhs),
       DataPolicy(rhs),
       mixture_components_(rhs.mixture_components_),
-      mixing_dist_(rhs.mixing_dist_->clone())
+      mixing_dist_(rhs.mixing_dist_->clone()),
+      store_class_membership_probabilities_(
+          rhs.store_class_membership_probabilities_)
   {
     uint S = size();
     for(uint s =0; s<S; ++s)
       mixture_components_[s] = rhs.mixture_components_[s]->clone();
     set_observers();
+    set_nthreads(rhs.nthreads());
   }
 
   FMM * FMM::clone()const{return new FMM(*this);}
@@ -74,13 +91,38 @@ namespace BOOM{
     for(uint s=0; s<S; ++s) mixture_components_[s]->clear_data();
   }
 
+  void FMM::set_nthreads(uint n){
+#ifndef NO_BOOST_THREADS
+    workers_.clear();
+    for(uint i = 0; i < n; ++i){
+      workers_.push_back(boost::shared_ptr<FiniteMixtureDataImputer>(
+          new FiniteMixtureDataImputer(this)));
+    }
+    if(n > 0) thread_pool_.set_number_of_threads(n);
+#endif
+  }
+
+  uint FMM::nthreads()const{ return workers_.size(); }
+
+  void FMM::set_store_class_membership_probabilities(bool store){
+    store_class_membership_probabilities_ = store;
+    if(!store) class_membership_probabilities_ = Mat();
+  }
+
   void FMM::impute_latent_data(){
+#ifndef NO_BOOST_THREADS
+    if(nthreads() > 0){
+      last_loglike_ = impute_latent_data_with_threads(false);
+      return;
+    }
+#endif
     const std::vector<Ptr<Data> >  &d(dat());
     std::vector<Ptr<CategoricalData> > hvec(latent_data());
 
     uint n = d.size();
     uint S = size();
-    class_membership_probabilities_.resize(n, S);
+    bool store = store_class_membership_probabilities_;
+    if(store) class_membership_probabilities_.resize(n, S);
 
     wsp_.resize(S);
     set_logpi();
@@ -88,16 +130,19 @@ namespace BOOM{
     const std::vector<Ptr<MixtureComponent> > &mod(mixture_components_);
     Ptr<MultinomialModel> mix(mixing_dist_);
     clear_component_data();
+    RNG &rng(default_rng());
     for(uint i=0; i<n; ++i){
       dPtr dp = d[i];
       Ptr<CategoricalData> cd = hvec[i];
       if(dp->missing()){
         wsp_ = logpi_;
-      }else if(which_mixture_component(i) > 0){
+      }else if(which_mixture_component(i) >= 0){
         int source = which_mixture_component(i);
         last_loglike_ += mod[source]->pdf(dp.get(), true);
-        class_membership_probabilities_.row(i) = 0;
-        class_membership_probabilities_(i, source) = 1.0;
+        if(store){
+          class_membership_probabilities_.row(i) = 0;
+          class_membership_probabilities_(i, source) = 1.0;
+        }
         cd->set(source);
         mix->add_data(cd);
         mod[source]->add_data(dp);
@@ -107,16 +152,60 @@ namespace BOOM{
           wsp_[s] = logpi_[s] + mod[s]->pdf(dp.get(), true);
         }
       }
-      last_loglike_ += lse(wsp_);
-      wsp_.normalize_logprob();
-      class_membership_probabilities_.row(i) = wsp_;
-      uint h = rmulti(wsp_);
+      last_loglike_ += softmax_in_place(wsp_.data(), S);
+      if(store) class_membership_probabilities_.row(i) = wsp_;
+      uint h = rmulti_mt(rng, wsp_);
       cd->set(h);
       mod[h]->add_data(dp);
       mix->add_data(cd);
     }
   }
 
+#ifndef NO_BOOST_THREADS
+  double FMM::impute_latent_data_with_threads(bool em){
+    int n = dat().size();
+    int S = size();
+    set_logpi();
+    if(store_class_membership_probabilities_ && !em){
+      class_membership_probabilities_.resize(n, S);
+    }
+    if(!em) clear_component_data();
+
+    int nworkers = nthreads();
+    int chunk_size = n / nworkers;
+    int remainder = n % nworkers;
+    int begin = 0;
+    for(int i = 0; i < nworkers; ++i){
+      int end = begin + chunk_size + (i < remainder ? 1 : 0);
+      workers_[i]->setup(begin, end, em);
+      begin = end;
+    }
+    thread_pool_.parallel_for(
+        nworkers, boost::bind(run_imputer, &workers_, _1, _2));
+
+    double loglike = 0;
+    for(int i = 0; i < nworkers; ++i){
+      const FiniteMixtureDataImputer &worker(*workers_[i]);
+      if(!worker.error_message().empty()){
+        std::ostringstream err;
+        err << "Data imputation thread " << i << " failed in "
+            << "FiniteMixtureModel:" << std::endl
+            << worker.error_message();
+        report_error(err.str());
+      }
+      loglike += worker.loglike();
+      if(!em){
+        mixing_dist_->combine_data(*workers_[i]->mixing_distribution(), true);
+      }
+      for(int s = 0; s < S; ++s){
+        mixture_components_[s]->combine_data(
+            *workers_[i]->mixture_component(s), true);
+      }
+    }
+    return loglike;
+  }
+#endif
+
   void FMM::class_membership_probability(Ptr<Data> dp, Vec &ans)const{
     int S = number_of_mixture_components();
     ans.resize(S);
@@ -267,6 +356,9 @@ namespace BOOM{
   }
 
   double EmFiniteMixtureModel::EStep(){
+#ifndef NO_BOOST_THREADS
+    if(nthreads() > 0) return impute_latent_data_with_threads(true);
+#endif
     Vec &wsp(wsp_);
     wsp.resize(number_of_mixture_components());
     const std::vector<Ptr<Data> > &data(dat());
@@ -276,16 +368,9 @@ namespace BOOM{
       for(int s = 0; s < number_of_mixture_components(); ++s){
         wsp[s] = log_pi[s] + mixture_component(s)->pdf(data[i].get(), true);
       }
-      double total = lse(wsp);
-      ans += total;
-      double normalizing_constant = 0;
-      for(int s = 0; s < number_of_mixture_components(); ++s){
-        wsp[s] = exp(wsp[s] - total);
-        normalizing_constant += wsp[s];
-      }
+      ans += softmax_in_place(wsp.data(), wsp.size());
       for(int s = 0; s < number_of_mixture_components(); ++s){
-        em_mixture_components_[s]->add_mixture_data(
-            data[i], wsp[s] / normalizing_constant);
+        em_mixture_components_[s]->add_mixture_data(data[i], wsp[s]);
       }
     }
     return ans;
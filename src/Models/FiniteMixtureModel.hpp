@@ -25,9 +25,13 @@
 #include <Models/Policies/CompositeParamPolicy.hpp>
 #include <Models/Policies/MixtureDataPolicy.hpp>
 #include <Models/MultinomialModel.hpp>
+#include <cpputil/ThreadPool.hpp>
+#include <boost/shared_ptr.hpp>
 
 namespace BOOM{
 
+  class FiniteMixtureDataImputer;
+
   class FiniteMixtureModel
       : public LatentVariableModel,
         public CompositeParamPolicy,
@@ -48,6 +52,18 @@ namespace BOOM{
     FiniteMixtureModel * clone()const;
 
     void clear_component_data();
+
+    // If n > 0 then impute_latent_data() (and EStep() in
+    // EmFiniteMixtureModel) split the data into n contiguous chunks,
+    // each handled by a worker in a thread pool using private copies
+    // of the mixture components.  Their sufficient statistics are merged
+    // when the threads finish, so in threaded mode the mixture
+    // components and mixing distribution receive sufficient
+    // statistics but not the data points themselves.  Mixture
+    // components must support combine_data().
+    void set_nthreads(uint n);
+    uint nthreads()const;
+
     virtual void impute_latent_data();
     void class_membership_probability(Ptr<Data>, Vec &ans)const;
     double last_loglike()const;
@@ -67,9 +83,15 @@ namespace BOOM{
 
     // Returns a matrix of class membership probabilities for each
     // observation.  The table of membership probabilities is
-    // re-written with each call to impute_latent_data().
+    // re-written with each call to impute_latent_data().  It is
+    // empty if storing membership probabilities has been turned off.
     const Mat & class_membership_probability()const;
 
+    // The table of class membership probabilities takes n * S
+    // doubles.  Turning it off saves that space when the
+    // probabilities are not needed.  It is on by default.
+    void set_store_class_membership_probabilities(bool store);
+
     // Returns a vector giving the latent class to which each
     // observation was assigned during the most recent call to
     // impute_latent_data().
@@ -79,6 +101,11 @@ namespace BOOM{
     void set_logpi()const;
     mutable Vec wsp_;
 
+    // Runs the data imputation workers, one per thread, and combines
+    // their results.  If 'em' is true the workers run an E-step.
+    // Returns the observed data log likelihood.
+    double impute_latent_data_with_threads(bool em);
+
     // Save the class membership probabilities for user i.
     void update_class_membership_probabilities(int i, const Vec &probs);
   private:
@@ -92,7 +119,14 @@ namespace BOOM{
     virtual const std::vector<Ptr<MixtureComponent> > models()const;
     double last_loglike_;
     Mat class_membership_probabilities_;
+    bool store_class_membership_probabilities_;
     std::vector<int> which_mixture_component_;
+    std::vector<boost::shared_ptr<FiniteMixtureDataImputer> > workers_;
+    // Runs the workers.  The threads persist between calls to
+    // impute_latent_data().
+    ThreadPool thread_pool_;
+
+    friend class FiniteMixtureDataImputer;
   };
   //----------------------------------------------------------------------
   template <class FwdIt>
@@ -100,7 +134,8 @@ namespace BOOM{
                                          Ptr<MultinomialModel> MixDist)
     : DataPolicy(MixDist->size()),
       mixture_components_(Beg,End),
-      mixing_dist_(MixDist)
+      mixing_dist_(MixDist),
+      store_class_membership_probabilities_(true)
   {
     set_observers();
   }
@@ -110,7 +145,8 @@ namespace BOOM{
                                          Ptr<MultinomialModel> MixDist)
     : DataPolicy(MixDist->size()),
       mixture_components_(Models.begin(), Models.end()),
-      mixing_dist_(MixDist)
+      mixing_dist_(MixDist),
+      store_class_membership_probabilities_(true)
   {
     set_observers();
   }
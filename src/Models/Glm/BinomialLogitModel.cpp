@@ -129,6 +129,37 @@ namespace BOOM{
         g->axpy(x, y-n*p);  // g += (y-n*p) * x;
         if(h){ h->add_outer(x,x, -n*p*(1-p)); // h += -npq * x x^T
         }}}
+    if(!!columnar_data()){
+      ans += columnar_log_likelihood(*columnar_data(), beta, g, h);
+    }
+    return ans;
+  }
+
+  double BLM::columnar_log_likelihood(const ColumnarGlmData &data,
+                                      const Vec &beta, Vec *g, Mat *h)const{
+    const Vec &y(data.y());
+    const Vec &trials(data.trials());
+    int nobs = data.nobs();
+    Vec eta(nobs);
+    data.predict(0, nobs, beta, eta.data());
+    Vec residual(nobs);
+    Vec information(nobs);
+    double ans = 0;
+    for(int i = 0; i < nobs; ++i){
+      double p = logit_inv(eta[i] - log_alpha_);
+      ans += dbinom(y[i], trials[i], p, true);
+      residual[i] = y[i] - trials[i] * p;
+      information[i] = trials[i] * p * (1 - p);
+    }
+    if(g && h){
+      Spd xtwx(beta.size(), 0.0);
+      Mat workspace;
+      data.add_cross_products(0, nobs, information.data(), residual.data(),
+                              xtwx, *g, workspace);
+      *h -= xtwx;
+    }else if(g){
+      *g += data.X().Tmult(residual);
+    }
     return ans;
   }
 
@@ -137,13 +168,21 @@ namespace BOOM{
   Spd BLM::xtx()const{
     const std::vector<Ptr<BinomialRegressionData> > & d(dat());
     uint n = d.size();
-    uint p = d[0]->xdim();
+    uint p = xdim();
     Spd ans(p);
     for(uint i=0; i<n; ++i){
       double n = d[i]->n();
       ans.add_outer(d[i]->x(), n, false);
     }
     ans.reflect();
+    if(!!columnar_data()){
+      const ColumnarGlmData &columns(*columnar_data());
+      Vec zero(columns.nobs(), 0.0);
+      Vec unused(p, 0.0);
+      Mat workspace;
+      columns.add_cross_products(0, columns.nobs(), columns.trials().data(),
+                                 zero.data(), ans, unused, workspace);
+    }
     return ans;
   }
 
@@ -18,6 +18,7 @@
 #ifndef BOOM_BINOMIAL_LOGIT_MODEL_HPP_
 #define BOOM_BINOMIAL_LOGIT_MODEL_HPP_
 #include <Models/Glm/BinomialRegressionData.hpp>
+#include <Models/Glm/ColumnarGlmData.hpp>
 #include <BOOM.hpp>
 #include <TargetFun/TargetFun.hpp>
 #include <numopt.hpp>
@@ -41,12 +42,15 @@ namespace BOOM{
     const BinomialLogitModel *m_;
   };
 
-// logistic regression model with binned training data
+// logistic regression model with binned training data.  Data can be
+// held as BinomialRegressionData objects, as a ColumnarGlmData (using
+// its y and trials), or both.
   class BinomialLogitModel
       : public GlmModel,
         public NumOptModel,
         public ParamPolicy_1<GlmCoefs>,
         public IID_DataPolicy<BinomialRegressionData>,
+        public ColumnarDataPolicy,
         public PriorPolicy,
         public MixtureComponent
   {
@@ -82,6 +86,12 @@ namespace BOOM{
 
    private:
     double log_alpha_;  // see comments in logistic_regression_model
+
+    // The contribution of the columnar data to log_likelihood().
+    // g and h are incremented if they are non-NULL.  h is only used if
+    // g is also non-NULL.
+    double columnar_log_likelihood(const ColumnarGlmData &data,
+                                   const Vec &beta, Vec *g, Mat *h)const;
   };
 
 
@@ -0,0 +1,145 @@
+/*
+  Copyright (C) 2005-2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <Models/Glm/ColumnarGlmData.hpp>
+#include <cpputil/report_error.hpp>
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+namespace BOOM{
+
+  ColumnarGlmData::ColumnarGlmData(const Mat &X, const Vec &y)
+      : X_(X),
+        y_(y),
+        trials_(X.nrow(), 1.0),
+        exposure_(X.nrow(), 1.0),
+        log_exposure_(X.nrow(), 0.0)
+  {
+    check_length(y, "y");
+  }
+
+  ColumnarGlmData::ColumnarGlmData(
+      const std::vector<Ptr<BinomialRegressionData> > &data)
+      : X_(data.size(), data.empty() ? 0 : data[0]->xdim()),
+        y_(data.size()),
+        trials_(data.size()),
+        exposure_(data.size(), 1.0),
+        log_exposure_(data.size(), 0.0)
+  {
+    for(int i = 0; i < data.size(); ++i){
+      X_.row(i) = data[i]->x();
+      y_[i] = data[i]->y();
+      trials_[i] = data[i]->n();
+    }
+  }
+
+  ColumnarGlmData::ColumnarGlmData(
+      const std::vector<Ptr<PoissonRegressionData> > &data)
+      : X_(data.size(), data.empty() ? 0 : data[0]->xdim()),
+        y_(data.size()),
+        trials_(data.size(), 1.0),
+        exposure_(data.size()),
+        log_exposure_(data.size())
+  {
+    for(int i = 0; i < data.size(); ++i){
+      X_.row(i) = data[i]->x();
+      y_[i] = data[i]->y();
+      exposure_[i] = data[i]->exposure();
+      log_exposure_[i] = data[i]->log_exposure();
+    }
+  }
+
+  void ColumnarGlmData::check_length(const Vec &v, const char *name)const{
+    if(v.size() != nobs()){
+      std::ostringstream err;
+      err << "ColumnarGlmData has " << nobs() << " observations, but "
+          << name << " has length " << v.size() << "." << endl;
+      report_error(err.str());
+    }
+  }
+
+  void ColumnarGlmData::check_non_negative(const Vec &v,
+                                           const char *name)const{
+    check_length(v, name);
+    for(int i = 0; i < v.size(); ++i){
+      if(v[i] < 0){
+        std::ostringstream err;
+        err << "Element " << i << " of " << name << " is negative: "
+            << v[i] << endl;
+        report_error(err.str());
+      }
+    }
+  }
+
+  void ColumnarGlmData::set_trials(const Vec &trials){
+    check_non_negative(trials, "trials");
+    trials_ = trials;
+  }
+
+  void ColumnarGlmData::set_exposure(const Vec &exposure){
+    check_non_negative(exposure, "exposure");
+    exposure_ = exposure;
+    for(int i = 0; i < exposure.size(); ++i){
+      log_exposure_[i] = std::log(exposure[i]);
+    }
+  }
+
+  void ColumnarGlmData::predict(int begin, int end, const Vec &beta,
+                                double *eta)const{
+    int m = end - begin;
+    int n = nobs();
+    for(int i = 0; i < m; ++i) eta[i] = 0;
+    const double *column = X_.data() + begin;
+    for(int j = 0; j < xdim(); ++j, column += n){
+      double b = beta[j];
+      if(b == 0) continue;
+      for(int i = 0; i < m; ++i) eta[i] += column[i] * b;
+    }
+  }
+
+  void ColumnarGlmData::add_cross_products(int begin, int end,
+                                           const double *w,
+                                           const double *v,
+                                           Spd &xtx,
+                                           Vec &xty,
+                                           Mat &workspace)const{
+    int m = end - begin;
+    int n = nobs();
+    int p = xdim();
+    if(m <= 0) return;
+    // The workspace holds diag(sqrt(w)) * X[begin:end, ], so its
+    // inner product is the weighted cross product.
+    if(workspace.nrow() != m || workspace.ncol() != p) workspace.resize(m, p);
+    std::vector<double> root_w(m);
+    for(int i = 0; i < m; ++i) root_w[i] = std::sqrt(w[i]);
+
+    const double *column = X_.data() + begin;
+    double *scaled = workspace.data();
+    for(int j = 0; j < p; ++j, column += n, scaled += m){
+      double total = 0;
+      for(int i = 0; i < m; ++i){
+        total += column[i] * v[i];
+        scaled[i] = column[i] * root_w[i];
+      }
+      xty[j] += total;
+    }
+    xtx.add_inner(workspace);
+  }
+
+}  // namespace BOOM
@@ -0,0 +1,122 @@
+/*
+  Copyright (C) 2005-2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_COLUMNAR_GLM_DATA_HPP_
+#define BOOM_COLUMNAR_GLM_DATA_HPP_
+
+#include <cpputil/RefCounted.hpp>
+#include <cpputil/Ptr.hpp>
+#include <LinAlg/Matrix.hpp>
+#include <LinAlg/SpdMatrix.hpp>
+#include <LinAlg/Vector.hpp>
+#include <LinAlg/VectorView.hpp>
+#include <Models/Glm/BinomialRegressionData.hpp>
+#include <Models/Glm/PoissonRegressionData.hpp>
+
+namespace BOOM{
+
+  // Regression data for n observations stored by column, rather than
+  // as n separately allocated GlmData objects.  The predictors are a
+  // single column-major n x p matrix, and the response, binomial
+  // trials and Poisson exposure are each a length n array.  Trials
+  // and exposures default to 1.
+  //
+  // Row i is available as a strided view, but the intended use is
+  // to process the data a block of rows at a time: predict() fills
+  // the linear predictors for a block, and add_cross_products()
+  // accumulates the weighted X'X and X'v for a block.  Both read the
+  // columns of X contiguously.
+  class ColumnarGlmData : private RefCounted{
+   public:
+    friend void intrusive_ptr_add_ref(ColumnarGlmData *d){d->up_count();}
+    friend void intrusive_ptr_release(ColumnarGlmData *d){
+      if(d->down_count()==0) delete d;}
+
+    // X is the n x p design matrix.  Include a column of 1's in X if
+    // the model has an intercept.
+    ColumnarGlmData(const Mat &X, const Vec &y);
+
+    // Copies the data from a set of GlmData objects.
+    explicit ColumnarGlmData(
+        const std::vector<Ptr<BinomialRegressionData> > &data);
+    explicit ColumnarGlmData(
+        const std::vector<Ptr<PoissonRegressionData> > &data);
+
+    int nobs()const{return X_.nrow();}
+    int xdim()const{return X_.ncol();}
+
+    const Mat & X()const{return X_;}
+    const Vec & y()const{return y_;}
+    const Vec & trials()const{return trials_;}
+    const Vec & exposure()const{return exposure_;}
+    const Vec & log_exposure()const{return log_exposure_;}
+
+    // A view of row i of X.  The elements of the view are nobs()
+    // apart in memory.
+    ConstVectorView x(int i)const{
+      return ConstVectorView(X_.data() + i, X_.ncol(), X_.nrow());}
+
+    // Each of these throws if the argument is not of length nobs(),
+    // or has negative elements.
+    void set_trials(const Vec &trials);
+    void set_exposure(const Vec &exposure);
+
+    // Sets eta[i - begin] = x(i).dot(beta) for i in [begin, end).
+    void predict(int begin, int end, const Vec &beta, double *eta)const;
+
+    // For the rows i in [begin, end) adds w[i-begin] * x(i) x(i)^T to
+    // xtx, and v[i-begin] * x(i) to xty.  The weights must be
+    // non-negative.  xtx is symmetric on return, with any pending
+    // updates to its upper triangle reflected into the lower one.
+    // 'workspace' is resized as needed, so one workspace can be reused
+    // across calls.
+    void add_cross_products(int begin, int end,
+                            const double *w, const double *v,
+                            Spd &xtx, Vec &xty, Mat &workspace)const;
+
+   private:
+    Mat X_;
+    Vec y_;
+    Vec trials_;
+    Vec exposure_;
+    Vec log_exposure_;
+
+    void check_length(const Vec &v, const char *name)const;
+    void check_non_negative(const Vec &v, const char *name)const;
+  };
+
+  // A mix-in for GLM's that can hold some or all of their data in a
+  // ColumnarGlmData, in addition to (or instead of) the
+  // std::vector<Ptr<GlmData> > managed by their data policy.  Models
+  // using it include the columnar rows in their log likelihood, and
+  // samplers that support it iterate over the columnar rows directly.
+  class ColumnarDataPolicy{
+   public:
+    void set_columnar_data(const Ptr<ColumnarGlmData> &data){
+      columnar_data_ = data;}
+    void clear_columnar_data(){columnar_data_.reset();}
+    // Returns NULL if no columnar data has been set.
+    const Ptr<ColumnarGlmData> & columnar_data()const{
+      return columnar_data_;}
+   private:
+    Ptr<ColumnarGlmData> columnar_data_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_COLUMNAR_GLM_DATA_HPP_
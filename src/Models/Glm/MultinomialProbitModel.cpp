@@ -293,12 +293,13 @@ namespace BOOM{
     const Spd &siginv(this->siginv());
     Vec b;
     double mean,v;
+    RNG &rng(default_rng());
     rsw_mv(mean,v,b,u,wsp, siginv, y);
-    u[y] = rtrun_norm(mean, sqrt(v), second_largest, true);
+    u[y] = rtrun_norm_mt(rng, mean, sqrt(v), second_largest, true);
     for(uint i=0; i<dp->nchoices(); ++i){
       if(i!=y){
 	rsw_mv(mean,v,b,u,wsp,siginv,i);
-	u[i] = rtrun_norm(mean, sqrt(v), u[y], false);
+	u[i] = rtrun_norm_mt(rng, mean, sqrt(v), u[y], false);
       }
     }
   }
@@ -52,7 +52,7 @@ namespace BOOM {
     //   ell = y * (log(E) + log(lambda)) - E*exp(x * beta)
     //       = yXbeta - E*exp(Xbeta)
     // dell  = (y - E*lambda) * x
-    // ddell = -lambda * x * x'
+    // ddell = -E*lambda * x * x'
     double ans = 0;
     const std::vector<Ptr<PoissonRegressionData> > &data(dat());
     if (g) {
@@ -74,10 +74,40 @@ namespace BOOM {
       if(g){
         g->axpy(x, (y - exposure * lambda));
         if(h){
-          h->add_outer(x, x, -lambda);
+          h->add_outer(x, x, -exposure * lambda);
         }
       }
     }
+    if (!!columnar_data()) {
+      ans += columnar_log_likelihood(*columnar_data(), beta, g, h);
+    }
+    return ans;
+  }
+
+  double PoissonRegressionModel::columnar_log_likelihood(
+      const ColumnarGlmData &data, const Vec &beta, Vec *g, Mat *h)const{
+    const Vec &y(data.y());
+    const Vec &exposure(data.exposure());
+    int nobs = data.nobs();
+    Vec eta(nobs);
+    data.predict(0, nobs, beta, eta.data());
+    Vec residual(nobs);
+    Vec mean(nobs);
+    double ans = 0;
+    for (int i = 0; i < nobs; ++i) {
+      mean[i] = exposure[i] * exp(eta[i]);
+      ans += dpois(y[i], mean[i], true);
+      residual[i] = y[i] - mean[i];
+    }
+    if (g && h) {
+      Spd xtwx(beta.size(), 0.0);
+      Mat workspace;
+      data.add_cross_products(0, nobs, mean.data(), residual.data(),
+                              xtwx, *g, workspace);
+      *h -= xtwx;
+    } else if (g) {
+      *g += data.X().Tmult(residual);
+    }
     return ans;
   }
 
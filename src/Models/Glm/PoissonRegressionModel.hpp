@@ -21,6 +21,7 @@
 
 #include <Models/Glm/Glm.hpp>
 #include <Models/Glm/PoissonRegressionData.hpp>
+#include <Models/Glm/ColumnarGlmData.hpp>
 #include <Models/Policies/ParamPolicy_1.hpp>
 #include <Models/Policies/IID_DataPolicy.hpp>
 #include <Models/Policies/PriorPolicy.hpp>
@@ -30,12 +31,15 @@ namespace BOOM {
 
   // A PoissonRegressionModel describes a non-negative integer
   // response y ~ Poisson(E exp(beta*x)), where E is an exposure.
+  // Data can be held as PoissonRegressionData objects, as a
+  // ColumnarGlmData (using its y and exposure), or both.
   class PoissonRegressionModel
       : public GlmModel,
         public NumOptModel,
         public MixtureComponent,
         public ParamPolicy_1<GlmCoefs>,
         public IID_DataPolicy<PoissonRegressionData>,
+        public ColumnarDataPolicy,
         public PriorPolicy
   {
    public:
@@ -52,6 +56,13 @@ namespace BOOM {
     double log_likelihood(const Vec &beta, Vec *g = NULL, Mat *h = NULL)const;
     virtual double pdf(const Data *, bool logscale)const;
     double logp(const PoissonRegressionData &data)const;
+
+   private:
+    // The contribution of the columnar data to log_likelihood().
+    // g and h are incremented if they are non-NULL.  h is only used if
+    // g is also non-NULL.
+    double columnar_log_likelihood(const ColumnarGlmData &data,
+                                   const Vec &beta, Vec *g, Mat *h)const;
   };
 
 } // namespace BOOM
@@ -18,10 +18,17 @@
 
 #include <distributions.hpp>
 #include <Models/Glm/PosteriorSamplers/BinomialLogitAuxmixSampler.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <cmath>
 
 namespace BOOM {
   namespace {
     typedef BinomialLogitAuxmixSampler BLAMS;
+
+    // Columnar observations are imputed this many at a time between
+    // updates of the sufficient statistics.
+    const int kChunkSize = 256;
   }  // namespace
 
   BLAMS::SufficientStatistics::SufficientStatistics(int dim)
@@ -49,19 +56,70 @@ namespace BOOM {
     xty_.axpy(x, weighted_value);
   }
 
+  void BLAMS::SufficientStatistics::update(
+      const ColumnarGlmData &data, int begin, int end,
+      const double *weighted_values, const double *weights) {
+    data.add_cross_products(begin, end, weights, weighted_values,
+                            xtx_, xty_, workspace_);
+  }
+
   void BLAMS::SufficientStatistics::clear() {
     xtx_ = 0;
     xty_ = 0;
     sym_ = false;
   }
 
+  // Only the upper triangles of xtx_ and rhs.xtx_ need to be current,
+  // so the sum is reflected when it is next needed.
+  void BLAMS::SufficientStatistics::combine(const SufficientStatistics &rhs) {
+    xtx_ += rhs.xtx_;
+    xty_ += rhs.xty_;
+    sym_ = false;
+  }
+
+  // This is the public constructor to be called by a master node.
+  BLAMS::BinomialLogitAuxmixSampler(BinomialLogitModel *model,
+                                    Ptr<MvnBase> prior,
+                                    int clt_threshold,
+                                    int number_of_threads)
+      : model_(model),
+        data_imputer_(new BinomialLogitCltDataImputer(clt_threshold)),
+        prior_(prior),
+        suf_(model->xdim()),
+        first_time_(true)
+  {
+#ifndef NO_BOOST_THREADS
+    if (number_of_threads > 1) {
+      int shards = number_of_shards(number_of_threads);
+      workers_.reserve(shards);
+      // Each shard's worker draws from its own stream of the master's
+      // RNG.  Calling set_seed() on the master after construction does
+      // not reseed the workers.
+      unsigned long seed = seed_rng(rng());
+      for (int i = 0; i < shards; ++i) {
+        WorkerPtr worker(new BinomialLogitAuxmixSampler(
+            model_, prior_, clt_threshold, number_of_threads, i));
+        worker->rng() = rng_stream(seed, i);
+        workers_.push_back(worker);
+      }
+      thread_pool_.set_number_of_threads(number_of_threads);
+    }
+#endif
+  }
+
+  // This is the private constructor, to be used for building worker
+  // nodes.  The master's thread pool decides which observations each
+  // worker imputes.
   BLAMS::BinomialLogitAuxmixSampler(BinomialLogitModel *model,
                                     Ptr<MvnBase> prior,
-                                    int clt_threshold)
+                                    int clt_threshold,
+                                    int,
+                                    int)
       : model_(model),
         data_imputer_(new BinomialLogitCltDataImputer(clt_threshold)),
         prior_(prior),
-        suf_(model->xdim())
+        suf_(model->xdim()),
+        first_time_(false)
   {}
 
   double BLAMS::logpri() const {
@@ -74,9 +132,40 @@ namespace BOOM {
   }
 
   void BLAMS::impute_latent_data() {
-    const std::vector<Ptr<BinomialRegressionData> > & data(model_->dat());
     suf_.clear();
-    for (int i = 0; i < data.size(); ++i) {
+#ifdef NO_BOOST_THREADS
+    impute_latent_data_single_threaded();
+    first_time_ = false;
+#else
+    if (first_time_ || workers_.empty()) {
+      impute_latent_data_single_threaded();
+      first_time_ = false;
+    } else {
+      // Hand the shards of the data to the thread pool.  Each shard's
+      // worker has its own RNG and sufficient statistics, and the
+      // shards are combined in order, so the draws do not depend on
+      // which thread runs which shard.
+      thread_pool_.parallel_for(
+          workers_.size(),
+          boost::bind(&BLAMS::impute_shard, this, _1));
+      for (int i = 0; i < workers_.size(); ++i) {
+        suf_.combine(workers_[i]->suf_);
+      }
+    }
+#endif
+  }
+
+  void BLAMS::impute_latent_data_single_threaded() {
+    impute_latent_data_range(0, model_->dat().size());
+    const Ptr<ColumnarGlmData> &columns(model_->columnar_data());
+    if (!!columns) {
+      impute_columnar_range(*columns, 0, columns->nobs());
+    }
+  }
+
+  void BLAMS::impute_latent_data_range(int begin, int end) {
+    const std::vector<Ptr<BinomialRegressionData> > & data(model_->dat());
+    for (int i = begin; i < end; ++i) {
       const BinomialRegressionData &observation(*(data[i]));
       const Vector &x(observation.x());
       double eta = model_->predict(x);
@@ -100,6 +189,49 @@ namespace BOOM {
     }
   }
 
+  // Columnar data are imputed in blocks of at most kChunkSize rows.
+  // The linear predictors for a block come from one pass over the
+  // columns of X, and the block's sufficient statistics from one more.
+  void BLAMS::impute_columnar_range(const ColumnarGlmData &data,
+                                    int begin, int end) {
+    if (end - begin > kChunkSize) {
+      for (int block = begin; block < end; block += kChunkSize) {
+        impute_columnar_range(data, block, std::min(block + kChunkSize, end));
+      }
+      return;
+    }
+    const Vector &beta(model_->Beta());
+    const Vector &y(data.y());
+    const Vector &trials(data.trials());
+    double eta[kChunkSize];
+    double sums[kChunkSize];
+    double weights[kChunkSize];
+    data.predict(begin, end, beta, eta);
+    for (int i = begin; i < end; ++i) {
+      std::pair<double, double> imputed = data_imputer_->impute(
+          rng(), lround(trials[i]), lround(y[i]), eta[i - begin]);
+      sums[i - begin] = imputed.first;
+      weights[i - begin] = imputed.second;
+    }
+    suf_.update(data, begin, end, sums, weights);
+  }
+
+  void BLAMS::impute_shard(int shard) {
+    BinomialLogitAuxmixSampler &worker(*workers_[shard]);
+    int shards = workers_.size();
+    worker.suf_.clear();
+    int n = model_->dat().size();
+    worker.impute_latent_data_range(shard_begin(n, shard, shards),
+                                    shard_begin(n, shard + 1, shards));
+    const Ptr<ColumnarGlmData> &columns(model_->columnar_data());
+    if (!!columns) {
+      n = columns->nobs();
+      worker.impute_columnar_range(*columns,
+                                   shard_begin(n, shard, shards),
+                                   shard_begin(n, shard + 1, shards));
+    }
+  }
+
   void BLAMS::draw_params() {
     Spd ivar = prior_->siginv() + suf_.xtx();
     Vector ivar_mu = suf_.xty() + prior_->siginv() * prior_->mu();
@@ -115,6 +247,12 @@ namespace BOOM {
     } else if (method == Partial) {
       data_imputer_.reset(
           new BinomialLogitPartialAugmentationDataImputer(clt_threshold));
+    } else if (method == PolyaGamma) {
+      data_imputer_.reset(
+          new BinomialLogitPolyaGammaDataImputer(clt_threshold));
+    }
+    for (int i = 0; i < workers_.size(); ++i) {
+      workers_[i]->set_augmentation_method(method, clt_threshold);
     }
   }
 
@@ -23,16 +23,29 @@
 #include <Models/Glm/BinomialLogitModel.hpp>
 #include <Models/Glm/PosteriorSamplers/BinomialLogitDataImputer.hpp>
 #include <Models/MvnBase.hpp>
+#include <cpputil/ThreadPool.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
 
 namespace BOOM {
 
   class BinomialLogitAuxmixSampler : public PosteriorSampler {
    public:
-    enum ImputationMethod {Full, Partial};
-
+    // Full and Partial use the normal mixture approximation to the
+    // logistic distribution (see BinomialLogitDataImputer.hpp).
+    // PolyaGamma uses Polya-Gamma latent variables, which give the
+    // exact conditional distribution of beta with one latent variable
+    // per observation.
+    enum ImputationMethod {Full, Partial, PolyaGamma};
+
+    // If number_of_threads > 1 the latent data are imputed by a pool
+    // of that many threads.  The data are split into a fixed number of
+    // shards, each with its own random number generator and data
+    // imputer.
     BinomialLogitAuxmixSampler(BinomialLogitModel *model,
                                Ptr<MvnBase> prior,
-                               int clt_threshold = 10);
+                               int clt_threshold = 10,
+                               int number_of_threads = 1);
     virtual double logpri() const;
     virtual void draw();
 
@@ -52,21 +65,59 @@ namespace BOOM {
       void update(const Vector &x,
                   double weighted_value,
                   double weight);
+      // Adds rows [begin, end) of 'data', where weighted_values and
+      // weights are indexed from 'begin'.
+      void update(const ColumnarGlmData &data, int begin, int end,
+                  const double *weighted_values,
+                  const double *weights);
       void clear();
+      // Adds the sufficient statistics in rhs to this object.
+      void combine(const SufficientStatistics &rhs);
      private:
       mutable SpdMatrix xtx_;
       Vector xty_;
       mutable bool sym_;
+      Matrix workspace_;
     };
 
    protected:
     const SufficientStatistics & suf() const {return suf_;}
 
    private:
+    // This private constructor builds the workers used by the public
+    // constructor when number_of_threads > 1.  The thread arguments
+    // only distinguish it from the public constructor.
+    BinomialLogitAuxmixSampler(BinomialLogitModel *model,
+                               Ptr<MvnBase> prior,
+                               int clt_threshold,
+                               int number_of_threads,
+                               int thread_id);
+
+    void impute_latent_data_single_threaded();
+    // Imputes the latent data for observations [begin, end) of
+    // model_->dat(), adding them to suf_.
+    void impute_latent_data_range(int begin, int end);
+    // Imputes rows [begin, end) of the model's columnar data, adding
+    // them to suf_.
+    void impute_columnar_range(const ColumnarGlmData &data,
+                               int begin, int end);
+    // Imputes one shard of model_->dat() and of the columnar data using
+    // workers_[shard], replacing the worker's sufficient statistics.
+    void impute_shard(int shard);
+
     BinomialLogitModel *model_;
     boost::shared_ptr<BinomialLogitDataImputer> data_imputer_;
     Ptr<MvnBase> prior_;
     SufficientStatistics suf_;
+
+    // A flag when running in 'master mode'
+    bool first_time_;
+
+    // Workers used by the master's thread pool, one per shard of the
+    // data.  Each holds the sufficient statistics for its shard.
+    typedef boost::shared_ptr<BinomialLogitAuxmixSampler> WorkerPtr;
+    std::vector<WorkerPtr> workers_;
+    ThreadPool thread_pool_;
   };
 
 
@@ -19,6 +19,7 @@
 #include <Models/Glm/PosteriorSamplers/BinomialLogitDataImputer.hpp>
 #include <distributions.hpp>
 #include <distributions/trun_logit.hpp>
+#include <distributions/polya_gamma.hpp>
 #include <cpputil/math_utils.hpp>
 #include <cpputil/report_error.hpp>
 
@@ -37,6 +38,11 @@ namespace BOOM {
              "0.105680086433879 0.345939491553619 0.0442261124345564 "
              "0.193289780660134 0.068173066865908 0.00452437089387876"));
 
+  //----------------------------------------------------------------------
+  BinomialLogitDataImputer::BinomialLogitDataImputer()
+      : normal_draws_(BatchDrawBuffer::STANDARD_NORMAL)
+  {}
+
   //----------------------------------------------------------------------
   void BinomialLogitDataImputer::debug_status_message(
       ostream &out,
@@ -80,7 +86,8 @@ namespace BOOM {
         // mu is unused because the mixture is a scale-mixture only,
         // but we need it for the API.
         double mu, sigsq;
-        mixture_approximation.unmix(rng, latent_logit - eta, &mu, &sigsq);
+        mixture_approximation.unmix(rng, latent_logit - eta, &mu, &sigsq,
+                                  unmix_workspace_);
         double current_weight = 1.0 / sigsq;
         information += current_weight;
         information_weighted_sum += latent_logit * current_weight;
@@ -106,8 +113,8 @@ namespace BOOM {
       // (approximated by a normal), divided by the weight that each
       // term in the sum recieves (the variance of the logistic
       // distribution, pi^2/3).
-      information_weighted_sum =
-          rnorm_mt(rng, mean_of_logit_sum, sqrt(variance_of_logit_sum));
+      information_weighted_sum = mean_of_logit_sum
+          + sqrt(variance_of_logit_sum) * normal_draws_.draw(rng);
       information_weighted_sum /= pi_squared_over_3;
 
       // Each latent logit carries the same amount of information:
@@ -149,7 +156,8 @@ namespace BOOM {
       // mu is unused because the mixture is a scale-mixture only,
       // but we need it for the API.
       double mu, sigsq;
-      mixture_approximation.unmix(rng, latent_logit - eta, &mu, &sigsq);
+      mixture_approximation.unmix(rng, latent_logit - eta, &mu, &sigsq,
+                                  unmix_workspace_);
       double current_weight = 1.0 / sigsq;
       information += current_weight;
       information_weighted_sum += latent_logit * current_weight;
@@ -213,8 +221,8 @@ namespace BOOM {
         simulation_variance += N1_[m] * truncated_normal_variance / sig4;
       }
     }
-    double information_weighted_sum =
-        rnorm_mt(rng, simulation_mean, sqrt(simulation_variance));
+    double information_weighted_sum = simulation_mean
+        + sqrt(simulation_variance) * normal_draws_.draw(rng);
     return std::make_pair(information_weighted_sum, information);
   }
 
@@ -222,4 +230,43 @@ namespace BOOM {
   int BinomialLogitCltDataImputer::clt_threshold() const {
     return clt_threshold_;
   }
+
+  //======================================================================
+  BinomialLogitPolyaGammaDataImputer::BinomialLogitPolyaGammaDataImputer(
+      int clt_threshold)
+      : clt_threshold_(clt_threshold)
+  {}
+
+  std::pair<double, double> BinomialLogitPolyaGammaDataImputer::impute(
+      RNG &rng, int number_of_trials, int number_of_successes, double eta) {
+    if (number_of_successes < 0 || number_of_trials < 0
+        || number_of_successes > number_of_trials) {
+      ostringstream err;
+      err << "Illegal values of number_of_trials and number_of_successes "
+          << "in BinomialLogitPolyaGammaDataImputer::impute()." << endl;
+      debug_status_message(err, number_of_trials, number_of_successes, eta);
+      report_error(err.str());
+    }
+    if (number_of_trials == 0) {
+      return std::make_pair(0.0, 0.0);
+    }
+    double kappa = number_of_successes - 0.5 * number_of_trials;
+    double omega;
+    if (number_of_trials >= clt_threshold()) {
+      // omega is a sum of number_of_trials independent PG(1, eta)
+      // draws.  The sum is kept positive because it is a precision.
+      double mean = pg_mean(number_of_trials, eta);
+      double sd = sqrt(pg_variance(number_of_trials, eta));
+      do {
+        omega = mean + sd * normal_draws_.draw(rng);
+      } while (omega <= 0);
+    } else {
+      omega = rpg_mt(rng, number_of_trials, eta);
+    }
+    return std::make_pair(kappa, omega);
+  }
+
+  int BinomialLogitPolyaGammaDataImputer::clt_threshold() const {
+    return clt_threshold_;
+  }
 }  // namespace BOOM
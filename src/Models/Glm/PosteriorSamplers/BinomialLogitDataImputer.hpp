@@ -20,6 +20,7 @@
 #define BOOM_BINOMIAL_LOGIT_DATA_IMPUTER_HPP_
 
 #include <Models/Glm/PosteriorSamplers/NormalMixtureApproximation.hpp>
+#include <distributions/batch_draws.hpp>
 
 namespace BOOM {
 
@@ -27,6 +28,7 @@ namespace BOOM {
   // distribution.
   class BinomialLogitDataImputer {
    public:
+    BinomialLogitDataImputer();
     virtual ~BinomialLogitDataImputer() {}
 
     // Args:
@@ -57,6 +59,16 @@ namespace BOOM {
                               int number_of_trials,
                               int number_of_successes,
                               double eta) const;
+
+    // Standard normal draws for the large sample approximations,
+    // generated in batches.  Because of this (and other workspace in
+    // the derived classes) each thread needs its own imputer.
+    BatchDrawBuffer normal_draws_;
+
+    // Workspace for mixture_approximation.unmix().  The approximation
+    // is shared by all imputers, but each imputer has its own
+    // workspace so imputers in different threads do not collide.
+    Vector unmix_workspace_;
   };
 
   //=======================================================================
@@ -204,6 +216,37 @@ namespace BOOM {
         double eta);
   };
 
+  //=======================================================================
+  // Polya-Gamma data augmentation (Polson, Scott, and Windle 2013).
+  // Given omega ~ PG(number_of_trials, log_odds), the binomial
+  // likelihood is proportional to a normal likelihood in log_odds,
+  // with mean kappa / omega and precision omega, where kappa =
+  // number_of_successes - number_of_trials / 2.  There is one latent
+  // variable per observation, regardless of the number of trials, and
+  // no mixture approximation is involved.
+  class BinomialLogitPolyaGammaDataImputer
+      : public BinomialLogitDataImputer {
+   public:
+    // Args:
+    //   clt_threshold: The smallest number_of_trials where omega is
+    //     drawn from a normal approximation (with the exact mean and
+    //     variance) instead of from PG(number_of_trials, log_odds),
+    //     whose cost is linear in number_of_trials.
+    BinomialLogitPolyaGammaDataImputer(int clt_threshold = 10);
+
+    // Returns:
+    //   The first element in the returned pair is kappa, which is the
+    //   information weighted sum (omega * kappa / omega).  The second
+    //   is the information, omega.
+    std::pair<double, double> impute(RNG &rng,
+                                     int number_of_trials,
+                                     int number_of_successes,
+                                     double log_odds);
+
+    int clt_threshold()const;
+   private:
+    int clt_threshold_;
+  };
 
 }
 
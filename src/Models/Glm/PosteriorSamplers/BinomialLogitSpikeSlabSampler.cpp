@@ -26,8 +26,9 @@ namespace BOOM{
   BLSSS::BinomialLogitSpikeSlabSampler(BinomialLogitModel *m,
                                        Ptr<MvnBase> pri,
                                        Ptr<VariableSelectionPrior> vpri,
-                                       int clt_threshold)
-      : BinomialLogitAuxmixSampler(m, pri, clt_threshold),
+                                       int clt_threshold,
+                                       int number_of_threads)
+      : BinomialLogitAuxmixSampler(m, pri, clt_threshold, number_of_threads),
         m_(m),
         pri_(pri),
         vpri_(vpri),
@@ -131,20 +132,50 @@ namespace BOOM{
       report_error(err.str());
     }
 
+    // The sufficient statistics do not change during the sweep, so
+    // the factor can be updated one flip at a time.
+    const Spd &xtx(suf().xtx());
+    const Vec &xty(suf().xty());
+    SpikeSlabPosteriorFactor factor(pri_->siginv(), pri_->mu(), xtx, xty);
+    // If g cannot be factored the factor holds the empty model, so
+    // this sweep computes each model probability from scratch.
+    SpikeSlabPosteriorFactor *factor_ptr = factor.reset(g) ? &factor : NULL;
+
     uint n = g.nvars_possible();
     if(max_flips_ > 0) n = std::min<int>(n, max_flips_);
+    RNG &eng(default_rng());
     for(uint i=0; i<n; ++i){
-      logp = mcmc_one_flip(g, indx[i], logp);
+      logp = mcmc_one_flip(eng, g, factor_ptr, indx[i], logp);
     }
     m_->coef().set_inc(g);
   }
 
-  double BLSSS::mcmc_one_flip(Selector &mod, uint which_var, double logp_old){
+  double BLSSS::log_model_prob(const Selector &g,
+                               const SpikeSlabPosteriorFactor &factor)const{
+    double num = vpri_->logp(g);
+    if(num==BOOM::negative_infinity() || g.nvars() == 0) return num;
+    return num + factor.log_integrated_likelihood();
+  }
+
+  double BLSSS::mcmc_one_flip(RNG &rng, Selector &mod,
+                              SpikeSlabPosteriorFactor *factor,
+                              uint which_var, double logp_old){
     mod.flip(which_var);
-    double logp_new = log_model_prob(mod);
-    double u = runif(0,1);
+    double logp_new;
+    bool factored = false;
+    if(factor){
+      // A failed flip means the proposed model has a singular
+      // posterior precision, so it has zero probability.
+      factored = factor->flip(which_var);
+      logp_new = factored ? log_model_prob(mod, *factor)
+          : BOOM::negative_infinity();
+    }else{
+      logp_new = log_model_prob(mod);
+    }
+    double u = runif_mt(rng, 0, 1);
     if(log(u) > logp_new - logp_old){
       mod.flip(which_var);  // reject draw
+      if(factored) factor->flip(which_var);
       return logp_old;
     }
     return logp_new;
@@ -20,6 +20,7 @@
 
 #include <Models/Glm/PosteriorSamplers/BinomialLogitAuxmixSampler.hpp>
 #include <Models/Glm/VariableSelectionPrior.hpp>
+#include <Models/Glm/PosteriorSamplers/SpikeSlabPosteriorFactor.hpp>
 #include <LinAlg/Selector.hpp>
 
 namespace BOOM{
@@ -28,8 +29,8 @@ namespace BOOM{
     BinomialLogitSpikeSlabSampler(BinomialLogitModel *m,
                                   Ptr<MvnBase> pri,
                                   Ptr<VariableSelectionPrior> vpri,
-                                  int clt_threshold
-                                  );
+                                  int clt_threshold,
+                                  int number_of_threads = 1);
 
     virtual void draw();
     virtual double logpri()const;
@@ -51,7 +52,16 @@ namespace BOOM{
     // will be sampled.
     void limit_model_selection(int max_flips);
    private:
-    double mcmc_one_flip(Selector &mod, uint which_var, double logp_old);
+    // Proposes flipping which_var, using rng to accept or reject.  The
+    // log model probability of the proposal comes from 'factor', which
+    // describes mod, or is computed from scratch if 'factor' is NULL.
+    double mcmc_one_flip(RNG &rng, Selector &mod,
+                         SpikeSlabPosteriorFactor *factor,
+                         uint which_var, double logp_old);
+    // Same as log_model_prob(g), but uses the factor maintained
+    // during draw_model_indicators, which must describe g.
+    double log_model_prob(const Selector &g,
+                          const SpikeSlabPosteriorFactor &factor)const;
     BinomialLogitModel *m_;
     Ptr<MvnBase> pri_;
     Ptr<VariableSelectionPrior> vpri_;
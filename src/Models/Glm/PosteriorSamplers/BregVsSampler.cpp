@@ -184,12 +184,44 @@ namespace BOOM{
     return ans;
   }
   //----------------------------------------------------------------------
-  double BVS::mcmc_one_flip(Selector &mod, uint which_var, double logp_old){
+  // With beta_tilde = P^{-1} r, the sum of squares computed in
+  // set_reg_post_params simplifies to
+  //   prior_ss + yty + b^T Ominv b - r^T P^{-1} r,
+  // which the factor supplies without solving for beta_tilde.
+  double BVS::log_model_prob(const Selector &g,
+                             const SpikeSlabPosteriorFactor &factor)const{
+    double ans = vpri_->logp(g);
+    if(ans == negative_infinity()){
+      return ans;
+    }
+    Ptr<RegSuf> s = m_->suf();
+    double df = s->n() + prior_df();
+    double ss = prior_ss() + s->yty() + factor.prior_quadratic_form()
+        - factor.posterior_quadratic_form();
+    ans += .5*(factor.prior_logdet() - factor.posterior_logdet());
+    ans -= (.5*df-1)*log(ss);
+    return ans;
+  }
+  //----------------------------------------------------------------------
+  double BVS::mcmc_one_flip(RNG &rng, Selector &mod,
+                            SpikeSlabPosteriorFactor *factor,
+                            uint which_var, double logp_old){
     mod.flip(which_var);
-    double logp_new = log_model_prob(mod);
-    double u = runif(0,1);
+    double logp_new;
+    bool factored = false;
+    if(factor){
+      // A failed flip means the proposed model has a singular
+      // posterior precision, so it has zero probability.
+      factored = factor->flip(which_var);
+      logp_new = factored ? log_model_prob(mod, *factor)
+          : negative_infinity();
+    }else{
+      logp_new = log_model_prob(mod);
+    }
+    double u = runif_mt(rng, 0, 1);
     if(log(u) > logp_new - logp_old){
       mod.flip(which_var);  // reject draw
+      if(factored) factor->flip(which_var);
       return logp_old;
     }
     return logp_new;
@@ -240,9 +272,19 @@ namespace BOOM{
       throw_exception<std::runtime_error>(err.str());
     }
 
+    // The sufficient statistics and prior do not change during the
+    // sweep, so the factor can be updated one flip at a time.
+    Spd xtx = m_->suf()->xtx();
+    Vec xty = m_->suf()->xty();
+    SpikeSlabPosteriorFactor factor(bpri_->ominv(), bpri_->mu(), xtx, xty);
+    // If g cannot be factored the factor holds the empty model, so
+    // this sweep computes each model probability from scratch.
+    SpikeSlabPosteriorFactor *factor_ptr = factor.reset(g) ? &factor : NULL;
+
     uint n = std::min<uint>(max_nflips_, g.nvars_possible());
+    RNG &eng(default_rng());
     for(uint i=0; i<n; ++i){
-      logp = mcmc_one_flip(g, indx[i], logp);
+      logp = mcmc_one_flip(eng, g, factor_ptr, indx[i], logp);
     }
     m_->coef().set_inc(g);
   }
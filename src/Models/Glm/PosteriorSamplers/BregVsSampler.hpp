@@ -22,6 +22,7 @@
 #include <Models/PosteriorSamplers/PosteriorSampler.hpp>
 #include <Models/MvnGivenScalarSigma.hpp>
 #include <Models/Glm/VariableSelectionPrior.hpp>
+#include <Models/Glm/PosteriorSamplers/SpikeSlabPosteriorFactor.hpp>
 #include <Models/MvnGivenSigma.hpp>
 #include <Models/GammaModel.hpp>
 
@@ -133,7 +134,16 @@ namespace BOOM{
     mutable double DF_, SS_;
 
     double set_reg_post_params(const Selector &g, bool do_ldoi)const;
-    double mcmc_one_flip(Selector &g, uint which_var, double logp_of_g);
+    // Proposes flipping which_var, using rng to accept or reject.  The
+    // log model probability of the proposal comes from 'factor', which
+    // describes g, or is computed from scratch if 'factor' is NULL.
+    double mcmc_one_flip(RNG &rng, Selector &g,
+                         SpikeSlabPosteriorFactor *factor,
+                         uint which_var, double logp_of_g);
+    // Same as log_model_prob(g), but uses the factor maintained
+    // during draw_model_indicators, which must describe g.
+    double log_model_prob(const Selector &g,
+                          const SpikeSlabPosteriorFactor &factor)const;
 
     void draw_beta();
     void draw_model_indicators();
@@ -206,18 +206,19 @@ namespace BOOM{
     uint pch = mlm_->choice_nvars();
     if(pch>0) xtu_choice = 0;
 
+    RNG &eng(default_rng());
     for(uint i=0; i<n; ++i){
       Ptr<ChoiceData> dp = dat[i];
       mlm_->fill_eta(*dp, eta);
       uint y = dp->value();
       double loglam = lse(eta);
-      double logzmin = rlexp(loglam);
+      double logzmin = rlexp_mt(eng, loglam);
       logz2[0] = logzmin;
       u[y] = mu- logzmin;
       const Vec & xsub(dp->Xsubject());
       for(uint m=0; m<M; ++m){
 	if(m!=y){
-	  logz2[1] =rlexp(eta[m]);
+	  logz2[1] = rlexp_mt(eng, eta[m]);
 	  double logz = lse(logz2);
 	  u[m] = mu-logz;}
 	xtu_subject[m].axpy(xsub, u[m]);
@@ -40,12 +40,13 @@ namespace BOOM{
     uint K = dim();
     Vec ivar(K);
 
+    RNG &eng(default_rng());
     for(uint k=0; k<K; ++k){
       double alpha = ivar_pri_[k]->alpha();
       double df = nobs[k];
       double beta = ivar_pri_[k]->beta();
       double ss = ss_diag[k];
-      ivar[k] = rgamma(alpha + df/2, beta + ss/2);
+      ivar[k] = rgamma_mt(eng, alpha + df/2, beta + ss/2);
     }
     Spd Siginv(K);
     Siginv.set_diag(ivar);
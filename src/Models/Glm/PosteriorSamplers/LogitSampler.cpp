@@ -52,11 +52,12 @@ namespace BOOM{
     uint n = dat.size();
     suf_->clear();
     Vec beta(mod_->beta());
+    RNG &eng(default_rng());
     for(uint i=0; i<n; ++i){
       Ptr<BRD> dp = dat[i];
       const Vec &x(dp->x());
       double eta = mod_->predict(x) + log_alpha;
-      double z = draw_z(dp->y(), eta);
+      double z = draw_z(eng, dp->y(), eta);
       double lam = draw_lambda(fabs(z- eta));
       suf_->add_data(x,z, 1.0/lam);
     }
@@ -69,9 +70,9 @@ namespace BOOM{
     mod_->set_beta(ivar_mu);
   }
 
-  double LS::draw_z(bool y, double eta)const{
+  double LS::draw_z(RNG &rng, bool y, double eta)const{
     double trun_prob = plogis(0, eta);
-    double u = y ? runif(trun_prob,1) : runif(0,trun_prob);
+    double u = y ? runif_mt(rng, trun_prob, 1) : runif_mt(rng, 0, trun_prob);
     return qlogis(u,eta);
   }
 
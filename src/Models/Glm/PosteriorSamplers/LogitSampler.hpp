@@ -42,7 +42,7 @@ namespace BOOM{
     const Ptr<WeightedRegSuf> suf()const{return suf_;}
 
   private:
-    double draw_z(bool y, double eta)const;
+    double draw_z(RNG &rng, bool y, double eta)const;
     double draw_lambda(double r)const;
     void draw_beta();
 
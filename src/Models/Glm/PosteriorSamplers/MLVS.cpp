@@ -148,10 +148,10 @@ namespace BOOM{
     mod_->set_beta(Beta);
   }
 
-  inline bool keep_flip(double logp_old, double logp_new){
+  inline bool keep_flip(RNG &rng, double logp_old, double logp_new){
     if(!finite(logp_new)) return false;
     double pflip = logit_inv(logp_new - logp_old);
-    double u = runif(0,1);
+    double u = runif_mt(rng, 0, 1);
     return u < pflip ? true : false;
   }
 
@@ -170,13 +170,33 @@ namespace BOOM{
 
     std::vector<uint> flips = seq<uint>(0, nv-1);
     std::random_shuffle(flips.begin(), flips.end());
+    // The complete data sufficient statistics are fixed during the
+    // sweep, so the factor can be updated one flip at a time.
+    SpikeSlabPosteriorFactor factor(pri->siginv(), pri->mu(),
+                                    suf->xtwx(), suf->xtwu());
+    // If inc cannot be factored the factor holds the empty model, so
+    // this sweep computes each model probability from scratch.
+    bool use_factor = factor.reset(inc);
+
     uint hi = std::min<uint>(nv, max_nflips());
+    RNG &eng(default_rng());
     for(uint i=0; i<hi; ++i){
       uint I = flips[i];
       inc.flip(I);
-      double logp_new = log_model_prob(inc);
-      if( keep_flip(logp, logp_new)) logp = logp_new;
-      else inc.flip(I);  // reject the flip, so flip back
+      double logp_new;
+      bool factored = false;
+      if(use_factor){
+        factored = factor.flip(I);
+        logp_new = factored ? log_model_prob(inc, factor)
+            : BOOM::negative_infinity();
+      }else{
+        logp_new = log_model_prob(inc);
+      }
+      if( keep_flip(eng, logp, logp_new)) logp = logp_new;
+      else{
+        inc.flip(I);  // reject the flip, so flip back
+        if(factored) factor.flip(I);
+      }
     }
     mod_->coef().set_inc(inc);
   }
@@ -209,4 +229,11 @@ namespace BOOM{
     return num-denom;
   }
 
+  double MLVS::log_model_prob(const Selector &g,
+                              const SpikeSlabPosteriorFactor &factor)const{
+    double num = vpri->logp(g);
+    if(num==BOOM::negative_infinity()) return num;
+    return num + factor.log_integrated_likelihood();
+  }
+
 }
@@ -24,6 +24,7 @@
 #include <Models/Glm/VariableSelectionPrior.hpp>
 #include <Models/Glm/PosteriorSamplers/MLVS_base.hpp>
 #include <Models/Glm/PosteriorSamplers/MLVS_data_imputer.hpp>
+#include <Models/Glm/PosteriorSamplers/SpikeSlabPosteriorFactor.hpp>
 
 
 namespace BOOM{
@@ -83,6 +84,10 @@ namespace BOOM{
     Spd iV_tilde_;
     virtual void draw_inclusion_vector();
     double log_model_prob(const Selector &inc);
+    // Same as log_model_prob(g), but uses the factor maintained
+    // during draw_inclusion_vector, which must describe g.
+    double log_model_prob(const Selector &g,
+                          const SpikeSlabPosteriorFactor &factor)const;
   };
 
   //------------------------------------------------------------
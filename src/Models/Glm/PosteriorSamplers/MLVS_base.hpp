@@ -39,7 +39,7 @@ namespace BOOM{
   public:
     friend void intrusive_ptr_add_ref(MlvsCdSuf *d){d->up_count();}
     friend void intrusive_ptr_release(MlvsCdSuf *d){
-      d->down_count(); if(d->ref_count()==0) delete d;}
+      if(d->down_count()==0) delete d;}
 
     virtual ~MlvsCdSuf(){}
     virtual MlvsCdSuf * clone()const=0;
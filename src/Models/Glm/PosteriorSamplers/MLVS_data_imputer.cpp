@@ -25,14 +25,11 @@
 #include <stats/logit.hpp>
 
 #include <distributions.hpp>
+#include <distributions/batch_draws.hpp>
+#include <algorithm>
 #include <cmath>
 
-#ifndef NO_BOOST_THREAD
-#include <boost/thread.hpp>
-
-using boost::thread_group;
-using boost::thread;
-#endif
+#include <boost/bind.hpp>
 
 namespace BOOM{
 
@@ -67,38 +64,38 @@ namespace BOOM{
     MDI_threaded::MDI_threaded(MLogitBase *m,  Ptr<MlvsCdSuf> s,
 			       uint nthreads)
       : mlm(m),
-	suf(s)
+	suf(s),
+	pool(nthreads)
     {
-      for(uint i=0; i<nthreads; ++i){
-	NEW(MDI_worker, worker)(m, s, i, nthreads);
+      int shards = number_of_shards(nthreads);
+      unsigned long seed = seed_rng();
+      for(int i=0; i<shards; ++i){
+	NEW(MDI_worker, worker)(m, s, i, shards);
+	worker->set_rng(rng_stream(seed, i));
 	crew.push_back(worker);
       }
     }
 
+    // Each shard of the data has its own worker, with its own RNG and
+    // sufficient statistics, so the draws do not depend on which
+    // thread runs which shard.  The shards' sufficient statistics are
+    // added in order once they are all done.
     void MDI_threaded::draw(){
-      boost::thread_group tg;
-      for(uint i=0; i<crew.size(); ++i){
-	tg.add_thread(new thread(boost::ref(*crew[i])));
-      }
-      tg.join_all();
-
+      pool.parallel_for(crew.size(),
+                        boost::bind(&MDI_threaded::impute_shard, this, _1));
       suf->clear();
-      for(uint i=0; i<crew.size(); ++i){
-	Ptr<MlvsCdSuf> s = crew[i]->suf();
-	suf->add(crew[i]->suf());
-      }
+      for(uint i=0; i<crew.size(); ++i) suf->add(crew[i]->suf());
+    }
+
+    void MDI_threaded::impute_shard(int shard){
+      int n = mlm->dat().size();
+      crew[shard]->suf()->clear();
+      crew[shard]->impute_range(shard_begin(n, shard, crew.size()),
+                                shard_begin(n, shard + 1, crew.size()));
     }
 #endif
     //======================================================================
 
-    unsigned long getseed(){
-       double u = runif() * std::numeric_limits<unsigned long>::max();
-       // convert from double to long long (using llround), and then
-       // from long long to unsigned long.
-       unsigned long ans(llround(u));
-       return ans;
-     }
-    //======================================================================
     MDIW::MDI_worker(MLogitBase *mod,
 		     Ptr<MlvsCdSuf> s,
 		     uint tid, uint nt)
@@ -118,11 +115,10 @@ namespace BOOM{
 	u(mod->Nchoices()),
 	eta(u),
 	wgts(u),
+	exponential_draws_(u),
 	thisX(new Mat(1,1)),
-	rng(getseed())
-    {
-      rng.seed();
-    }
+	rng(seed_rng())
+    {}
     //----------------------------------------------------------------------
     void MDIW::impute_u(Ptr<ChoiceData> dp){
       mlm->fill_eta(*dp, eta);      // eta+= downsampling_logprob
@@ -131,11 +127,17 @@ namespace BOOM{
       uint y = dp->value();
       assert(y<M);
       double loglam = lse(eta);
-      double logzmin = rlexp_mt(rng, loglam);
+      // log(E) - loglam has the same distribution as rlexp_mt(rng,
+      // loglam) when E is a standard exponential.  E is zero with
+      // negligible probability, but rlexp_mt handles that case.
+      rexp_batch_mt(rng, exponential_draws_);
+      double logzmin = exponential_draws_[y] > 0 ?
+          log(exponential_draws_[y]) - loglam : rlexp_mt(rng, loglam);
       u[y] = - logzmin;
       for(uint m=0; m<M; ++m){
 	if(m!=y){
-	  double tmp = rlexp_mt(rng, eta[m]);
+	  double tmp = exponential_draws_[m] > 0 ?
+              log(exponential_draws_[m]) - eta[m] : rlexp_mt(rng, eta[m]);
 	  double logz = lse2(logzmin, tmp);
 	  u[m] = -logz;
 	}
@@ -152,6 +154,7 @@ namespace BOOM{
     }
     //----------------------------------------------------------------------
     void MDIW::operator()(){
+      ThreadRngScope rng_scope(rng);
       const std::vector<Ptr<ChoiceData> > & dat(mlm->dat());
       suf_->clear();
       uint n = dat.size();
@@ -163,9 +166,20 @@ namespace BOOM{
 	i+= nthreads;}
     }
 
+    void MDIW::impute_range(int begin, int end){
+      ThreadRngScope rng_scope(rng);
+      const std::vector<Ptr<ChoiceData> > & dat(mlm->dat());
+      for(int i = begin; i < end; ++i){
+	Ptr<ChoiceData> dp(dat[i]);
+	impute_u(dp);
+	suf_->update(dp, wgts, u);
+      }
+    }
+
     //----------------------------------------------------------------------
 
     void MDIW::seed(unsigned long s){ rng.seed(s); }
+    void MDIW::set_rng(const RNG &r){ rng = r; }
 
     const Ptr<MlvsCdSuf> MDIW::suf()const{ return suf_;}
 
@@ -23,6 +23,7 @@
 #include <Models/Glm/MLogitBase.hpp>
 #include <Models/Glm/PosteriorSamplers/MLVS_base.hpp>
 #include <distributions/rng.hpp>
+#include <cpputil/ThreadPool.hpp>
 
 namespace BOOM{
 
@@ -39,7 +40,7 @@ namespace BOOM{
     friend void intrusive_ptr_add_ref(MlvsDataImputer *d){
       d->up_count();}
     friend void intrusive_ptr_release(MlvsDataImputer *d){
-      d->down_count(); if(d->ref_count()==0) delete d;}
+      if(d->down_count()==0) delete d;}
 
   private:
     Ptr<mlvs_impute::MDI_base> imp;
@@ -54,7 +55,7 @@ namespace BOOM{
 
       friend void intrusive_ptr_add_ref(MDI_worker *d){d->up_count();}
       friend void intrusive_ptr_release(MDI_worker *d){
-	d->down_count(); if(d->ref_count()==0) delete d;}
+	if(d->down_count()==0) delete d;}
 
       MDI_worker(MLogitBase *mod,
 		 Ptr<MlvsCdSuf> s,
@@ -64,7 +65,11 @@ namespace BOOM{
       uint unmix(double u);
       const Ptr<MlvsCdSuf> suf()const;
       void operator()();
+      // Imputes observations [begin, end), adding them to suf().
+      // Unlike operator(), this does not clear suf() first.
+      void impute_range(int begin, int end);
       void seed(unsigned long);
+      void set_rng(const RNG &);
 
     private:
       MLogitBase *mlm;
@@ -83,6 +88,9 @@ namespace BOOM{
       Vec u;
       Vec eta;
       Vec wgts;
+      // Standard exponential draws for the current observation,
+      // filled in one batch by impute_u.
+      Vec exponential_draws_;
 
       boost::shared_ptr<Mat> thisX;
       RNG rng;
@@ -92,7 +100,7 @@ namespace BOOM{
     public:
       friend void intrusive_ptr_add_ref(MDI_base *d){d->up_count();}
       friend void intrusive_ptr_release(MDI_base *d){
-	d->down_count(); if(d->ref_count()==0) delete d;}
+	if(d->down_count()==0) delete d;}
 
       virtual void draw()=0;
       virtual ~MDI_base(){}
@@ -115,9 +123,13 @@ namespace BOOM{
       MDI_threaded(MLogitBase *m, Ptr<MlvsCdSuf> s, uint nthreads);
       virtual void draw();
     private:
+      // Imputes one shard of the observations using crew[shard].
+      void impute_shard(int shard);
+
       MLogitBase *mlm;
       Ptr<MlvsCdSuf> suf;
       std::vector<Ptr<MDI_worker> > crew;
+      ThreadPool pool;
     };
 
   }
@@ -167,9 +167,9 @@ namespace BOOM{
     return ans;
   }
   //----------------------------------------------------------------------
-  static inline bool keep_flip(double logp_old, double logp_new){
+  static inline bool keep_flip(RNG &rng, double logp_old, double logp_new){
     double pflip = logit_inv(logp_new - logp_old);
-    double u = runif(0,1);
+    double u = runif_mt(rng, 0, 1);
     return u < pflip ? true : false;
   }
   //----------------------------------------------------------------------
@@ -183,11 +183,12 @@ namespace BOOM{
       std::vector<uint> flips = seq<uint>(0,nv-1);
       std::random_shuffle(flips.begin(), flips.end());
       uint hi = std::min<uint>(nv, max_nflips());
+      RNG &eng(default_rng());
       for(uint i=0; i<hi; ++i){
 	uint I = flips[i];
 	inc.flip(I);
 	double logp_new = log_model_prob(inc,m);
-	if( keep_flip(logp, logp_new)) logp = logp_new;
+	if( keep_flip(eng, logp, logp_new)) logp = logp_new;
 	else inc.flip(I);  // reject the flip, so flip back
       }
       mod_->set_inc_subject(inc,m);
@@ -288,12 +288,18 @@ namespace BOOM {
 
   void NormalMixtureApproximation::unmix(
       RNG &rng, double u, double *mu, double *sigsq) const {
-    wsp_ = log_weights_;
+    unmix(rng, u, mu, sigsq, wsp_);
+  }
+
+  void NormalMixtureApproximation::unmix(
+      RNG &rng, double u, double *mu, double *sigsq,
+      Vector &workspace) const {
+    workspace = log_weights_;
     for (int s = 0; s < dim(); ++s) {
-      wsp_[s] += dnorm(u, mu_[s], sigma_[s], true);
+      workspace[s] += dnorm(u, mu_[s], sigma_[s], true);
     }
-    wsp_.normalize_logprob();
-    int mixture_indicator = rmulti_mt(rng, wsp_);
+    workspace.normalize_logprob();
+    int mixture_indicator = rmulti_mt(rng, workspace);
     *mu = mu_[mixture_indicator];
     *sigsq = square(sigma_[mixture_indicator]);
   }
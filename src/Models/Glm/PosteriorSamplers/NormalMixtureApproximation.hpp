@@ -100,6 +100,10 @@ namespace BOOM {
     // being approximated, take a random draw of the mixture component
     // that generated it.
     void unmix(RNG &rng, double u, double *mu, double *sigsq)const;
+    // The same, but using caller-supplied workspace instead of the
+    // object's own, so that threads can share one approximation.
+    void unmix(RNG &rng, double u, double *mu, double *sigsq,
+               Vector &workspace)const;
 
     double kullback_leibler()const;
     // Records the answer in state.
@@ -93,11 +93,12 @@ namespace BOOM{
     uint p = prior_mean_.size();
     models_.clear();
     models_.reserve(N);
+    RNG &eng(default_rng());
     for(uint i=0; i<N; ++i){
       Selector mod(p,false);
       while(mod.nvars()==0){
 	for(uint j = 0; j<p; ++j){
-	  double u = runif(0,1);
+	  double u = runif_mt(eng, 0, 1);
 	  if(u < inc_probs_[j]) mod.add(j);
 	}
       }
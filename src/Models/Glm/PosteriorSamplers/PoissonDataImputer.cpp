@@ -28,6 +28,10 @@ namespace BOOM {
   PoissonDataImputer::mixture_table_(
       create_poisson_mixture_approximation_table());
 
+  PoissonDataImputer::PoissonDataImputer()
+      : exponential_draws_(BatchDrawBuffer::STANDARD_EXPONENTIAL)
+  {}
+
   void PoissonDataImputer::impute(RNG &rng,
                                   int response,
                                   double exposure,
@@ -42,7 +46,7 @@ namespace BOOM {
     double time_of_final_internal_event = response > 0 ?
         exposure * (rbeta_mt(rng, response, 1)) : 0;
     double final_interarrival_time = exposure - time_of_final_internal_event
-        + rexp_mt(rng, exp(log_lambda));
+        + exponential_draws_.draw(rng) * exp(-log_lambda);
     double z_external = -log(final_interarrival_time);
     double mu = 0;
     double sigsq = 1;
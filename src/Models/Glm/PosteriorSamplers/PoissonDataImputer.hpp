@@ -20,6 +20,7 @@
 #define BOOM_POISSON_DATA_IMPUTER_HPP_
 
 #include <distributions/rng.hpp>
+#include <distributions/batch_draws.hpp>
 #include <Models/Glm/PosteriorSamplers/NormalMixtureApproximation.hpp>
 
 namespace BOOM {
@@ -38,6 +39,8 @@ namespace BOOM {
   // Subsequent augmentations can be safely multi-threaded.
   class PoissonDataImputer {
    public:
+    PoissonDataImputer();
+
     // Impute the required variances and excess residuals given
     // observed data.  Pointer arguments are used for output, and may
     // not be NULL.
@@ -85,6 +88,11 @@ namespace BOOM {
     // possible values of y (the "response") have been observed it is
     // safe to run in multi-threaded mode.
     static NormalMixtureApproximationTable mixture_table_;
+
+    // The standard exponential draws needed for the final
+    // interarrival times, generated in batches.  Each thread needs
+    // its own PoissonDataImputer for this reason.
+    BatchDrawBuffer exponential_draws_;
   };
 
 }  // namespace BOOM
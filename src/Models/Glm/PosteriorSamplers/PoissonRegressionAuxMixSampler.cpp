@@ -20,12 +20,16 @@
 #include <Models/Glm/PosteriorSamplers/poisson_mixture_approximation_table.hpp>
 #include <distributions.hpp>
 
-#ifndef NO_BOOST_THREADS
-#include <boost/thread/thread.hpp>
-#endif
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <cmath>
 
 namespace {
   inline double square(double x) { return x * x; }
+
+  // The number of columnar observations imputed between updates of
+  // the sufficient statistics.
+  const int kPoissonChunkSize = 256;
 }
 
 namespace BOOM {
@@ -39,46 +43,45 @@ namespace BOOM {
         prior_(prior),
         complete_data_suf_(model_->xdim()),
         data_imputer_(new PoissonDataImputer),
-        first_time_(true),
-        num_threads_(1),
-        thread_id_(0)
+        first_time_(true)
   {
-    // Note that num_threads_ is set to 1, and not the number of
-    // threads actually used, because this is the constructor for the
-    // master object.  num_threads_ needs to be set to 1 (and
-    // thread_id = 0, for impute_latent_data method to work correctly
-    // in the unthreaded case (i.e. when there is a master but no
-    // workers).
 #ifndef NO_BOOST_THREADS
     if (number_of_threads > 1) {
-      workers_.reserve(number_of_threads);
-      for (int i = 0; i < number_of_threads; ++i) {
+      int shards = number_of_shards(number_of_threads);
+      workers_.reserve(shards);
+      // Each shard's worker draws from its own stream of the master's
+      // RNG.  Calling set_seed() on the master after construction does
+      // not reseed the workers.
+      unsigned long seed = seed_rng(rng());
+      for (int i = 0; i < shards; ++i) {
         boost::shared_ptr<PoissonRegressionAuxMixSampler> data_imputer(
             new PoissonRegressionAuxMixSampler(
                 model_,
                 prior_,
                 number_of_threads,
                 i));
+        data_imputer->rng() = rng_stream(seed, i);
         workers_.push_back(data_imputer);
       }
+      thread_pool_.set_number_of_threads(number_of_threads);
     }
 #endif
   }
 
   // This is the private constructor, to be used for building worker
-  // nodes.
+  // nodes.  The thread arguments only distinguish it from the public
+  // constructor.  The master's thread pool decides which observations
+  // each worker imputes.
   PoissonRegressionAuxMixSampler::PoissonRegressionAuxMixSampler(
       PoissonRegressionModel *model,
       Ptr<MvnBase> prior,
-      int num_threads,
-      int thread_id)
+      int,
+      int)
       : model_(model),
         prior_(prior),
         complete_data_suf_(model->xdim()),
         data_imputer_(new PoissonDataImputer),
-        first_time_(false),
-        num_threads_(num_threads),
-        thread_id_(thread_id)
+        first_time_(false)
   {}
 
   double PoissonRegressionAuxMixSampler::logpri()const{
@@ -90,19 +93,16 @@ namespace BOOM {
     draw_beta_given_complete_data();
   }
 
-  class PoissonRegressionDataImputer {
-   public:
-    PoissonRegressionDataImputer(PoissonRegressionAuxMixSampler *sampler)
-        : sampler_(sampler) {}
-    void operator()() { sampler_->impute_latent_data(); }
-   private:
-    PoissonRegressionAuxMixSampler *sampler_;
-  };
-
   void PoissonRegressionAuxMixSampler::impute_latent_data_single_threaded(){
+    impute_latent_data_range(0, model_->dat().size());
+    const Ptr<ColumnarGlmData> &columns(model_->columnar_data());
+    if (!!columns) impute_columnar_range(*columns, 0, columns->nobs());
+  }
+
+  void PoissonRegressionAuxMixSampler::impute_latent_data_range(
+      int begin, int end){
     const std::vector<Ptr<PoissonRegressionData> > &data(model_->dat());
-    int n = data.size();
-    for(int i = thread_id_; i < n; i += num_threads_){
+    for(int i = begin; i < end; ++i){
       const PoissonRegressionData *dp = data[i].get();
       const Vec &x(dp->x());
       double eta = model_->predict(x);
@@ -130,6 +130,57 @@ namespace BOOM {
     }
   }
 
+  // Columnar data are imputed in blocks of at most kPoissonChunkSize
+  // rows.  The linear predictors for a block come from one pass over
+  // the columns of X, and each of the two latent regressions adds
+  // the block to complete_data_suf_ with one more.
+  void PoissonRegressionAuxMixSampler::impute_columnar_range(
+      const ColumnarGlmData &data, int begin, int end){
+    if (end - begin > kPoissonChunkSize) {
+      for (int block = begin; block < end; block += kPoissonChunkSize) {
+        impute_columnar_range(
+            data, block, std::min(block + kPoissonChunkSize, end));
+      }
+      return;
+    }
+    const Vec &beta(model_->Beta());
+    const Vec &y(data.y());
+    const Vec &exposure(data.exposure());
+    double eta[kPoissonChunkSize];
+    double internal_value[kPoissonChunkSize];
+    double internal_weight[kPoissonChunkSize];
+    double external_value[kPoissonChunkSize];
+    double external_weight[kPoissonChunkSize];
+    data.predict(begin, end, beta, eta);
+    for (int i = begin; i < end; ++i) {
+      int k = i - begin;
+      int yi = lround(y[i]);
+      double internal_neglog_final_event_time;
+      double internal_mu;
+      double neglog_final_interarrival_time;
+      double external_mu;
+      data_imputer_->impute(rng(), yi, exposure[i], eta[k],
+                            &internal_neglog_final_event_time,
+                            &internal_mu,
+                            &internal_weight[k],
+                            &neglog_final_interarrival_time,
+                            &external_mu,
+                            &external_weight[k]);
+      if (yi > 0) {
+        internal_value[k] = internal_neglog_final_event_time - internal_mu;
+      } else {
+        // There is no internal event time when y is zero.
+        internal_value[k] = 0;
+        internal_weight[k] = 0;
+      }
+      external_value[k] = neglog_final_interarrival_time - external_mu;
+    }
+    complete_data_suf_.add_data(data, begin, end, internal_value,
+                                internal_weight, workspace_);
+    complete_data_suf_.add_data(data, begin, end, external_value,
+                                external_weight, workspace_);
+  }
+
   // The latent variable scheme imagines the event times of y[i]
   // events from a Poisson process that occur in the interval [0, 1].
   // The maximum of these events, denoted tau[i], is marginally
@@ -160,17 +211,16 @@ namespace BOOM {
       first_time_ = false;
     } else {
       // If this class is a master class using threads, and if at
-      // least one trip through the data has taken place, then launch
-      // a series of threads to do the data augmentation.
-      std::vector<boost::shared_ptr<boost::thread> > threads;
-      for (int i = 0; i < workers_.size(); ++i) {
-        boost::shared_ptr<boost::thread> thread(
-            new boost::thread(
-                PoissonRegressionDataImputer(workers_[i].get())));
-        threads.push_back(thread);
-      }
+      // least one trip through the data has taken place, then hand
+      // the shards of the data to the thread pool.  Each shard's
+      // worker has its own RNG and sufficient statistics, and the
+      // shards are combined in order, so the draws do not depend on
+      // which thread runs which shard.
+      thread_pool_.parallel_for(
+          workers_.size(),
+          boost::bind(&PoissonRegressionAuxMixSampler::impute_shard,
+                      this, _1));
       for (int i = 0; i < workers_.size(); ++i) {
-        threads[i]->join();
         complete_data_suf_.combine(
             workers_[i]->complete_data_sufficient_statistics());
       }
@@ -178,6 +228,22 @@ namespace BOOM {
 #endif
   }
 
+  void PoissonRegressionAuxMixSampler::impute_shard(int shard) {
+    PoissonRegressionAuxMixSampler &worker(*workers_[shard]);
+    int shards = workers_.size();
+    worker.complete_data_suf_.clear();
+    int n = model_->dat().size();
+    worker.impute_latent_data_range(shard_begin(n, shard, shards),
+                                    shard_begin(n, shard + 1, shards));
+    const Ptr<ColumnarGlmData> &columns(model_->columnar_data());
+    if (!!columns) {
+      n = columns->nobs();
+      worker.impute_columnar_range(*columns,
+                                   shard_begin(n, shard, shards),
+                                   shard_begin(n, shard + 1, shards));
+    }
+  }
+
   double PoissonRegressionAuxMixSampler::draw_final_event_time(int y){
     return rbeta_mt(rng(), y, 1);
   }
@@ -25,6 +25,7 @@
 #include <Models/Glm/WeightedRegressionModel.hpp>
 #include <Models/MvnBase.hpp>
 #include <Models/Glm/PosteriorSamplers/NormalMixtureApproximation.hpp>
+#include <cpputil/ThreadPool.hpp>
 
 namespace BOOM{
 
@@ -58,22 +59,33 @@ class PoissonRegressionAuxMixSampler : public PosteriorSampler {
                                  int thread_id);
 
   void impute_latent_data_single_threaded();
+  // Imputes the latent data for observations [begin, end), adding
+  // them to complete_data_suf_.
+  void impute_latent_data_range(int begin, int end);
+  // Imputes rows [begin, end) of the model's columnar data, adding
+  // them to complete_data_suf_.
+  void impute_columnar_range(const ColumnarGlmData &data,
+                             int begin, int end);
+  // Imputes one shard of model_->dat() and of the columnar data using
+  // workers_[shard], replacing the worker's sufficient statistics.
+  void impute_shard(int shard);
 
   PoissonRegressionModel *model_;
   Ptr<MvnBase> prior_;
   WeightedRegSuf complete_data_suf_;
   boost::shared_ptr<PoissonDataImputer> data_imputer_;
+  // Workspace for adding columnar data to complete_data_suf_.
+  Mat workspace_;
 
   // A flag when running in 'master mode'
   bool first_time_;
 
-  // num_threads_ and thread_id_ are used by slaves in the impute_data
-  // method.  To check the number of threads in the master, you should
-  // call data_imputers_.size(), and not rely on num_threads_.
-  int num_threads_;
-  int thread_id_;
+  // Workers used by the master's thread pool, one per shard of the
+  // data.  Each has its own RNG and accumulates the complete data
+  // sufficient statistics for its shard.
   typedef boost::shared_ptr<PoissonRegressionAuxMixSampler> WorkerPtr;
   std::vector<WorkerPtr> workers_;
+  ThreadPool thread_pool_;
 };
 
 }  // namespace BOOM
@@ -83,10 +83,10 @@ namespace BOOM{
   void PSSS::allow_model_selection(){ allow_selection_ = true;}
   uint PSSS::max_nflips()const{ return max_nflips_;}
 
-  bool PSSS::keep_flip(double logp_old, double logp_new)const{
+  bool PSSS::keep_flip(RNG &rng, double logp_old, double logp_new)const{
     if(!finite(logp_new)) return false;
     double pflip = logit_inv(logp_new - logp_old);
-    double u = runif(0,1);
+    double u = runif_mt(rng, 0, 1);
     return u < pflip ? true : false;
   }
 
@@ -107,18 +107,45 @@ namespace BOOM{
     std::vector<uint> flips = seq<uint>(0, nv-1);
     std::random_shuffle(flips.begin(), flips.end());
 
+    // xtx and xtz are fixed during the sweep, so the factor can be
+    // updated one flip at a time.
+    SpikeSlabPosteriorFactor factor(beta_prior_->siginv(), beta_prior_->mu(),
+                                    xtx(), xtz());
+    // If inc cannot be factored the factor holds the empty model, so
+    // this sweep computes each model probability from scratch.
+    bool use_factor = factor.reset(inc);
+
     uint hi = std::min<uint>(nv, max_nflips());
+    RNG &eng(default_rng());
     for(uint i=0; i<hi; ++i){
       uint I = flips[i];
       inc.flip(I);
-      double logp_new = log_model_prob(inc);
-      if( keep_flip(logp, logp_new)) logp = logp_new;
-      else inc.flip(I);  // reject the flip, so flip back
+      double logp_new;
+      bool factored = false;
+      if(use_factor){
+        factored = factor.flip(I);
+        logp_new = factored ? log_model_prob(inc, factor)
+            : BOOM::negative_infinity();
+      }else{
+        logp_new = log_model_prob(inc);
+      }
+      if( keep_flip(eng, logp, logp_new)) logp = logp_new;
+      else{
+        inc.flip(I);  // reject the flip, so flip back
+        if(factored) factor.flip(I);
+      }
     }
     m_->coef().set_inc(inc);
 
   }
 
+  double PSSS::log_model_prob(const Selector &g,
+                              const SpikeSlabPosteriorFactor &factor)const{
+    double num = gamma_prior_->logp(g);
+    if(num==BOOM::negative_infinity()) return num;
+    return num + factor.log_integrated_likelihood();
+  }
+
   double PSSS::log_model_prob(const Selector & g){
     double num = gamma_prior_->logp(g);
     if(num==BOOM::negative_infinity()) return num;
@@ -19,6 +19,7 @@
 #define BOOM_PROBIT_SPIKE_SLAB_SAMPLER_HPP_
 #include <Models/Glm/PosteriorSamplers/ProbitRegressionSampler.hpp>
 #include <Models/Glm/VariableSelectionPrior.hpp>
+#include <Models/Glm/PosteriorSamplers/SpikeSlabPosteriorFactor.hpp>
 namespace BOOM{
 
 class ProbitSpikeSlabSampler : public ProbitRegressionSampler{
@@ -39,8 +40,12 @@ class ProbitSpikeSlabSampler : public ProbitRegressionSampler{
   void draw_gamma();
   virtual void draw_beta();
  private:
-  bool keep_flip(double logp_new, double logp_old)const;
+  bool keep_flip(RNG &rng, double logp_old, double logp_new)const;
   double log_model_prob(const Selector &inc);
+  // Same as log_model_prob(g), but uses the factor maintained during
+  // draw_gamma, which must describe g.
+  double log_model_prob(const Selector &g,
+                        const SpikeSlabPosteriorFactor &factor)const;
 
   ProbitRegressionModel *m_;
   Ptr<MvnBase> beta_prior_;
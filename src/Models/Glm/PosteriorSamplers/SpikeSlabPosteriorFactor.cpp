@@ -0,0 +1,136 @@
+/*
+  Copyright (C) 2005-2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+#include <Models/Glm/PosteriorSamplers/SpikeSlabPosteriorFactor.hpp>
+#include <cpputil/report_error.hpp>
+#include <algorithm>
+#include <sstream>
+
+namespace BOOM{
+  typedef SpikeSlabPosteriorFactor SSPF;
+
+  SSPF::SpikeSlabPosteriorFactor(const Spd &ominv, const Vec &mu,
+                                 const Spd &xtx, const Vec &xty)
+      : ominv_(ominv),
+        mu_(mu),
+        xtx_(xtx),
+        xty_(xty),
+        prior_(Matrix()),
+        posterior_(Matrix())
+  {}
+
+  bool SSPF::reset(const Selector &g){
+    order_.clear();
+    ominv_mu_.clear();
+    prior_ = Chol(Matrix());
+    posterior_ = Chol(Matrix());
+    for(uint t = 0; t < g.nvars(); ++t){
+      if(!add(g.indx(t))){
+        reset(Selector(g.nvars_possible(), false));
+        return false;
+      }
+    }
+    return true;
+  }
+
+  int SSPF::position(uint i)const{
+    std::vector<uint>::const_iterator it =
+        std::find(order_.begin(), order_.end(), i);
+    return it == order_.end() ? -1 : it - order_.begin();
+  }
+
+  bool SSPF::add(uint i){
+    if(position(i) >= 0){
+      std::ostringstream err;
+      err << "Variable " << i << " is already in the model." << std::endl;
+      report_error(err.str());
+    }
+    uint k = order_.size();
+    // Only the upper triangles of the symmetric matrices are read.
+    Vec prior_row(k + 1);
+    Vec posterior_row(k + 1);
+    double new_ominv_mu = 0;
+    for(uint t = 0; t < k; ++t){
+      uint j = order_[t];
+      double ominv_ij = j < i ? ominv_(j, i) : ominv_(i, j);
+      double xtx_ij = j < i ? xtx_(j, i) : xtx_(i, j);
+      prior_row[t] = ominv_ij;
+      posterior_row[t] = ominv_ij + xtx_ij;
+      new_ominv_mu += ominv_ij * mu_[j];
+    }
+    prior_row[k] = ominv_(i, i);
+    posterior_row[k] = ominv_(i, i) + xtx_(i, i);
+    new_ominv_mu += ominv_(i, i) * mu_[i];
+
+    if(!prior_.add_row(prior_row)) return false;
+    if(!posterior_.add_row(posterior_row)){
+      prior_.drop_row(k);
+      return false;
+    }
+    for(uint t = 0; t < k; ++t) ominv_mu_[t] += prior_row[t] * mu_[i];
+    ominv_mu_.push_back(new_ominv_mu);
+    order_.push_back(i);
+    return true;
+  }
+
+  void SSPF::drop(uint i){
+    int pos = position(i);
+    if(pos < 0){
+      std::ostringstream err;
+      err << "Variable " << i << " is not in the model." << std::endl;
+      report_error(err.str());
+    }
+    uint k = order_.size();
+    for(uint t = 0; t < k; ++t){
+      uint j = order_[t];
+      ominv_mu_[t] -= (j < i ? ominv_(j, i) : ominv_(i, j)) * mu_[i];
+    }
+    prior_.drop_row(pos);
+    posterior_.drop_row(pos);
+    ominv_mu_.erase(ominv_mu_.begin() + pos);
+    order_.erase(order_.begin() + pos);
+  }
+
+  bool SSPF::flip(uint i){
+    if(position(i) >= 0){
+      drop(i);
+      return true;
+    }
+    return add(i);
+  }
+
+  double SSPF::prior_quadratic_form()const{
+    double ans = 0;
+    for(uint t = 0; t < order_.size(); ++t){
+      ans += mu_[order_[t]] * ominv_mu_[t];
+    }
+    return ans;
+  }
+
+  double SSPF::posterior_quadratic_form()const{
+    uint k = order_.size();
+    Vec r(k);
+    for(uint t = 0; t < k; ++t) r[t] = xty_[order_[t]] + ominv_mu_[t];
+    return posterior_.Lsolve(r).normsq();
+  }
+
+  double SSPF::log_integrated_likelihood()const{
+    return .5 * (prior_logdet() - prior_quadratic_form()
+                 - posterior_logdet() + posterior_quadratic_form());
+  }
+
+}
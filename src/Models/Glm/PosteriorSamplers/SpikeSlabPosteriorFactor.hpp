@@ -0,0 +1,96 @@
+/*
+  Copyright (C) 2005-2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+#ifndef BOOM_SPIKE_SLAB_POSTERIOR_FACTOR_HPP_
+#define BOOM_SPIKE_SLAB_POSTERIOR_FACTOR_HPP_
+
+#include <LinAlg/Cholesky.hpp>
+#include <LinAlg/Selector.hpp>
+#include <LinAlg/SpdMatrix.hpp>
+#include <LinAlg/Vector.hpp>
+#include <vector>
+
+namespace BOOM{
+
+  // Keeps the terms needed for the marginal posterior probability of
+  // an inclusion vector g in a conjugate spike and slab regression,
+  // while g changes one variable at a time.
+  //
+  // Let beta_g ~ N(mu_g, Ominv_g^{-1}) be the slab, with sufficient
+  // statistics xtx and xty for the full model.  The log of the
+  // marginal likelihood of g is (up to a constant)
+  //
+  //   .5 * log|Ominv_g| - .5 * mu_g^T Ominv_g mu_g
+  //   - .5 * log|P_g| + .5 * r_g^T P_g^{-1} r_g,
+  //
+  // where P_g = Ominv_g + xtx_g and r_g = xty_g + Ominv_g mu_g.
+  // Cholesky factors of Ominv_g and P_g are updated in place when a
+  // variable is added or dropped, so a flip costs O(k^2) for a model
+  // with k variables, instead of the O(k^3) to factor from scratch.
+  //
+  // The prior and sufficient statistics are held by reference, and
+  // must not change while the object is in use (e.g. during a sweep
+  // through the inclusion indicators).
+  class SpikeSlabPosteriorFactor{
+   public:
+    SpikeSlabPosteriorFactor(const Spd &ominv, const Vec &mu,
+                             const Spd &xtx, const Vec &xty);
+
+    // Factors the matrices for g from scratch.  Returns false if
+    // either one is not positive definite, in which case the object
+    // holds the empty model.
+    bool reset(const Selector &g);
+
+    // Adds variable i to the model.  Returns false, and leaves the
+    // model unchanged, if that would make either matrix singular.
+    bool add(uint i);
+    void drop(uint i);
+
+    // Adds i if it is absent, or drops it if present.  Returns false
+    // if the add fails.
+    bool flip(uint i);
+
+    uint nvars()const{return order_.size();}
+
+    double prior_logdet()const{return prior_.logdet();}        // log|Ominv_g|
+    double posterior_logdet()const{return posterior_.logdet();} // log|P_g|
+    double prior_quadratic_form()const;      // mu_g^T Ominv_g mu_g
+    double posterior_quadratic_form()const;  // r_g^T P_g^{-1} r_g
+
+    // The log marginal likelihood given above.
+    double log_integrated_likelihood()const;
+
+   private:
+    const Spd &ominv_;
+    const Vec &mu_;
+    const Spd &xtx_;
+    const Vec &xty_;
+
+    // order_[t] is the variable in row t of the factors.  Variables
+    // are kept in the order they were added, not in index order,
+    // because the quantities above do not depend on the order.
+    std::vector<uint> order_;
+    Chol prior_;
+    Chol posterior_;
+    // ominv_mu_[t] is element t of Ominv_g * mu_g, in factor order.
+    Vec ominv_mu_;
+
+    int position(uint i)const;
+  };
+
+}
+#endif  // BOOM_SPIKE_SLAB_POSTERIOR_FACTOR_HPP_
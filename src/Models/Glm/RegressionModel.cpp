@@ -156,14 +156,16 @@ namespace BOOM{
     //    if(!current) refresh_qr();
     return Qty*qr.getR(); }
 
+  // X_g = Q * R_g, where R_g holds the selected columns of R, so
+  // X_g^T X_g = R_g^T R_g and X_g^T y = R_g^T Q^T y.
   Spd QrRegSuf::xtx(const Selector &inc)const{
     //    if(!current) refresh_qr();
-    return RTR(inc.select_square(qr.getR()));
+    return RTR(inc.select_cols(qr.getR()));
   }
 
   Vec QrRegSuf::xty(const Selector &inc)const{
     //    if(!current) refresh_qr();
-    return inc.select(Qty)*inc.select_square(qr.getR()); }
+    return Qty*inc.select_cols(qr.getR()); }
 
 
   double QrRegSuf::yty()const{return sumsqy;}
@@ -153,7 +153,11 @@ namespace BOOM{
 
   //------------------------------------------------------------
 
+  // An observation with zero weight contributes nothing to the cross
+  // products, so it is treated as absent rather than counted in n_
+  // (where it would also make sumlogw_ infinite).
   void WRS::add_data(const Vec &x, double y, double w){
+    if(w == 0) return;
     ++n_;
     yt_w_y_ += w*y*y;
     sumlogw_ += log(w);
@@ -162,6 +166,22 @@ namespace BOOM{
     sym_ = false;
   }
 
+  void WRS::add_data(const ColumnarGlmData &data, int begin, int end,
+                     const double *y, const double *w, Mat &workspace){
+    int m = end - begin;
+    std::vector<double> wy(m);
+    for(int i = 0; i < m; ++i){
+      wy[i] = w[i] * y[i];
+      if(w[i] != 0){
+        ++n_;
+        yt_w_y_ += wy[i] * y[i];
+        sumlogw_ += log(w[i]);
+      }
+    }
+    data.add_cross_products(begin, end, w, &wy[0], xtwx_, xtwy_, workspace);
+    sym_ = true;
+  }
+
   void WRS::clear(){
     xtwx_=0.0;
     xtwy_ = 0.0;
@@ -21,6 +21,7 @@
 
 #include "RegressionModel.hpp"
 #include "Glm.hpp"
+#include "ColumnarGlmData.hpp"
 
 namespace BOOM{
 
@@ -56,7 +57,17 @@ namespace BOOM{
 
     //    virtual void Update(const RegressionData &);
     virtual void Update(const WeightedRegressionData &);
+    // Observations with zero weight are treated as absent: they add
+    // nothing to the cross products and are not counted in n() or
+    // sumlogw().
     void add_data(const Vec &x, double y, double w);
+    // Adds rows [begin, end) of data.X(), with responses y and weights
+    // w indexed from 'begin'.  Zero weight rows are passed to the
+    // cross products, where they add nothing, and are not counted,
+    // the same as add_data(x, y, 0).  'workspace' is passed to
+    // ColumnarGlmData::add_cross_products.
+    void add_data(const ColumnarGlmData &data, int begin, int end,
+                  const double *y, const double *w, Mat &workspace);
     virtual void clear();
     virtual uint size()const;  // dimension of beta
     virtual double yty()const;              // Y^t W Y
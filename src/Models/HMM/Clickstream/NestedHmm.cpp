@@ -4,13 +4,10 @@
 #include <LinAlg/Matrix.hpp>
 #include <LinAlg/SubMatrix.hpp>
 #include <LinAlg/Selector.hpp>
-#include <Models/HMM/hmm_tools.hpp>
 #include <distributions.hpp>
 #include <distributions/Markov.hpp>
 
-#ifndef NO_BOOST_THREADS
-#include <boost/thread.hpp>
-#endif
+#include <boost/bind.hpp>
 
 namespace BOOM {
 
@@ -41,11 +38,9 @@ namespace BOOM {
         loglike_(new UnivParams(0.0)),
         logpost_(new UnivParams(0.0)),
         pi_(S1*S2),
-        logpi0_(S1*S2),
         logd_(S1*S2),
-        one_(S1 * S2, 1.0),
-        logQ1_(S1*S2, S1*S2),
-        logQ2_(S1*S2, S1*S2)
+        wsp_(S2),
+        wsp2_(S2)
   {
     setup();
   }
@@ -59,11 +54,9 @@ namespace BOOM {
         loglike_(new UnivParams(0.0)),
         logpost_(new UnivParams(0.0)),
         pi_(S1*S2),
-        logpi0_(S1*S2),
         logd_(S1*S2),
-        one_(S1 * S2, 1.0),
-        logQ1_(S1*S2, S1*S2),
-        logQ2_(S1*S2, S1*S2)
+        wsp_(S2),
+        wsp2_(S2)
       {
         setup();
       }
@@ -87,15 +80,76 @@ namespace BOOM {
   //----------------------------------------------------------------------
   int NestedHmm::Nstreams()const{ return dat().size();}
   //----------------------------------------------------------------------
-  double NestedHmm::initialize(Ptr<Event> dp)const{
-    fill_logd(dp);
-    pi_ = logpi0_ + logd_;
-    double M = max(pi_);
-    pi_-=M;
-    pi_ = exp(pi_);
-    double nc = sum(pi_);
-    pi_/=nc;
-    return M+log(nc);
+  double NestedHmm::fwd_step(Ptr<Event> event, int t,
+                             bool first_in_session)const{
+    int S = S1_ * S2_;
+    double *pred = predicted_.data() + t * S;
+    double *filt = filtered_.data() + t * S;
+    if(t==0){
+      const Vec & phi2(session_model()->pi0());
+      for(int H=0; H<S2_; ++H){
+        const Vec & phi1(event_model(H)->pi0());
+        for(int h=0; h<S1_; ++h) pred[encode_state(H,h)] = phi2[H] * phi1[h];
+      }
+    }else if(first_in_session){
+      predict_new_session(filt - S, pred);
+    }else{
+      predict_within_session(filt - S, pred);
+    }
+
+    fill_logd(event);
+    double max_logd = logd_.max();
+    double total = 0;
+    for(int s=0; s<S; ++s){
+      filt[s] = pred[s] * exp(logd_[s] - max_logd);
+      total += filt[s];
+    }
+    if(total > 0){
+      for(int s=0; s<S; ++s) filt[s] /= total;
+    }
+    return max_logd + log(total);
+  }
+  //----------------------------------------------------------------------
+  void NestedHmm::predict_within_session(const double *prev,
+                                         double *pred)const{
+    for(int H=0; H<S2_; ++H){
+      // Phi1 is stored by column, so column h is contiguous.
+      const double *Phi1 = event_model(H)->Q().data();
+      const double *prev_H = prev + encode_state(H,0);
+      double *pred_H = pred + encode_state(H,0);
+      for(int h=0; h<S1_; ++h){
+        const double *column = Phi1 + h * S1_;
+        double prediction = 0;
+        for(int r=0; r<S1_; ++r) prediction += prev_H[r] * column[r];
+        pred_H[h] = prediction;
+      }
+    }
+  }
+  //----------------------------------------------------------------------
+  void NestedHmm::predict_new_session(const double *prev,
+                                      double *pred)const{
+    fill_session_margins(prev);
+    for(int H=0; H<S2_; ++H){
+      const Vec & phi1(event_model(H)->pi0());
+      double *pred_H = pred + encode_state(H,0);
+      for(int h=0; h<S1_; ++h) pred_H[h] = wsp2_[H] * phi1[h];
+    }
+  }
+  //----------------------------------------------------------------------
+  void NestedHmm::fill_session_margins(const double *pi)const{
+    for(int H=0; H<S2_; ++H){
+      const double *pi_H = pi + encode_state(H,0);
+      double total = 0;
+      for(int h=0; h<S1_; ++h) total += pi_H[h];
+      wsp_[H] = total;
+    }
+    const Mat & Phi2(session_model()->Q());
+    for(int H=0; H<S2_; ++H){
+      const double *column = Phi2.data() + H * S2_;
+      double prediction = 0;
+      for(int r=0; r<S2_; ++r) prediction += wsp_[r] * column[r];
+      wsp2_[H] = prediction;
+    }
   }
   //----------------------------------------------------------------------
   double NestedHmm::loglike(){
@@ -164,9 +218,10 @@ namespace BOOM {
   }
   //----------------------------------------------------------------------
   void NestedHmm::print_filter(ostream &out, int j)const{
+    int S = S1_ * S2_;
     for(int i = 0; i<=j; ++i){
-      out << "filter for transition " << i << endl
-          << P[i] << endl;
+      out << "filtered distribution for event " << i << endl
+          << ConstVectorView(filtered_.data() + i * S, S, 1) << endl;
     }
   }
 
@@ -176,33 +231,28 @@ namespace BOOM {
     int Nsessions = u->nsessions();
     int stream_nevents = u->number_of_events_including_eos();
     check_filter_size(stream_nevents);
+    int S = S1_ * S2_;
     int event_num=0;
     for(int i = 0; i < Nsessions; ++i){
       Ptr<Session> session = u->session(i);
       int nevents = session->number_of_events_including_eos();
       for(int j=0; j<nevents; ++j){
         Ptr<Event> event(session->event(j));
-        if(i==0 && j==0){
-          ans += initialize(event);
-          if(!finite(ans)){
-            print_event(cerr, "found an infinte value while initializing "
-                        "the fb filter", u, session, event, j);
-          }
-        }else{
-          fill_logd(event);
-          // use logQ1_ if the first event in a session.
-          // use logQ2_ otherwise
-          const Mat & logQ(j==0 ? logQ1_ : logQ2_);
-          ans+= fwd_1(pi_, P[event_num], logQ, logd_, one_);
-          if(!finite(ans)  || !finite(pi_[0])){
-            print_event(cerr, "found an infinity in NestedHmm::fwd",
-                        u, session, event, j);
-          }
+        ans += fwd_step(event, event_num, j==0);
+        if(!finite(ans)){
+          pi_ = ConstVectorView(filtered_.data() + event_num * S, S, 1);
+          print_event(cerr, event_num == 0 ?
+                      "found an infinte value while initializing the fb filter"
+                      : "found an infinity in NestedHmm::fwd",
+                      u, session, event, j);
         }
         ++event_num;
       }
     }
     assert(event_num==stream_nevents);
+    // bkwd_sampling and bkwd_smoothing start from the last filtered
+    // distribution.
+    pi_ = ConstVectorView(filtered_.data() + (event_num - 1) * S, S, 1);
     return ans;
   }
   //----------------------------------------------------------------------
@@ -211,16 +261,25 @@ namespace BOOM {
   }
   //----------------------------------------------------------------------
   void NestedHmm::bkwd_smoothing(Ptr<Stream>  u ){
-
-    // check this.  make sure now-then correctly updated, and do
-    // boundary cases.
+    // On entry pi_ is the filtered distribution of the last event,
+    // which is also its smoothed distribution.  Each step replaces
+    // pi_ with the smoothed distribution of the previous event.  The
+    // smoothed joint distribution of two consecutive states is
+    //
+    //   p(s[t-1], s[t] | y) = filtered[t-1](s[t-1]) * Q(s[t-1], s[t])
+    //                         * pi_(s[t]) / predicted[t](s[t]),
+    //
+    // where Q is block diagonal within a session, and Q((H1,h1), (H2,h2))
+    // = Phi2(H1, H2) * phi1[H2](h2) between sessions, so only the
+    // blocks that can be nonzero are ever formed.
 
     int Nsessions = u->nsessions();
     int event_num = u->number_of_events_including_eos();
+    int S = S1_ * S2_;
 
-    Vec hinit, Hinit;
-    Mat htrans, Htrans;
-    Vec wsp(S2_*S1_);
+    Vec ratio(S);
+    Mat htrans(S1_, S1_);
+    Mat Htrans(S2_, S2_);
 
     for(int i = Nsessions; i!=0; --i){
       Ptr<Session> session(u->session(i-1));
@@ -229,14 +288,8 @@ namespace BOOM {
         --event_num;
 
         Ptr<Event> event(session->event(j-1));
-        // pi_ is the distribution of the hidden Markov chain
+        // pi_ is the smoothed distribution of the hidden Markov chain
         // corresponding to event
-
-        // P[event_num] is the joint distribution of the hidden Markov
-        // chain for event and its predecessor
-
-        // P[0] is undefined
-
         for(int H=0; H<S2_; ++H){
           for(int h=0; h<S1_; ++h){
             double p = pi_[encode_state(H,h)];
@@ -246,57 +299,73 @@ namespace BOOM {
 
         if(j==1){    // first event in a session, record initial h
           for(int H=0; H<S2_; ++H){
-            hinit = get_hinit(pi_, H);
+            Vec hinit(ConstVectorView(pi_.data() + encode_state(H,0),
+                                      S1_, 1));
             event_model(H)->suf()->add_initial_distribution(hinit);
           }
-
           if(i==1){  // first event in any session, record initial H
-            Hinit = get_Hinit(pi_);
-            session_model()->suf()->add_initial_distribution(Hinit);
-          }else{     // first event in a later session, record H transition
-            Htrans = get_Htrans(P[event_num]);
-            session_model()->suf()->add_transition_distribution(Htrans);
+            session_model()->suf()->add_initial_distribution(get_Hinit(pi_));
+            continue;
           }
+        }
+
+        const double *pred = predicted_.data() + event_num * S;
+        const double *prev = filtered_.data() + (event_num - 1) * S;
+        for(int s=0; s<S; ++s){
+          ratio[s] = pred[s] > 0 ? pi_[s] / pred[s] : 0;
+        }
+
+        if(j==1){    // first event in a later session, record H transition
+          // wsp_[H] = sum_h phi1[H](h) * ratio(H, h)
+          for(int H=0; H<S2_; ++H){
+            const Vec & phi1(event_model(H)->pi0());
+            const double *ratio_H = ratio.data() + encode_state(H,0);
+            double total = 0;
+            for(int h=0; h<S1_; ++h) total += phi1[h] * ratio_H[h];
+            wsp_[H] = total;
+          }
+          const Mat & Phi2(session_model()->Q());
+          for(int H1=0; H1<S2_; ++H1){
+            const double *prev_H = prev + encode_state(H1,0);
+            double margin = 0;
+            for(int h=0; h<S1_; ++h) margin += prev_H[h];
+            double backward = 0;
+            for(int H2=0; H2<S2_; ++H2){
+              double q = Phi2(H1,H2) * wsp_[H2];
+              Htrans(H1,H2) = margin * q;
+              backward += q;
+            }
+            for(int h=0; h<S1_; ++h){
+              pi_[encode_state(H1,h)] = prev_H[h] * backward;
+            }
+          }
+          session_model()->suf()->add_transition_distribution(Htrans);
         }else{       // normal case.. not a first event.  record h transition
           for(int H=0; H<S2_; ++H){
-            htrans = get_htrans(P[event_num], H);
+            const Mat & Phi1(event_model(H)->Q());
+            const double *prev_H = prev + encode_state(H,0);
+            const double *ratio_H = ratio.data() + encode_state(H,0);
+            for(int h0=0; h0<S1_; ++h0){
+              double total = 0;
+              for(int h1=0; h1<S1_; ++h1){
+                double p = prev_H[h0] * Phi1(h0,h1) * ratio_H[h1];
+                htrans(h0,h1) = p;
+                total += p;
+              }
+              pi_[encode_state(H,h0)] = total;
+            }
             event_model(H)->suf()->add_transition_distribution(htrans);
           }
         }
-
-        if(i>1 || j>1)
-          bkwd_1(pi_, P[event_num], wsp, one_);  // sets pi_ for next iteration
       }  // ends loop over events in a session
     }  // ends loop over sessions
   }   // closes function
 
-  //----------------------------------------------------------------------
-  ConstVectorView NestedHmm::get_hinit(const Vec &pi, int H)const{
-    ConstVectorView ans(pi.data() + H*S1_, S1_, pi.stride());
-    return ans;
-  }
   //----------------------------------------------------------------------
   Vec NestedHmm::get_Hinit(const Vec &pi)const{
     Vec ans(S2_);
-    for(int H=0; H<S2_; ++H) ans[H] = get_hinit(pi, H).sum();
-    return ans;
-  }
-  //----------------------------------------------------------------------
-  ConstSubMatrix NestedHmm::get_block(const Mat &P, int H1, int H2)const{
-    ConstSubMatrix ans(P, H1*S1_, (H1+1)*S1_-1, H2*S1_, (H2+1)*S1_ - 1);
-    return ans;
-  }
-  //----------------------------------------------------------------------
-  ConstSubMatrix NestedHmm::get_htrans(const Mat &P, int H)const{
-    return get_block(P,H,H);
-  }
-  //----------------------------------------------------------------------
-  Mat NestedHmm::get_Htrans(const Mat &P)const{
-    Mat ans(S2_,S2_);
-    for(int H1 = 0; H1<S2_; ++H1){
-      for(int H2 = 0; H2<S2_; ++H2){
-        ans(H1,H2) = get_block(P,H1,H2).sum();
-      }
+    for(int H=0; H<S2_; ++H){
+      ans[H] = ConstVectorView(pi.data() + encode_state(H,0), S1_, 1).sum();
     }
     return ans;
   }
@@ -326,7 +395,6 @@ namespace BOOM {
 #endif
     clear_client_data();
     int N = Nstreams();
-    fill_big_Q();
     double loglike=0;
 
     for(int i=0; i<N; ++i){
@@ -434,6 +502,7 @@ namespace BOOM {
     // be sure to grab the terminal state before you start the loop,
     // for singleton observations
 
+    int S = S1_ * S2_;
     int Hnow, hnow;
     int s = rmulti_mt(rng(), pi_);  // kosher, because pi_ was set by fwd()
     decode_state(s, Hnow, hnow);
@@ -457,10 +526,29 @@ namespace BOOM {
 
         --event_num;
         if(event_num>0){
+          // p(s[t-1] | s[t], y) is proportional to filtered[t-1](s[t-1])
+          // * Q(s[t-1], s[t]).  Within a session only the Hnow block
+          // can be nonzero.  Between sessions Q(s[t-1], s[t]) is
+          // proportional to Phi2(H[t-1], Hnow).
           assert(i>1 || j>1);
-          pi_ = P[event_num].col(s);       // P = joint dist. of yesterday,today
-          int r = rmulti_mt(rng(), pi_);  // pi_  = dist. of yesterday's event
-          decode_state(r, Hthen, hthen);
+          const double *prev = filtered_.data() + (event_num - 1) * S;
+          if(j>1){
+            const Mat & Phi1(event_model(Hnow)->Q());
+            const double *prev_H = prev + encode_state(Hnow,0);
+            VectorView weights(pi_, 0, S1_);
+            for(int h=0; h<S1_; ++h) weights[h] = prev_H[h] * Phi1(h,hnow);
+            Hthen = Hnow;
+            hthen = rmulti_mt(rng(), weights);
+          }else{
+            const Mat & Phi2(session_model()->Q());
+            for(int H=0; H<S2_; ++H){
+              const double *prev_H = prev + encode_state(H,0);
+              double q = Phi2(H,Hnow);
+              for(int h=0; h<S1_; ++h) pi_[encode_state(H,h)] = prev_H[h] * q;
+            }
+            int r = rmulti_mt(rng(), pi_);
+            decode_state(r, Hthen, hthen);
+          }
         }
 
         if (j==1) {     // start of a new session
@@ -499,7 +587,6 @@ namespace BOOM {
 #endif
     clear_client_data();
     double ans=0;
-    fill_big_Q();
     for(int i=0; i<Nstreams(); ++i){
       Ptr<Stream> u(stream(i));
       ans += fwd(u);
@@ -522,18 +609,6 @@ namespace BOOM {
   }
 #endif
   //----------------------------------------------------------------------
-  struct ClickstreamSamplingImputer{
-    Ptr<NestedHmm> mod;
-    ClickstreamSamplingImputer(Ptr<NestedHmm> m) : mod(m){}
-    void operator()(){ mod->impute_latent_data();}
-  };
-  //----------------------------------------------------------------------
-  struct ClickstreamEmImputer{
-    ClickstreamEmImputer(Ptr<NestedHmm> m) : mod(m) {}
-    Ptr<NestedHmm> mod;
-    void operator()(){ mod->fwd_bkwd(false, false); }
-  };
-  //----------------------------------------------------------------------
 #ifdef NO_BOOST_THREADS
   void NestedHmm::set_threads(int n) {
     // nothing needed.
@@ -541,11 +616,16 @@ namespace BOOM {
 #else
   void NestedHmm::set_threads(int n){
     clear_workers();
+    // Each worker draws from its own stream of random numbers, so the
+    // workers never share GlobalRng::rng or each other's draws.
+    unsigned long seed = seed_rng();
     for(int i=0; i<n; ++i){
       NEW(NestedHmm, worker)(S2_, S1_, S0_);
+      worker->rng() = rng_stream(seed, i);
       add_worker(worker);
     }
     allocate_data_to_workers();
+    if(n > 0) thread_pool_.set_number_of_threads(n);
   }
   //----------------------------------------------------------------------
   void NestedHmm::pass_params_to_workers(){
@@ -553,13 +633,21 @@ namespace BOOM {
     for(int i=0; i<workers_.size(); ++i) workers_[i]->unvectorize_params(v);
   }
   //----------------------------------------------------------------------
+  // The streams are divided among the workers when the workers are
+  // created, so each worker is one task.
   void NestedHmm::start_thread_imputation(){
-    boost::thread_group tg;
-    for(int i = 0; i<workers_.size(); ++i){
-      ClickstreamSamplingImputer imp(workers_[i]);
-      tg.add_thread(new boost::thread(imp));
-    }
-    tg.join_all();
+    thread_pool_.parallel_for(
+        workers_.size(),
+        boost::bind(&NestedHmm::run_worker_imputation, this, _1));
+  }
+  //----------------------------------------------------------------------
+  void NestedHmm::run_worker_imputation(int i){
+    ThreadRngScope rng_scope(workers_[i]->rng());
+    workers_[i]->impute_latent_data();
+  }
+  //----------------------------------------------------------------------
+  void NestedHmm::run_worker_em(int i){
+    workers_[i]->fwd_bkwd(false, false);
   }
   //----------------------------------------------------------------------
   void NestedHmm::add_worker(Ptr<NestedHmm> w){ workers_.push_back(w); }
@@ -575,12 +663,8 @@ namespace BOOM {
   }
   //----------------------------------------------------------------------
   void NestedHmm::start_thread_em(){
-    boost::thread_group tg;
-    for(int i = 0; i<workers_.size(); ++i){
-      ClickstreamEmImputer imp(workers_[i]);
-      tg.add_thread(new boost::thread(imp));
-    }
-    tg.join_all();
+    thread_pool_.parallel_for(
+        workers_.size(), boost::bind(&NestedHmm::run_worker_em, this, _1));
   }
   //----------------------------------------------------------------------
   double NestedHmm::collect_threads(){
@@ -652,7 +736,11 @@ namespace BOOM {
   }
   //----------------------------------------------------------------------
   void NestedHmm::check_filter_size(int nevents)const{
-    if(P.size()<nevents) P.resize(nevents);
+    int size = nevents * S1_ * S2_;
+    if(filtered_.size() < size){
+      filtered_.resize(size);
+      predicted_.resize(size);
+    }
   }
   //----------------------------------------------------------------------
   void NestedHmm::fill_logd(Ptr<Event> dp)const{
@@ -666,71 +754,6 @@ namespace BOOM {
     return mix(H,h)->pdf(*event, true);
   }
   //----------------------------------------------------------------------
-  void NestedHmm::fill_big_Q()const{
-    // fills logpi0_ (for first event ever)
-    //       logQ1_  (for transitions to the first event in a new session)
-    //       logQ2_  (for transitions within a session)
-
-    // pi0_ looks like:     phi2[1] * vector( phi1[H=1] )
-    //                      phi2[2] * vector( phi1[H=2] )
-    //                                ...
-
-    // Q1 and Q2 have block structure.  Each block refers to an H transition,
-    // Let stack(vector) be a square matrix where each row is a copy of 'vector'
-
-    //Q1 looks like
-    //        Phi2[1,1] * stack(phi1[H=1]), Phi2[1,2] * stack(phi1[H=2]), ...
-    //        Phi2[2,1] * stack(phi1[H=1]), Phi2[2,2] * stack(phi1[H=2]), ...
-    //                           ...                      ...
-
-    // Q2 is a block diagonal matrix where block s = Phi1[H=s]
-
-    int S = S1_ * S2_;
-
-    if(logpi0_.size()!=S) logpi0_.resize(S);
-    if(logd_.size()!=S) logd_.resize(S);
-
-    if(logQ1_.nrow()!=S || logQ1_.ncol()!=S) logQ1_.resize(S,S);
-    logQ1_ = 0;
-
-    if(logQ2_.nrow()!=S || logQ2_.ncol()!=S) logQ2_.resize(S,S);
-    logQ2_ = 0;
-
-
-    int i=0;
-    const Vec & phi2(session_model()->pi0());
-    std::vector<Mat> stacked_phi1(S2_);
-    for(int H=0; H<S2_; ++H){
-      const Vec & pi0(event_model(H)->pi0());
-      Mat Pi0(S1_, S1_);
-      for(int h=0; h<S1_; ++h) Pi0.row(h) = pi0;
-      stacked_phi1[H] = Pi0;
-    }
-
-    const Mat & Phi2(session_model_->Q());
-
-    for(int H = 0; H<S2_; ++H){
-
-      VectorView pi_H(logpi0_, i, S1_);
-      pi_H = phi2[H] * event_model(H)->pi0();
-
-      SubMatrix Q2(logQ2_, i, i+S1_ - 1, i, i+S1_-1);
-      Q2 = event_model(H)->Q();
-
-      int j=0;
-      for(int HH=0; HH<S2_; ++HH){
-        SubMatrix Q1(logQ1_, i, i+S1_ - 1, j, j+S1_-1);
-        Q1 = Phi2(H,HH) * stacked_phi1[HH];  // scalar times matrix
-        j+= S1_;
-      }
-      i+= S1_;
-    }
-
-    logQ1_ = log(logQ1_);
-    logQ2_ = log(logQ2_);
-    logpi0_ = log(logpi0_);
-  }
-  //----------------------------------------------------------------------
   std::vector<Ptr<Sufstat> > NestedHmm::suf_vec()const{
     std::vector<Ptr<Sufstat> > ans;
     ans.push_back(session_model()->suf());
@@ -10,6 +10,7 @@
 #include <Models/PosteriorSamplers/MarkovConjSampler.hpp>
 #include <Models/PosteriorSamplers/MarkovConjShrinkageSampler.hpp>
 #include <distributions/rng.hpp>
+#include <cpputil/ThreadPool.hpp>
 
 #include "Stream.hpp"
 
@@ -126,31 +127,49 @@ namespace BOOM {
     Ptr<UnivParams> loglike_;
     Ptr<UnivParams> logpost_;
 
-    // stuff for the filter
-    mutable std::vector<Mat> P;
-    mutable  Vec pi_;
-    mutable  Vec logpi0_;
-    mutable  Vec logd_;
-    const Vec one_;       // A vector of 1's
-    mutable  Mat logQ1_;  // for the first obs in a session
-    mutable  Mat logQ2_;  // for the subsequent observations
+    // Storage for the forward filter.  The hidden state (H, h) is
+    // stored at position encode_state(H, h), so each session type H
+    // owns a contiguous block of S1_ elements.  For event t in the
+    // stream being filtered, filtered_[t*S .. (t+1)*S) is p(state |
+    // events 0..t) and predicted_[t*S .. (t+1)*S) is p(state | events
+    // 0..t-1), where S = S1_ * S2_.
+    mutable Vec filtered_;
+    mutable Vec predicted_;
+    mutable Vec pi_;      // Smoothed distribution, or sampling weights.
+    mutable Vec logd_;
+    mutable Vec wsp_;     // Work space of dimension S2_.
+    mutable Vec wsp2_;    // Work space of dimension S2_.
 
     RNG rng_;
 
     std::vector<Ptr<NestedHmm> > workers_;
+    ThreadPool thread_pool_;
     void setup();
     void pass_params_to_workers();
     void fill_logd(Ptr<Event>)const;
-    void fill_big_Q()const;
+    // The prediction steps of the forward filter.  'prev' is the
+    // filtered distribution for the previous event, and 'pred' is
+    // filled with the distribution of the next event's state.  The
+    // transition matrix over (H, h) is never formed.  Within a session
+    // it is block diagonal with blocks Phi1[H], which costs
+    // S2*S1^2.  Between sessions each block row is a multiple of
+    // phi1[H], so only the S2 session marginals are needed, which
+    // costs S2^2 + S2*S1.
+    void predict_within_session(const double *prev, double *pred)const;
+    void predict_new_session(const double *prev, double *pred)const;
+    // Filters event number t (counting across sessions) of the stream
+    // being processed.  Returns log p(event t | events 0..t-1).
+    double fwd_step(Ptr<Event> event, int t, bool first_in_session)const;
+    // Fills wsp_ with the session marginals of the S-vector 'pi', and
+    // wsp2_ with their one step predictions through Phi2.
+    void fill_session_margins(const double *pi)const;
     void start_thread_imputation();
     void start_thread_em();
-    double initialize(Ptr<Event>)const;
+    // Tasks for thread_pool_.  Each runs on workers_[i].
+    void run_worker_imputation(int i);
+    void run_worker_em(int i);
     void check_filter_size(int n)const;
-    ConstVectorView get_hinit(const Vec &pi, int H)const;
     Vec get_Hinit(const Vec &pi)const;
-    ConstSubMatrix get_htrans(const Mat &P, int H)const;
-    ConstSubMatrix get_block(const Mat &P, int H1, int H2)const;
-    Mat get_Htrans(const Mat &P)const;
     double fwd_bkwd_with_threads(bool bayes=false, bool find_mode=true);
     double impute_latent_data_with_threads();
 
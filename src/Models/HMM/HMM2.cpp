@@ -31,10 +31,7 @@
 #include <stdexcept>
 #include <cmath>
 
-#ifndef NO_BOOST_THREADS
-#include <boost/thread.hpp>
-#include <boost/ref.hpp>
-#endif
+#include <boost/bind.hpp>
 
 namespace BOOM{
 
@@ -82,11 +79,12 @@ namespace BOOM{
     clear_client_data();
     uint S = state_space_size();
     Vec prob(S, 1.0/S);
+    RNG &rng(default_rng());
     for(uint s=0; s<nseries(); ++s){
       const DataSeriesType & ts(dat(s));
       uint n = ts.size();
       for(uint i=0; i<n; ++i){
-        uint h = rmulti(prob);
+        uint h = rmulti_mt(rng, prob);
         mix_[h]->add_data(ts[i]);}}
   }
 
@@ -321,39 +319,44 @@ namespace BOOM{
   void HMM::set_nthreads(uint n){
 #ifndef NO_BOOST_THREADS
     workers_.clear();
-    for(uint i=0; i<n; ++i){
-      NEW(HmmDataImputer, imp)(this, i, n);
+    if(n == 0) return;
+    int shards = number_of_shards(n);
+    unsigned long seed = seed_rng();
+    for(int i=0; i<shards; ++i){
+      NEW(HmmDataImputer, imp)(this, rng_stream(seed, i));
       workers_.push_back(imp);}
+    thread_pool_.set_number_of_threads(n);
 #endif
 }
 
-  uint HMM::nthreads()const{ return workers_.size();}
+  uint HMM::nthreads()const{
+    return workers_.empty() ? 0 : thread_pool_.number_of_threads();
+  }
 
 #ifndef NO_BOOST_THREADS
+  // The series are dealt out to a fixed set of shards.  Each shard has
+  // its own imputer, with its own RNG and complete data sufficient
+  // statistics, so the draws do not depend on which thread runs which
+  // shard.  The shards are combined in order at the end.
   double HMM::impute_latent_data_with_threads(){
-    try{
-      clear_client_data();
+    clear_client_data();
+    for(uint i = 0; i<workers_.size(); ++i) workers_[i]->setup(this);
+    thread_pool_.parallel_for(
+        workers_.size(), boost::bind(&HMM::impute_shard, this, _1));
+    uint S = state_space_size();
+    double loglike=0;
+    for(uint i=0; i<workers_.size(); ++i){
+      loglike += workers_[i]->loglike();
+      mark_->combine_data(*workers_[i]->mark(), true);
+      for(uint s=0; s<S; ++s) mix_[s]->combine_data(*workers_[i]->models(s), true);
+    }
+    return loglike;
+  }
 
-      boost::thread_group tg;
-      for(uint i = 0; i<nthreads(); ++i){
-        workers_[i]->setup(this);
-        tg.add_thread(new boost::thread(boost::ref(*workers_[i])));
-      }
-      tg.join_all();
-      uint S = state_space_size();
-      double loglike=0;
-      for(uint i=0; i<nthreads(); ++i){
-        loglike += workers_[i]->loglike();
-        mark_->combine_data(*workers_[i]->mark(), true);
-        for(uint s=0; s<S; ++s) mix_[s]->combine_data(*workers_[i]->models(s), true);
-      }
-      return loglike;
-    }catch(const std::exception &e){
-      throw_exception<std::runtime_error>(e.what());
-    }catch(...){
-      throw_exception<std::runtime_error>("HMM caught unknown exception from boost::threads");
+  void HMM::impute_shard(int shard){
+    for(uint series = shard; series < nseries(); series += workers_.size()){
+      workers_[shard]->impute_series(dat(series));
     }
-    return 0;
   }
 #endif
 
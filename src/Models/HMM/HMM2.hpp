@@ -25,6 +25,7 @@
 #include <Models/TimeSeries/TimeSeriesDataPolicy.hpp>
 #include <Models/Policies/PriorPolicy.hpp>
 #include <Models/DataTypes.hpp>
+#include <cpputil/ThreadPool.hpp>
 
 namespace BOOM{
 
@@ -108,8 +109,12 @@ class HiddenMarkovModel :
   Ptr<UnivParams> loglike_;
   Ptr<UnivParams> logpost_;
   std::vector<Ptr<HmmDataImputer> > workers_;
+  ThreadPool thread_pool_;
 
   double impute_latent_data_with_threads();
+  // Runs the forward-backward sampler on the series in one shard,
+  // accumulating the results in workers_[shard].
+  void impute_shard(int shard);
 };
 //----------------------------------------------------------------------
 
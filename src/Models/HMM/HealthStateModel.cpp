@@ -159,12 +159,13 @@ namespace BOOM{
   void HealthStateModel::bkwd(const TimeSeries<HealthStateData> &series){
     int n = series.length();
     int S = state_space_size();
-    uint s = rmulti(pi_);
+    RNG &rng(default_rng());
+    uint s = rmulti_mt(rng, pi_);
     mix_[s]->add_data(series.back()->shared_value());
 
     for(int i = n-1; i > 0; --i){
       pi_ = P_[i].col(s);
-      uint r = rmulti(pi_);
+      uint r = rmulti_mt(rng, pi_);
       mix_[r]->add_data(series[i-1]->shared_value());
       uint which_treatment = sample_treatment(series[i], r, s);
       mark_[which_treatment]->suf()->add_transition(r,s);
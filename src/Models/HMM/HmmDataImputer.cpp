@@ -6,19 +6,11 @@
 namespace BOOM{
 typedef HmmDataImputer HDI;
 
-inline unsigned long getseed(){
-  double u = runif() * std::numeric_limits<unsigned long>::max();
-  unsigned long ans(lround(u));
-  return ans;
-}
-
-HDI::HmmDataImputer(HiddenMarkovModel * hmm, uint id, uint nworkers)
-    : id_(id),
-      nworkers_(nworkers),
-      mark_(new MarkovModel(hmm->state_space_size())),
-      eng(getseed())
+HDI::HmmDataImputer(HiddenMarkovModel * hmm, const RNG &rng)
+    : mark_(new MarkovModel(hmm->state_space_size())),
+      loglike_(0),
+      eng(rng)
 {
-  eng.seed();
   uint S = hmm->state_space_size();
   for(uint s=0; s<S; ++s){
     Ptr<MixtureComponent> m(hmm->mixture_component(s)->clone());
@@ -27,16 +19,14 @@ HDI::HmmDataImputer(HiddenMarkovModel * hmm, uint id, uint nworkers)
   filter_ = new HmmFilter(mix_,mark_);
 }
 //----------------------------------------------------------------------
-void HDI::operator()(){
-  clear_client_data();
-  uint ns = dat_.size();
-  loglike_ = 0;
-  for(uint i= 0; i<ns; ++i){
-    const std::vector<Ptr<Data> > &ts(*dat_[i]);
-    loglike_ += filter_->fwd(ts);
-    filter_->bkwd_sampling_mt(ts, eng);
-  }
+void HDI::impute_series(const TimeSeries<Data> &ts){
+  // Any random numbers drawn without an explicit RNG while this
+  // worker runs come from eng, rather than the shared GlobalRng.
+  ThreadRngScope rng_scope(eng);
+  loglike_ += filter_->fwd(ts);
+  filter_->bkwd_sampling_mt(ts, eng);
 }
+
 double HDI::loglike()const{return loglike_;}
 
 //----------------------------------------------------------------------
@@ -54,13 +44,7 @@ void HDI::clear_client_data(){
 
 void HDI::setup(HiddenMarkovModel *hmm){
   clear_client_data();
-  uint ns = hmm->nseries();
-  dat_.clear();
-  dat_.reserve(1 + ns/nworkers_);
-  for(uint i=id_; i<ns; i+= nworkers_){
-    TimeSeries<Data> * ts = &(hmm->dat(i));
-    dat_.push_back(ts);
-  }
+  loglike_ = 0;
 
   Vec theta = hmm->mark()->vectorize_params();
   mark_->unvectorize_params(theta);
@@ -29,8 +29,13 @@ class HmmDataImputer
 {
   // HmmDataImputer
  public:
-  HmmDataImputer(HiddenMarkovModel *hmm, uint id, uint nworkers);
-  void operator()();
+  // The imputer draws its random numbers from 'rng'.
+  HmmDataImputer(HiddenMarkovModel *hmm, const RNG &rng);
+
+  // Runs the forward-backward sampler on a single series, adding its
+  // complete data to this worker's models and its log likelihood to
+  // loglike().  Call setup() first to clear the previous results.
+  void impute_series(const TimeSeries<Data> &ts);
 
   Ptr<MarkovModel> mark();
   Ptr<MixtureComponent> models(uint s);
@@ -41,16 +46,12 @@ class HmmDataImputer
 
   friend void intrusive_ptr_add_ref(HmmDataImputer *d){d->up_count();}
   friend void intrusive_ptr_release(HmmDataImputer *d){
-    d->down_count(); if(d->ref_count()==0) delete d;}
+    if(d->down_count()==0) delete d;}
  private:
-  HiddenMarkovModel *hmm_;
-  uint id_;
-  uint nworkers_;
   Ptr<MarkovModel> mark_;
   std::vector<Ptr<MixtureComponent> > mix_;
   Ptr<HmmFilter> filter_;
   double loglike_;
-  std::vector<TimeSeries<Data> * > dat_;
 
   RNG eng;
 };
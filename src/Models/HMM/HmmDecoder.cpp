@@ -0,0 +1,304 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <Models/HMM/HmmDecoder.hpp>
+#include <Models/HMM/HMM2.hpp>
+#include <cpputil/math_utils.hpp>
+#include <cpputil/report_error.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace BOOM{
+
+  typedef HmmDecoder HD;
+
+  namespace {
+    double safe_log(double x){
+      return x > 0 ? log(x) : negative_infinity();
+    }
+  }  // namespace
+
+  HD::HmmDecoder(const std::vector<Ptr<MixtureComponent> > &mix,
+                 const Vec &initial_distribution,
+                 const Mat &transition_probabilities)
+      : mix_(mix)
+  {
+    setup(initial_distribution, transition_probabilities);
+  }
+
+  HD::HmmDecoder(HiddenMarkovModel &model)
+      : mix_(model.mixture_components())
+  {
+    setup(model.pi0(), model.Q());
+  }
+
+  void HD::setup(const Vec &pi0, const Mat &Q){
+    int S = mix_.size();
+    if(pi0.size() != S || Q.nrow() != S || Q.ncol() != S){
+      report_error("The initial distribution and transition matrix passed "
+                   "to HmmDecoder do not match the number of mixture "
+                   "components.");
+    }
+    pi0_ = pi0;
+    Q_ = Q;
+    log_pi0_.resize(S);
+    for(int s = 0; s < S; ++s) log_pi0_[s] = safe_log(pi0_[s]);
+    log_Q_ = Mat(S, S);
+    for(int s = 0; s < S; ++s){
+      for(int r = 0; r < S; ++r) log_Q_(r, s) = safe_log(Q_(r, s));
+    }
+    workspaces_.resize(1);
+  }
+
+  void HD::set_number_of_threads(int number_of_threads){
+    pool_.set_number_of_threads(number_of_threads);
+    workspaces_.resize(number_of_threads);
+  }
+
+  //----------------------------------------------------------------------
+  double HD::fill_logd(const Data *dp, Vec &logd)const{
+    int S = mix_.size();
+    if(logd.size() != S) logd.resize(S);
+    if(dp->missing()){
+      logd = 0;
+      return 0;
+    }
+    double ans = negative_infinity();
+    for(int s = 0; s < S; ++s){
+      logd[s] = mix_[s]->pdf(dp, true);
+      ans = std::max(ans, logd[s]);
+    }
+    return ans;
+  }
+
+  double HD::filter_step(Vec &state, const Vec &logd, double max_logd,
+                         Vec &predicted, bool first, const Data *dp)const{
+    int S = mix_.size();
+    if(predicted.size() != S) predicted.resize(S);
+    if(first){
+      predicted = pi0_;
+    }else{
+      const double *Q = Q_.data();
+      for(int s = 0; s < S; ++s){
+        const double *column = Q + s * S;
+        double prediction = 0;
+        for(int r = 0; r < S; ++r) prediction += state[r] * column[r];
+        predicted[s] = prediction;
+      }
+    }
+    if(state.size() != S) state.resize(S);
+    double total = 0;
+    for(int s = 0; s < S; ++s){
+      state[s] = predicted[s] * exp(logd[s] - max_logd);
+      total += state[s];
+    }
+    if(!(total > 0) || max_logd == negative_infinity()){
+      std::ostringstream err;
+      err << "HmmDecoder found a data point with probability zero under "
+          << "every reachable state:" << endl << *dp << endl;
+      report_error(err.str());
+    }
+    state /= total;
+    return max_logd + log(total);
+  }
+
+  //----------------------------------------------------------------------
+  double HD::viterbi(const DataSeries &series, std::vector<int> &path){
+    return viterbi(series, path, workspaces_[0]);
+  }
+
+  double HD::viterbi(const DataSeries &series, std::vector<int> &path,
+                     Workspace &ws)const{
+    int n = series.size();
+    int S = mix_.size();
+    path.resize(n);
+    if(n == 0) return 0;
+    if(ws.delta.size() != S){
+      ws.delta.resize(S);
+      ws.next_delta.resize(S);
+    }
+    if(ws.backpointers.size() < n * S) ws.backpointers.resize(n * S);
+
+    // delta[s] is the log density of the best path ending in state s.
+    fill_logd(series[0].get(), ws.logd);
+    for(int s = 0; s < S; ++s) ws.delta[s] = log_pi0_[s] + ws.logd[s];
+    const double *log_Q = log_Q_.data();
+    for(int t = 1; t < n; ++t){
+      fill_logd(series[t].get(), ws.logd);
+      int *back = &ws.backpointers[t * S];
+      for(int s = 0; s < S; ++s){
+        const double *column = log_Q + s * S;
+        int best = 0;
+        double best_value = ws.delta[0] + column[0];
+        for(int r = 1; r < S; ++r){
+          double value = ws.delta[r] + column[r];
+          if(value > best_value){
+            best_value = value;
+            best = r;
+          }
+        }
+        back[s] = best;
+        ws.next_delta[s] = best_value + ws.logd[s];
+      }
+      ws.delta.swap(ws.next_delta);
+    }
+
+    int state = std::max_element(ws.delta.begin(), ws.delta.end())
+        - ws.delta.begin();
+    double ans = ws.delta[state];
+    if(ans == negative_infinity()){
+      report_error("HmmDecoder::viterbi found no state path with positive "
+                   "probability.");
+    }
+    path[n - 1] = state;
+    for(int t = n - 1; t > 0; --t){
+      state = ws.backpointers[t * S + state];
+      path[t - 1] = state;
+    }
+    return ans;
+  }
+
+  //----------------------------------------------------------------------
+  double HD::posterior_decoding(const DataSeries &series, Mat &state_probs){
+    return posterior_decoding(series, state_probs, workspaces_[0]);
+  }
+
+  double HD::posterior_decoding(const DataSeries &series, Mat &state_probs,
+                                Workspace &ws)const{
+    int n = series.size();
+    int S = mix_.size();
+    if(state_probs.nrow() != n || state_probs.ncol() != S){
+      state_probs = Mat(n, S);
+    }
+    if(n == 0) return 0;
+    if(ws.alpha.size() < n * S){
+      ws.alpha.resize(n * S);
+      ws.density.resize(n * S);
+    }
+    if(ws.scale.size() < n) ws.scale.resize(n);
+
+    // Forward pass.  alpha[t] is p(h[t] | y[0..t]), density[t] is
+    // p(y[t] | h[t]) / exp(max logd[t]), and scale[t] is the
+    // normalizing constant p(y[t] | y[0..t-1]) / exp(max logd[t]).
+    Vec &state(ws.delta);
+    double loglike = 0;
+    for(int t = 0; t < n; ++t){
+      double max_logd = fill_logd(series[t].get(), ws.logd);
+      double log_increment = filter_step(state, ws.logd, max_logd,
+                                         ws.predicted, t == 0,
+                                         series[t].get());
+      loglike += log_increment;
+      ws.scale[t] = exp(log_increment - max_logd);
+      double *alpha = &ws.alpha[t * S];
+      double *density = &ws.density[t * S];
+      for(int s = 0; s < S; ++s){
+        alpha[s] = state[s];
+        density[s] = exp(ws.logd[s] - max_logd);
+      }
+    }
+
+    // Backward pass, with beta[t] = p(y[t+1..n-1] | h[t]) scaled by the
+    // same constants as alpha, so that alpha[t] .* beta[t] is the
+    // smoothed distribution.
+    ws.beta.resize(S);
+    ws.weight.resize(S);
+    ws.beta = 1.0;
+    const double *Q = Q_.data();
+    for(int t = n - 1; t >= 0; --t){
+      const double *alpha = &ws.alpha[t * S];
+      double total = 0;
+      for(int s = 0; s < S; ++s){
+        state_probs(t, s) = alpha[s] * ws.beta[s];
+        total += state_probs(t, s);
+      }
+      for(int s = 0; s < S; ++s) state_probs(t, s) /= total;
+      if(t == 0) break;
+      // beta[t-1] = Q * (density[t] .* beta[t]) / scale[t]
+      const double *density = &ws.density[t * S];
+      for(int s = 0; s < S; ++s){
+        ws.weight[s] = density[s] * ws.beta[s] / ws.scale[t];
+      }
+      ws.beta = 0.0;
+      for(int s = 0; s < S; ++s){
+        const double *column = Q + s * S;
+        double w = ws.weight[s];
+        if(w == 0) continue;
+        for(int r = 0; r < S; ++r) ws.beta[r] += column[r] * w;
+      }
+    }
+    return loglike;
+  }
+
+  //----------------------------------------------------------------------
+  void HD::viterbi(const std::vector<Ptr<TimeSeries<Data> > > &series,
+                   std::vector<std::vector<int> > &paths){
+    paths.resize(series.size());
+    pool_.parallel_for(series.size(),
+                       boost::bind(&HD::viterbi_task, this, _1, _2,
+                                   &series, &paths));
+  }
+
+  void HD::posterior_decoding(
+      const std::vector<Ptr<TimeSeries<Data> > > &series,
+      std::vector<Mat> &state_probs){
+    state_probs.resize(series.size());
+    pool_.parallel_for(series.size(),
+                       boost::bind(&HD::posterior_task, this, _1, _2,
+                                   &series, &state_probs));
+  }
+
+  void HD::viterbi_task(int i, int worker,
+                        const std::vector<Ptr<TimeSeries<Data> > > *series,
+                        std::vector<std::vector<int> > *paths){
+    viterbi(*(*series)[i], (*paths)[i], workspaces_[worker]);
+  }
+
+  void HD::posterior_task(int i, int worker,
+                          const std::vector<Ptr<TimeSeries<Data> > > *series,
+                          std::vector<Mat> *state_probs){
+    posterior_decoding(*(*series)[i], (*state_probs)[i],
+                       workspaces_[worker]);
+  }
+
+  //======================================================================
+  HD::Stream::Stream(const HmmDecoder &decoder)
+      : decoder_(decoder),
+        filtered_(decoder.state_space_size(), 0.0),
+        logd_(decoder.state_space_size()),
+        predicted_(decoder.state_space_size()),
+        loglike_(0),
+        number_of_observations_(0)
+  {}
+
+  void HD::Stream::reset(){
+    filtered_ = 0.0;
+    loglike_ = 0;
+    number_of_observations_ = 0;
+  }
+
+  const Vec &HD::Stream::observe(const Data *dp){
+    double max_logd = decoder_.fill_logd(dp, logd_);
+    loglike_ += decoder_.filter_step(filtered_, logd_, max_logd, predicted_,
+                                     number_of_observations_ == 0, dp);
+    ++number_of_observations_;
+    return filtered_;
+  }
+
+}
@@ -0,0 +1,159 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_HMM_DECODER_HPP_
+#define BOOM_HMM_DECODER_HPP_
+
+#include <LinAlg/Types.hpp>
+#include <LinAlg/Matrix.hpp>
+#include <Models/ModelTypes.hpp>
+#include <Models/TimeSeries/TimeSeries.hpp>
+#include <cpputil/ThreadPool.hpp>
+#include <vector>
+
+namespace BOOM{
+
+  class HiddenMarkovModel;
+
+  // Decodes the hidden states of new series under fixed HMM
+  // parameters, e.g. to score sessions with a model fit earlier.  The
+  // decoder copies the initial distribution and transition matrix
+  // when it is built (along with their logs), and evaluates the
+  // mixture components' densities as data arrive.  Later changes to
+  // the model's Markov chain are not seen by the decoder.  Changes to
+  // the mixture components are.
+  //
+  // Working storage is kept in the decoder (one set per thread for
+  // the batch methods) and reused, so decoding a series allocates
+  // nothing once the buffers are as long as the longest series.
+  //
+  // The batch methods decode series in parallel on a ThreadPool.  The
+  // mixture components' pdf() methods must then be safe to call from
+  // several threads at once.
+  class HmmDecoder{
+   public:
+    typedef std::vector<Ptr<Data> > DataSeries;
+
+    HmmDecoder(const std::vector<Ptr<MixtureComponent> > &mixture_components,
+               const Vec &initial_distribution,
+               const Mat &transition_probabilities);
+    // Uses the model's current parameters.
+    explicit HmmDecoder(HiddenMarkovModel &model);
+
+    int state_space_size()const{return mix_.size();}
+    void set_number_of_threads(int number_of_threads);
+
+    // Finds the most likely state path given 'series'.  The path is
+    // returned in 'path', which is resized to the series length.
+    // Returns the log of the joint density of the path and the data.
+    double viterbi(const DataSeries &series, std::vector<int> &path);
+
+    // Fills row t of 'state_probs' with p(h[t] | all of 'series'), and
+    // returns the log likelihood of 'series'.  'state_probs' is
+    // resized to series.size() x state_space_size() if needed.
+    double posterior_decoding(const DataSeries &series, Mat &state_probs);
+
+    // Batch versions of the above, run on the thread pool.  Element i
+    // of the output corresponds to series[i].
+    void viterbi(const std::vector<Ptr<TimeSeries<Data> > > &series,
+                 std::vector<std::vector<int> > &paths);
+    void posterior_decoding(
+        const std::vector<Ptr<TimeSeries<Data> > > &series,
+        std::vector<Mat> &state_probs);
+
+    // Filters one series an observation at a time, for scoring a
+    // session while it is in progress.  Each call to observe() returns
+    // p(h[t] | y[0..t]) for the newest observation.  A stream refers
+    // to its decoder, which must outlive it.
+    class Stream{
+     public:
+      explicit Stream(const HmmDecoder &decoder);
+      // Forgets the observations seen so far.
+      void reset();
+      const Vec &observe(const Data *dp);
+      const Vec &filtered_state_probabilities()const{return filtered_;}
+      // log p(y[0..t]) for the observations seen so far.
+      double loglike()const{return loglike_;}
+      int number_of_observations()const{return number_of_observations_;}
+     private:
+      const HmmDecoder &decoder_;
+      Vec filtered_;
+      Vec logd_;
+      Vec predicted_;
+      double loglike_;
+      int number_of_observations_;
+    };
+
+   private:
+    struct Workspace{
+      Vec logd;
+      Vec delta;
+      Vec next_delta;
+      Vec predicted;
+      std::vector<int> backpointers;
+      // Filtered probabilities, scaled densities exp(logd - max logd),
+      // and normalizing constants, for the backward pass.
+      Vec alpha;
+      Vec density;
+      Vec scale;
+      Vec beta;
+      Vec weight;
+    };
+
+    // Fills 'logd' with log p(dp | h = s) for each state s.  Missing
+    // data have logd = 0.  Returns the largest element.
+    double fill_logd(const Data *dp, Vec &logd)const;
+
+    // Replaces 'state' (filtered probabilities for the previous time
+    // point) with the filtered probabilities after observing the
+    // density vector 'logd' with maximum 'max_logd'.  Returns log p(y
+    // | past).  If 'first' is true then 'state' is ignored and the
+    // initial distribution is used.
+    double filter_step(Vec &state, const Vec &logd, double max_logd,
+                       Vec &predicted, bool first, const Data *dp)const;
+
+    double viterbi(const DataSeries &series, std::vector<int> &path,
+                   Workspace &workspace)const;
+    double posterior_decoding(const DataSeries &series, Mat &state_probs,
+                              Workspace &workspace)const;
+
+    void viterbi_task(int i, int worker,
+                      const std::vector<Ptr<TimeSeries<Data> > > *series,
+                      std::vector<std::vector<int> > *paths);
+    void posterior_task(int i, int worker,
+                        const std::vector<Ptr<TimeSeries<Data> > > *series,
+                        std::vector<Mat> *state_probs);
+
+    void setup(const Vec &initial_distribution,
+               const Mat &transition_probabilities);
+
+    std::vector<Ptr<MixtureComponent> > mix_;
+    Vec pi0_;
+    Vec log_pi0_;
+    // Matrices are stored by column, so Q(r, s) and log Q(r, s) for
+    // fixed s are contiguous in r, which is the order both the
+    // forward recursion and the Viterbi recursion visit them.
+    Mat Q_;
+    Mat log_Q_;
+
+    std::vector<Workspace> workspaces_;
+    ThreadPool pool_;
+  };
+
+}
+#endif// BOOM_HMM_DECODER_HPP_
@@ -18,130 +18,163 @@
 
 #include <Models/HMM/HmmFilter.hpp>
 #include <cpputil/math_utils.hpp>
-#include <Models/HMM/hmm_tools.hpp>
+#include <cpputil/lse.hpp>
 
 #include <Models/ModelTypes.hpp>
 #include <Models/EmMixtureComponent.hpp>
 #include <Models/MarkovModel.hpp>
 #include <distributions.hpp>
 #include <cpputil/report_error.hpp>
+#include <algorithm>
+#include <cmath>
 
 namespace BOOM{
 
-  void hmm_recursion_error(const Mat &p, const Vec &Marg, const Mat &Tmat,
-                           const Vec &Wsp, uint i, Ptr<Data>);
-  void hmm_recursion_error(const Mat &P, const Vec &marg, const Mat &tmat,
-                           const Vec &wsp, uint i, Ptr<Data> dp){
-    string str;
-    ostringstream s(str);
-    s << "error in HMM recursion at step "<< i<< ":" << endl;
-    s << "marg:" << endl << marg << endl;
-    s << "P: " << endl << P << endl;
-    s << "hmm.cpp:  Q = " << endl << tmat << endl;
-    s << "hmm.cpp: p(data|state) = " << wsp << endl;
-    s << "here is the observed data that caused the error: " << endl
-      << *dp << endl;
-    report_error(s.str());
-  }
-
   HmmFilter::HmmFilter(std::vector<Ptr<MixtureComponent> > mv,
                        Ptr<MarkovModel> mark)
       : models_(mv),
-      P(0),
       pi(mv.size()),
       logp(mv.size()),
-      logpi(mv.size()),
       one(mv.size(), 1.0),
-      logQ(mv.size(), mv.size()),
-      markov_(mark)
+      Q_(mv.size(), mv.size()),
+      predicted_(mv.size()),
+      markov_(mark),
+      use_checkpoints_(false),
+      interval_(1),
+      segment_start_(-1)
       {}
 
   uint HmmFilter::state_space_size()const{
     return models_.size();}
 
+  void HmmFilter::use_checkpoints(bool yes){
+    use_checkpoints_ = yes;}
+
   double HmmFilter::initialize(const Data * dp){
     uint S = state_space_size();
     pi = markov_->pi0();
     if(dp->missing()) logp = 0;
     else for(uint s=0; s<S; ++s) logp[s] = models_[s]->pdf(dp, true);
-    pi = log(pi) + logp;
-    double m = max(pi);
-    pi = exp(pi-m);
-    double nc = sum(pi);
-    double loglike = m + log(nc);
-    pi/=nc;
-    return loglike;
+    log_in_place(pi.data(), S);
+    pi += logp;
+    return softmax_in_place(pi.data(), S);
+  }
+
+  double HmmFilter::fwd_step(Vec &state, const Data *dp){
+    uint S = state_space_size();
+    if(dp->missing()) logp = 0;
+    else for(uint s=0; s<S; ++s) logp[s] = models_[s]->pdf(dp, true);
+    double max_logp = logp.max();
+    // Q is stored by column, so column s is contiguous.
+    const double *Q = Q_.data();
+    for(uint s=0; s<S; ++s){
+      const double *column = Q + s * S;
+      double prediction = 0;
+      for(uint r=0; r<S; ++r) prediction += state[r] * column[r];
+      predicted_[s] = prediction;
+    }
+    double total = 0;
+    for(uint s=0; s<S; ++s){
+      state[s] = predicted_[s] * exp(logp[s] - max_logp);
+      total += state[s];
+    }
+    if(!(total > 0) || max_logp == negative_infinity()){
+      // y[t] is impossible under every reachable state.  Returning
+      // -infinity lets callers such as Metropolis-Hastings samplers
+      // reject the parameters, as they do when initialize() fails.
+      state = predicted_;
+      return negative_infinity();
+    }
+    state /= total;
+    return max_logp + log(total);
   }
 
   double HmmFilter::fwd(const std::vector<Ptr<Data> > &dv){
-    logQ = log(markov_->Q() );
+    Q_ = markov_->Q();
     uint n = dv.size();
     uint S = state_space_size();
     if(logp.size()!=S) logp.resize(S);
-    if(P.size() < n) P.resize(n);
+    interval_ = 1;
+    if(use_checkpoints_) interval_ = std::max<uint>(1, ceil(sqrt(n)));
+    filtered_.resize(((n + interval_ - 1) / interval_) * S);
+    segment_start_ = -1;
     double loglike = initialize(dv[0].get());
+    std::copy(pi.begin(), pi.end(), filtered_.begin());
     for(uint i=1; i<n; ++i){
-      if(dv[i]->missing()) logp = 0;
-      else for(uint s=0; s<S; ++s) logp[s] = models_[s]->pdf(dv[i].get(), true);
-      loglike += fwd_1(pi, P[i], logQ, logp, one);
+      loglike += fwd_step(pi, dv[i].get());
+      if(i % interval_ == 0){
+        std::copy(pi.begin(), pi.end(),
+                  filtered_.begin() + (i / interval_) * S);
+      }
     }
     return loglike;
   }
   //------------------------------------------------------------
 
+  ConstVectorView HmmFilter::filtered(uint t,
+                                      const std::vector<Ptr<Data> > &dv){
+    uint S = state_space_size();
+    if(interval_ == 1) return ConstVectorView(filtered_.data() + t * S, S, 1);
+    int start = (t / interval_) * interval_;
+    if(segment_start_ != start){
+      segment_.resize(interval_ * S);
+      Vec state(ConstVectorView(filtered_.data() + (start / interval_) * S,
+                                S, 1));
+      std::copy(state.begin(), state.end(), segment_.begin());
+      int end = std::min<int>(start + interval_, dv.size());
+      for(int i = start + 1; i < end; ++i){
+        fwd_step(state, dv[i].get());
+        std::copy(state.begin(), state.end(),
+                  segment_.begin() + (i - start) * S);
+      }
+      segment_start_ = start;
+    }
+    return ConstVectorView(segment_.data() + (t - start) * S, S, 1);
+  }
+  //------------------------------------------------------------
+
   double HmmFilter::loglike(const std::vector<Ptr<Data> > & dv){
-    logQ = log(markov_->Q());
-    pi = markov_->pi0();
-    uint S = pi.size();
+    Q_ = markov_->Q();
     uint n = dv.size();
-    Mat P(logQ);
     double ans = initialize(dv[0].get());
-    for(uint i=1; i<n; ++i){
-      if(dv[i]->missing()) logp = 0;
-      else for(uint s=0; s<S; ++s) logp[s] = models_[s]->pdf(dv[i].get(), true);
-      ans += fwd_1(pi, P, logQ, logp, one);
-    }
+    for(uint i=1; i<n; ++i) ans += fwd_step(pi, dv[i].get());
     return ans;
   }
   //------------------------------------------------------------
 
-  void HmmFilter::bkwd_sampling_mt(const std::vector<Ptr<Data> > &dv,
-                                   RNG & eng){
+  void HmmFilter::sample_backward(const std::vector<Ptr<Data> > &dv,
+                                  RNG &rng,
+                                  bool use_allocate){
     uint n = dv.size();
-    // pi was already set by fwd.
-    // So the following line would  break things when n=1.
-    //      pi = one * P.back();
-    uint s = rmulti_mt(eng,pi);
-    models_[s]->add_data(dv.back());
-    for(uint i=n-1; i!=0; --i){
-      pi = P[i].col(s);
+    uint S = state_space_size();
+    // pi was set to pi[n-1] by fwd.
+    uint s = rmulti_mt(rng, pi);        // last obs in state s
+    if(use_allocate) allocate(dv.back(), s);
+    else models_[s]->add_data(dv.back());
+    for(uint i=n-1; i!=0; --i){         // start with s=h[i]
+      // p(h[i-1] = r | h[i] = s, y) is proportional to
+      // pi[i-1][r] * Q(r, s).
+      ConstVectorView previous(filtered(i-1, dv));
+      const double *column = Q_.data() + s * S;
+      for(uint r=0; r<S; ++r) pi[r] = previous[r] * column[r];
       pi.normalize_prob();
-      uint r = rmulti_mt(eng,pi);
-      models_[r]->add_data(dv[i-1]);
+      uint r = rmulti_mt(rng, pi);
+      if(use_allocate) allocate(dv[i-1], r);
+      else models_[r]->add_data(dv[i-1]);
       markov_->suf()->add_transition(r,s);
       s=r;
     }
     markov_->suf()->add_initial_value(s);
   }
 
+  void HmmFilter::bkwd_sampling_mt(const std::vector<Ptr<Data> > &dv,
+                                   RNG & eng){
+    sample_backward(dv, eng, false);
+  }
+
   //------------------------------------------------------------
   void HmmFilter::bkwd_sampling(const std::vector<Ptr<Data> > &dv ){
-    uint n = dv.size();
-    // pi was already set by fwd, so the following line would breaks
-    // things when n=1.
-    //      pi = one * P.back();
-    uint s = rmulti(pi);                // last obs in state s
-    allocate(dv.back(), s);             // last data point allocated
-
-    for(uint i=n-1; i!=0; --i){         // start with s=h[i]
-      pi = P[i].col(s);                 // compute r = h[i-1]
-      uint r = rmulti(pi);
-      allocate(dv[i-1], r);
-      markov_->suf()->add_transition(r,s);
-      s=r;
-    }
-    markov_->suf()->add_initial_value(s);
-    // in last step of loop i = 1, so s=h[0]
+    sample_backward(dv, default_rng(), true);
   }
   //----------------------------------------------------------------------
   void HmmFilter::allocate(Ptr<Data> dp, uint h){
@@ -191,16 +224,27 @@ namespace BOOM{
       {}
   //------------------------------------------------------------
   void HmmEmFilter::bkwd_smoothing(const std::vector<Ptr<Data> > & dv){
-    typedef std::vector<Mat>::reverse_iterator RIT;
-    // pi was set by fwd;
+    // pi was set by fwd to p(h[n-1] | y), which is already smoothed.
     uint n = dv.size();
     uint S = state_space_size();
+    if(joint_.nrow() != S) joint_ = Mat(S, S);
+    const double *Q = Q_.data();
     for(uint i=n-1; i!=0; --i){
       for(uint s=0; s<S; ++s) models_[s]->add_mixture_data(dv[i], pi[s]);
-      markov_->suf()->add_transition_distribution(P[i]);
-      bkwd_1(pi, P[i], logp, one);
+      // joint_(r, s) = p(h[i-1] = r, h[i] = s | y)
+      //              = pi[i-1][r] * Q(r, s) * p(h[i] = s | y) / pred[s],
+      // where pred = Q' * pi[i-1] and pi[i-1] is filtered.
+      ConstVectorView previous(filtered(i-1, dv));
+      for(uint s=0; s<S; ++s){
+        const double *column = Q + s * S;
+        double prediction = 0;
+        for(uint r=0; r<S; ++r) prediction += previous[r] * column[r];
+        double scale = prediction > 0 ? pi[s] / prediction : 0;
+        for(uint r=0; r<S; ++r) joint_(r, s) = previous[r] * column[r] * scale;
+      }
+      markov_->suf()->add_transition_distribution(joint_);
+      for(uint r=0; r<S; ++r) pi[r] = joint_.row(r).sum();
     }
-    pi = P[1] * one;
     for(uint s=0; s<S; ++s) models_[s]->add_mixture_data(dv[0], pi[s]);
     markov_->suf()->add_initial_distribution(pi);
   }
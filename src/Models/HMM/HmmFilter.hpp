@@ -33,18 +33,43 @@ class Data;
 class EmMixtureComponent;
 class HiddenMarkovModel;
 
+// HmmFilter runs the forward-backward algorithm for a
+// HiddenMarkovModel on one series at a time.
+//
+// The forward recursion is kept in scaled probability space:
+//
+//   pi[t] = (Q' * pi[t-1]) .* exp(logd[t] - max(logd[t])) / c[t],
+//
+// where logd[t][s] = log p(y[t] | h[t] = s) and c[t] normalizes
+// pi[t].  The log likelihood accumulates max(logd[t]) + log(c[t]).
+// Each step is one S x S matrix-vector product, plus S calls to exp.
+//
+// The filtered distributions pi[t] = p(h[t] | y[0..t]) are stored in
+// one contiguous n x S buffer that is reused across series and calls.
+// Given h[t] = s, the backward step needs only pi[t-1] and column s
+// of Q, because p(h[t-1] = r | h[t] = s, y[0..n]) is proportional to
+// pi[t-1][r] * Q(r, s).
+//
+// For very long series the buffer can be replaced by checkpoints (see
+// use_checkpoints()).
 class HmmFilter
     : private RefCounted{
  public:
   friend void intrusive_ptr_add_ref(HmmFilter *d){d->up_count();}
   friend void intrusive_ptr_release(HmmFilter *d){
-      d->down_count(); if(d->ref_count()==0) delete d;}
+      if(d->down_count()==0) delete d;}
 
   HmmFilter(std::vector<Ptr<MixtureComponent> >, Ptr<MarkovModel> );
   virtual ~HmmFilter(){}
   uint state_space_size()const;
 
+  // Sets pi to pi[0] and returns log p(y[0]).  If y[0] has zero
+  // density under every state the return value is -infinity and pi
+  // is uniform.
   double initialize(const Data *);
+  // Returns the log likelihood of the series, which is -infinity (not
+  // an error) if some observation is impossible under every state
+  // reachable at that time.
   double loglike(const std::vector<Ptr<Data> > & );
   double fwd(const std::vector<Ptr<Data> > & );
   void bkwd_sampling(const std::vector<Ptr<Data> > &);
@@ -52,13 +77,50 @@ class HmmFilter
                         RNG & eng);
   virtual void allocate(Ptr<Data>, uint);
   virtual Vec state_probs(Ptr<Data>)const;
+
+  // If 'yes' then fwd() stores pi[t] only at every k'th time point
+  // (the checkpoints), where k = ceil(sqrt(n)) for a series of length
+  // n.  The backward pass recomputes the pi's between checkpoints one
+  // segment at a time.  Memory falls from n * S to about 2 *
+  // sqrt(n) * S doubles, at the cost of evaluating each p(y[t] |
+  // h[t]) twice.
+  void use_checkpoints(bool yes = true);
+
  protected:
+  // Replaces state = pi[t-1] with pi[t], using the data point y[t].
+  // Returns log p(y[t] | y[0..t-1]).  If that is zero, the return
+  // value is -infinity and state is set to p(h[t] | y[0..t-1]).
+  double fwd_step(Vec &state, const Data *dp);
+
+  // Returns pi[t] from the most recent call to fwd(), which must have
+  // been given 'dv'.  With checkpoints this may recompute the segment
+  // containing t, invalidating views returned by earlier calls.
+  ConstVectorView filtered(uint t, const std::vector<Ptr<Data> > &dv);
+
   std::vector<Ptr<MixtureComponent> > models_;
-  std::vector<Mat> P;
-  Vec pi, logp, logpi, one;
-  Mat logQ;
+  Vec pi, logp, one;
+  // Q from the Markov model at the time of the last call to fwd().
+  Mat Q_;
+  // Q' * pi[t-1] during fwd_step().
+  Vec predicted_;
   Ptr<MarkovModel> markov_;
 
+ private:
+  // Samples the hidden states backward from pi[n-1], calling
+  // allocate() for each data point if 'use_allocate' is true, and
+  // adding the data directly to the mixture components otherwise.
+  void sample_backward(const std::vector<Ptr<Data> > &dv, RNG &rng,
+                       bool use_allocate);
+
+  bool use_checkpoints_;
+  // Distance between stored pi's in the last call to fwd().
+  uint interval_;
+  // filtered_[j * S .. (j + 1) * S) is pi[j * interval_].
+  Vec filtered_;
+  // With checkpoints, pi[segment_start_ + k] for k < interval_, or
+  // segment_start_ = -1 if the segment is out of date.
+  Vec segment_;
+  int segment_start_;
 };
 //----------------------------------------------------------------------
 class HmmSavePiFilter
@@ -77,9 +139,13 @@ class HmmEmFilter
     : public HmmFilter{
  public:
   HmmEmFilter(std::vector<Ptr<EmMixtureComponent> > , Ptr<MarkovModel>);
+  // Adds the smoothed state and transition distributions for 'dv' to
+  // the mixture components and the Markov model.  fwd(dv) must have
+  // been called first.
   virtual void bkwd_smoothing(const std::vector<Ptr<Data> > &);
  private:
   std::vector<Ptr<EmMixtureComponent> > models_;
+  Mat joint_;
 };
 
 }
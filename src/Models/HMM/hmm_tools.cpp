@@ -2,6 +2,7 @@
 #include <uint.hpp>
 #include <LinAlg/Matrix.hpp>
 #include <LinAlg/Vector.hpp>
+#include <cpputil/lse.hpp>
 
 namespace BOOM{
   using BOOM::uint;
@@ -22,16 +23,12 @@ namespace BOOM{
        * --------------------------------------------------------------------*/
       uint S = pi.size();
       P = logQ;
-      pi = log(pi);
+      log_in_place(pi.data(), S);
       for(uint r=0; r<S; ++r) P.row(r) += logd; // P(r,s) += logd[s]
       for(uint s=0; s<S; ++s) P.col(s) += pi;   // P(r,s) += pi[r]
-      double m = max(P);
-      P-=m;
-      P.exp();
-      double nc = P.abs_norm();
-      P/= nc;
+      double ans = softmax_in_place(P.data(), P.size());
       pi = one *P;
-      return m + log(nc);
+      return ans;
     }
 
     void bkwd_1(Vec &pi, Mat &P, Vec & wsp, const Vec &one){
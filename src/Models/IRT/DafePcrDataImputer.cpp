@@ -101,12 +101,13 @@ namespace BOOM{
     }
     //------------------------------------------------------------
     void IMP::impute_u(Vec &u, const Vec &eta, uint y){
+      RNG &eng(default_rng());
       double log_nc = lse(eta);
-      double logzmin = rlexp(log_nc);
+      double logzmin = rlexp_mt(eng, log_nc);
       uint M = u.size();
       for(uint m=0; m<M; ++m){
 	if(m==y) u[m] = mu-logzmin;
-	else u[m] = mu - lse2(logzmin, rlexp(eta[m]));}}
+	else u[m] = mu - lse2(logzmin, rlexp_mt(eng, eta[m]));}}
 
   } // namespace IRT
 } // namespace BOOM
@@ -28,7 +28,7 @@ namespace BOOM{
 
   //    void intrusive_ptr_add_ref(Model *m){ m->up_count(); }
   //    void intrusive_ptr_release(Model *m){
-  // m->down_count(); if(m->ref_count()==0) delete m; }
+  // if(m->down_count()==0) delete m; }
 
   Model::Model(){}
 
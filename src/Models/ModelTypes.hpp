@@ -46,7 +46,7 @@ namespace BOOM{
   public:
     friend void intrusive_ptr_add_ref(Model *d){d->up_count();}
     friend void intrusive_ptr_release(Model *d){
-      d->down_count(); if(d->ref_count()==0) delete d;}
+      if(d->down_count()==0) delete d;}
 
     //------ constructors, destructors, operator=/== -----------
     Model();
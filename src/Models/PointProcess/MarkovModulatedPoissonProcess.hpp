@@ -112,7 +112,7 @@ namespace BOOM{
      public:
       friend void intrusive_ptr_add_ref(HmmState *s){s->up_count();}
       friend void intrusive_ptr_release(HmmState *s){
-        s->down_count(); if(s->ref_count()==0) delete s;}
+        if(s->down_count()==0) delete s;}
     };
 
     //----------------------------------------------------------------------
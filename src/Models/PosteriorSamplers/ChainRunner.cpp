@@ -0,0 +1,263 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <Models/PosteriorSamplers/ChainRunner.hpp>
+#include <cpputil/report_error.hpp>
+#include <boost/bind.hpp>
+#include <sstream>
+#include <exception>
+
+namespace BOOM {
+
+  namespace {
+    // The largest number of batches kept by each chain for
+    // effective_sample_size().
+    const int kMaxBatches = 64;
+  }
+
+  ChainRunner::ChainRunner(int number_of_threads)
+      : number_of_parameters_(-1)
+  {
+    set_number_of_threads(number_of_threads);
+  }
+
+  //----------------------------------------------------------------------
+  ChainRunner::ChainRunner(const ChainFactory &factory,
+                           int number_of_chains,
+                           int number_of_threads)
+      : number_of_parameters_(-1)
+  {
+    set_number_of_threads(number_of_threads);
+    for (int i = 0; i < number_of_chains; ++i) {
+      add_chain(factory(i));
+    }
+  }
+
+  //----------------------------------------------------------------------
+  void ChainRunner::add_chain(const Ptr<Model> &model) {
+    if (!model) {
+      report_error("NULL model passed to ChainRunner::add_chain.");
+    }
+    if (number_of_draws() > 0) {
+      report_error("Chains cannot be added to a ChainRunner after "
+                   "draws have been recorded.");
+    }
+    int dim = model->vectorize_params(true).size();
+    if (number_of_parameters_ < 0) {
+      number_of_parameters_ = dim;
+    } else if (dim != number_of_parameters_) {
+      std::ostringstream err;
+      err << "All chains in a ChainRunner must have the same number of "
+          << "parameters.  The first chain has " << number_of_parameters_
+          << " but the chain being added has " << dim << ".";
+      report_error(err.str());
+    }
+    chains_.push_back(Chain());
+    Chain &chain(chains_.back());
+    chain.model = model;
+    chain.mean.resize(dim, 0.0);
+    chain.sum_of_squared_deviations.resize(dim, 0.0);
+    chain.batch_size = 1;
+    chain.current_batch_sum.resize(dim, 0.0);
+    chain.current_batch_count = 0;
+  }
+
+  //----------------------------------------------------------------------
+  void ChainRunner::set_number_of_threads(int number_of_threads) {
+    if (number_of_threads < 1) {
+      report_error("The number of threads must be positive.");
+    }
+    thread_pool_.set_number_of_threads(number_of_threads);
+  }
+
+  //----------------------------------------------------------------------
+  void ChainRunner::run(int niter, int burn) {
+    thread_pool_.parallel_for(
+        chains_.size(),
+        boost::bind(&ChainRunner::run_chain, this, _1, _2, niter, burn));
+
+    std::ostringstream err;
+    bool failed = false;
+    for (int i = 0; i < chains_.size(); ++i) {
+      if (!chains_[i].error_message.empty()) {
+        failed = true;
+        err << "Chain " << i << " failed: " << chains_[i].error_message
+            << std::endl;
+        chains_[i].error_message.clear();
+      }
+    }
+    if (failed) report_error(err.str());
+  }
+
+  //----------------------------------------------------------------------
+  void ChainRunner::run_chain(int chain_number, int, int niter, int burn) {
+    Chain *chain = &chains_[chain_number];
+    try {
+      for (int iteration = 0; iteration < niter; ++iteration) {
+        chain->model->sample_posterior();
+        if (iteration < burn) continue;
+        chain->draws.push_back(chain->model->vectorize_params(true));
+        update_summaries(chain, chain->draws.back());
+      }
+    } catch (std::exception &e) {
+      chain->error_message = e.what();
+    } catch (...) {
+      chain->error_message = "Unknown exception.";
+    }
+  }
+
+  //----------------------------------------------------------------------
+  void ChainRunner::update_summaries(Chain *chain, const Vector &draw) {
+    double n = chain->draws.size();
+    for (int j = 0; j < draw.size(); ++j) {
+      double delta = draw[j] - chain->mean[j];
+      chain->mean[j] += delta / n;
+      chain->sum_of_squared_deviations[j] += delta * (draw[j] - chain->mean[j]);
+    }
+
+    chain->current_batch_sum += draw;
+    if (++chain->current_batch_count < chain->batch_size) return;
+    chain->batch_sums.push_back(chain->current_batch_sum);
+    chain->current_batch_sum = 0;
+    chain->current_batch_count = 0;
+    if (chain->batch_sums.size() == kMaxBatches) {
+      std::vector<Vector> &sums(chain->batch_sums);
+      for (int k = 0; k < kMaxBatches / 2; ++k) {
+        sums[k] = sums[2 * k] + sums[2 * k + 1];
+      }
+      sums.resize(kMaxBatches / 2);
+      chain->batch_size *= 2;
+    }
+  }
+
+  //----------------------------------------------------------------------
+  int ChainRunner::number_of_chains() const {
+    return chains_.size();
+  }
+
+  int ChainRunner::number_of_parameters() const {
+    return std::max(number_of_parameters_, 0);
+  }
+
+  int ChainRunner::number_of_draws() const {
+    if (chains_.empty()) return 0;
+    int ans = chains_[0].draws.size();
+    for (int i = 1; i < chains_.size(); ++i) {
+      ans = std::min<int>(ans, chains_[i].draws.size());
+    }
+    return ans;
+  }
+
+  //----------------------------------------------------------------------
+  Matrix ChainRunner::draws(int chain) const {
+    const std::vector<Vector> &draws(chains_[chain].draws);
+    Matrix ans(draws.size(), number_of_parameters());
+    for (int i = 0; i < draws.size(); ++i) {
+      ans.set_row(i, draws[i]);
+    }
+    return ans;
+  }
+
+  //----------------------------------------------------------------------
+  Ptr<Model> ChainRunner::model(int chain) {
+    return chains_[chain].model;
+  }
+
+  //----------------------------------------------------------------------
+  Vector ChainRunner::rhat() const {
+    int m = chains_.size();
+    int n = number_of_draws();
+    if (m < 2 || n < 2) {
+      report_error("ChainRunner::rhat requires at least 2 chains "
+                   "with at least 2 draws each.");
+    }
+    for (int c = 0; c < m; ++c) {
+      if (chains_[c].draws.size() != n) {
+        report_error("All chains must have the same number of draws "
+                     "to compute rhat.");
+      }
+    }
+    int p = number_of_parameters();
+    Vector ans(p, 1.0);
+    for (int j = 0; j < p; ++j) {
+      double grand_mean = 0;
+      double within = 0;
+      for (int c = 0; c < m; ++c) {
+        grand_mean += chains_[c].mean[j];
+        within += chains_[c].sum_of_squared_deviations[j] / (n - 1);
+      }
+      grand_mean /= m;
+      within /= m;
+      double between = 0;
+      for (int c = 0; c < m; ++c) {
+        double delta = chains_[c].mean[j] - grand_mean;
+        between += delta * delta;
+      }
+      between *= static_cast<double>(n) / (m - 1);
+      if (within <= 0) continue;
+      double pooled_variance = ((n - 1.0) / n) * within + between / n;
+      ans[j] = sqrt(pooled_variance / within);
+    }
+    return ans;
+  }
+
+  //----------------------------------------------------------------------
+  Vector ChainRunner::effective_sample_size() const {
+    int p = number_of_parameters();
+    Vector ans(p, 0.0);
+    if (chains_.empty()) return ans;
+    for (int c = 0; c < chains_.size(); ++c) {
+      if (chains_[c].batch_sums.size() < 2) return ans;
+    }
+    for (int j = 0; j < p; ++j) {
+      // The chains' variances, and the asymptotic variances of their
+      // means, are summed over chains.
+      double total_draws = 0;
+      double variance = 0;
+      double asymptotic_variance = 0;
+      for (int c = 0; c < chains_.size(); ++c) {
+        const Chain &chain(chains_[c]);
+        int n = chain.draws.size();
+        total_draws += n;
+        variance += chain.sum_of_squared_deviations[j] / n;
+
+        int number_of_batches = chain.batch_sums.size();
+        double mean_of_batch_means = 0;
+        for (int k = 0; k < number_of_batches; ++k) {
+          mean_of_batch_means += chain.batch_sums[k][j];
+        }
+        mean_of_batch_means /= number_of_batches * chain.batch_size;
+        double batch_variance = 0;
+        for (int k = 0; k < number_of_batches; ++k) {
+          double d = chain.batch_sums[k][j] / chain.batch_size
+              - mean_of_batch_means;
+          batch_variance += d * d;
+        }
+        asymptotic_variance += chain.batch_size * batch_variance
+            / (number_of_batches - 1);
+      }
+      if (variance <= 0 || asymptotic_variance <= 0) {
+        ans[j] = total_draws;
+      } else {
+        ans[j] = total_draws * variance / asymptotic_variance;
+      }
+    }
+    return ans;
+  }
+
+}  // namespace BOOM
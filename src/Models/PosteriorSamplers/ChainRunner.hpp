@@ -0,0 +1,150 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_CHAIN_RUNNER_HPP_
+#define BOOM_CHAIN_RUNNER_HPP_
+
+#include <vector>
+#include <boost/function.hpp>
+#include <Models/ModelTypes.hpp>
+#include <LinAlg/Vector.hpp>
+#include <LinAlg/Matrix.hpp>
+#include <cpputil/ThreadPool.hpp>
+
+namespace BOOM {
+
+  // Runs several independent MCMC chains on a pool of threads, in a
+  // single process.  Each chain is a Model with its data and
+  // posterior sampler(s) already assigned.  Each call to
+  // model->sample_posterior() is one MCMC iteration, after which the
+  // model's parameters (as returned by vectorize_params()) are
+  // appended to that chain's buffer of draws.
+  //
+  // Running means, variances and batch means of each parameter are
+  // accumulated as the draws arrive, so the Gelman-Rubin potential
+  // scale reduction factor (R-hat) and the effective sample size are
+  // cheap to monitor between calls to run().
+  //
+  // Chains share nothing but the thread pool.  The PosteriorSampler
+  // constructor seeds each sampler from seed_rng(), so chains built
+  // serially by a ChainFactory get distinct, reproducible seeds for a
+  // fixed global seed.  Runs are reproducible only if every draw a
+  // chain makes comes from its own samplers' rng(), or from a
+  // ThreadRngScope seeded from it.  ChainRunner does not install a
+  // ThreadRngScope, so in a pool thread default_rng() is the shared
+  // GlobalRng::rng.  Any sampler that draws from it, for example
+  // through rnorm() or runif() with no RNG argument, makes the results
+  // depend on thread scheduling, and its chains are not safe to run
+  // concurrently.
+  class ChainRunner {
+   public:
+    // A ChainFactory builds one fully configured chain (model, data,
+    // and posterior samplers).  The argument is the chain number.
+    // Note that Model::clone() does not copy data or sampling
+    // methods, so a factory is needed to build the chains.
+    typedef boost::function<Ptr<Model>(int)> ChainFactory;
+
+    // Args:
+    //   number_of_threads:  The maximum number of chains to run at once.
+    explicit ChainRunner(int number_of_threads = 1);
+
+    // Build number_of_chains chains by calling factory(0),
+    // factory(1), ... in the calling thread.
+    ChainRunner(const ChainFactory &factory,
+                int number_of_chains,
+                int number_of_threads);
+
+    // Add a configured chain.  All chains must have the same number
+    // of parameters.  It is an error to add a chain after run() has
+    // been called.
+    void add_chain(const Ptr<Model> &model);
+
+    void set_number_of_threads(int number_of_threads);
+
+    // Run each chain for 'niter' more iterations.  The first
+    // 'burn' iterations of this call are run but not recorded.  run()
+    // may be called repeatedly to extend the chains.  If any chain
+    // throws an exception, the other chains finish their iterations
+    // and an exception is then thrown from run().
+    void run(int niter, int burn = 0);
+
+    int number_of_chains() const;
+    int number_of_parameters() const;
+
+    // The number of recorded draws in each chain.
+    int number_of_draws() const;
+
+    // The recorded draws for the given chain.  Rows are iterations,
+    // columns are parameters.
+    Matrix draws(int chain) const;
+
+    // The model that chain 'chain' is sampling.
+    Ptr<Model> model(int chain);
+
+    // Gelman-Rubin potential scale reduction factor for each
+    // parameter, computed from the running chain means and variances.
+    // Values near 1 indicate the chains are mixing.  Parameters that
+    // have zero variance within every chain are reported as 1.
+    // Requires at least 2 chains and 2 draws.
+    Vector rhat() const;
+
+    // Effective sample size for each parameter, pooled across chains,
+    // estimated by batch means.  Batches start with one draw each.
+    // When a chain fills its 64th batch, adjacent pairs are merged, so
+    // the batch size doubles and updating costs O(1) per draw.  A chain
+    // has one batch per draw until it has 32 draws.  After that it
+    // holds between 32 and 63 complete batches.  The asymptotic
+    // variance of a chain's mean is batch_size times the variance of its
+    // batch means.  Draws in a chain's unfinished batch are ignored.
+    // Returns zeros until every chain has at least 2 batches.
+    Vector effective_sample_size() const;
+
+   private:
+    // The state managed by a single chain.  Only the thread running
+    // the chain touches this during run().
+    struct Chain {
+      Ptr<Model> model;
+      std::vector<Vector> draws;
+      // Running (Welford) moments of the recorded draws.
+      Vector mean;
+      Vector sum_of_squared_deviations;
+      // Sums of the completed batches of batch_size draws, and of the
+      // draws in the batch being filled.
+      int batch_size;
+      std::vector<Vector> batch_sums;
+      Vector current_batch_sum;
+      int current_batch_count;
+      // The message from any exception thrown while running the chain.
+      std::string error_message;
+    };
+
+    // Run a single chain.  This is a task for thread_pool_.
+    void run_chain(int chain, int worker, int niter, int burn);
+
+    // Add a recorded draw to the chain's running moments and batches.
+    void update_summaries(Chain *chain, const Vector &draw);
+
+    std::vector<Chain> chains_;
+    int number_of_parameters_;
+    // Runs one task per chain.
+    ThreadPool thread_pool_;
+  };
+
+}  // namespace BOOM
+
+#endif  // BOOM_CHAIN_RUNNER_HPP_
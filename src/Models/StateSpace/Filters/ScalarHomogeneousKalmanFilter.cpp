@@ -20,16 +20,25 @@
 #include <Models/StateSpace/Filters/KalmanTools.hpp> // scalar_kalman_update
 #include <distributions.hpp>
 #include <cpputil/nyi.hpp>
+#include <cpputil/report_error.hpp>
 
 namespace BOOM{
 
   typedef ScalarHomogeneousKalmanFilter SHKF;
 
-  SHKF::ScalarHomogeneousKalmanFilter(){}
+  SHKF::ScalarHomogeneousKalmanFilter()
+      : n_(0),
+        checkpoint_interval_(1),
+        segment_start_(-1)
+  {}
+
   SHKF::ScalarHomogeneousKalmanFilter(const Vec &Z, double H,
                                       const Mat & T, const Mat &R, const Spd & Q,
                                       Ptr<MvnModel> init)
-      : initial_state_distribution_(init)
+      : initial_state_distribution_(init),
+        n_(0),
+        checkpoint_interval_(1),
+        segment_start_(-1)
   {
     set_matrices(Z,H,T,R,Q);
   }
@@ -37,6 +46,45 @@ namespace BOOM{
   void SHKF::set_initial_state_distribution(Ptr<MvnModel> m){
     initial_state_distribution_=m; }
 
+  void SHKF::set_checkpoint_interval(uint interval){
+    if(interval < 1){
+      report_error("The checkpoint interval must be positive in "
+                   "ScalarHomogeneousKalmanFilter.");
+    }
+    checkpoint_interval_ = interval;
+    segment_start_ = -1;
+  }
+
+  void SHKF::store_state_variance(ScalarKalmanStorage &s, const Spd &P,
+                                  uint t){
+    if(t % checkpoint_interval_ == 0){
+      s.P = P;
+    }else if(s.P.nrow() > 0){
+      // Release memory left over from an earlier run without
+      // checkpoints.
+      s.P = Spd();
+    }
+  }
+
+  Spd & SHKF::state_variance(uint t){
+    if(checkpoint_interval_ == 1) return f_[t].P;
+    int start = t - t % checkpoint_interval_;
+    if(start != segment_start_){
+      segment_P_.resize(checkpoint_interval_);
+      Spd P = f_[start].P;
+      Vec a(P.nrow(), 0.0);
+      Vec K;
+      double F, v;
+      for(uint i = start; i < start + checkpoint_interval_ && i < n_; ++i){
+        segment_P_[i - start] = P;
+        // P does not depend on y, so a and y are placeholders.
+        update(0, a, P, K, F, v);
+      }
+      segment_start_ = start;
+    }
+    return segment_P_[t - start];
+  }
+
   void SHKF::set_matrices(const Vec &Z, double H, const Mat & T, const Mat &R, const Spd & Q){
     Z_ = Z;
     H_ = H;
@@ -101,13 +149,14 @@ namespace BOOM{
     uint n = ts.size();
     n_ = n;
     if(f.size() < n) f.resize(n);
+    segment_start_ = -1;
     double ans = 0;
     Vec a = initial_state_distribution_->mu();
     Spd P = initial_state_distribution_->Sigma();
     for(uint i=0; i<n; ++i){
       ScalarKalmanStorage & s(f[i]);
       s.a = a;
-      s.P = P;
+      store_state_variance(s, P, i);
       double y = ts[i];
       ans += update(y, a, P, s.K, s.F, s.v);
     }
@@ -118,6 +167,7 @@ namespace BOOM{
   double SHKF::fwd(const TimeSeries<DoubleData> & ts){
     n_ = ts.length();
     if(f_.size() < n_+1) f_.resize(n_+1);
+    segment_start_ = -1;
 
     double ans=0;
     Vec a = initial_state_distribution_->mu();
@@ -125,7 +175,7 @@ namespace BOOM{
     for(uint i=0; i<n_; ++i){
       ScalarKalmanStorage & s(f_[i]);
       s.a = a;
-      s.P = P;
+      store_state_variance(s, P, i);
       double y = ts[i]->value();
       ans += update(y, a, P, s.K, s.F, s.v);
     }
@@ -142,9 +192,11 @@ namespace BOOM{
     N_ = 0.0;
     for(uint i=n_-1; i!=0; --i){
       ScalarKalmanStorage &s(f_[i]);
-      scalar_kalman_smoother_update(s.a, s.P,s.K, s.F, s.v,
+      scalar_kalman_smoother_update(s.a, state_variance(i), s.K, s.F, s.v,
                                     Z_, T_, r_, N_, L_);
     }
+    // The smoother overwrote the filtered P's in segment_P_.
+    segment_start_ = -1;
   }
 
   //------------------------------------------------------------
@@ -41,6 +41,14 @@ namespace BOOM{
     Mat  bkwd_sampling();  // returns state
     void bkwd_smoother();
 
+    // By default fwd() stores the state variance P[t] for every time
+    // point, which takes n * m^2 doubles for a state of dimension m.
+    // If 'interval' is larger than 1, P is stored only at every
+    // interval'th time point (the checkpoints).  The smoother
+    // recomputes the P's between checkpoints one segment at a time,
+    // at the cost of one extra variance recursion per time point.
+    void set_checkpoint_interval(uint interval);
+
     void set_initial_state_distribution(Ptr<MvnModel> m);
     void set_matrices(const Vec &Z, double H, const Mat & T,
                       const Mat &R, const Spd & Q);
@@ -55,7 +63,7 @@ namespace BOOM{
     friend void intrusive_ptr_add_ref(ScalarHomogeneousKalmanFilter *d){
       d->up_count();}
     friend void intrusive_ptr_release(ScalarHomogeneousKalmanFilter *d){
-      d->down_count(); if(d->ref_count()==0) delete d;}
+      if(d->down_count()==0) delete d;}
 
    private:
     double update(double y, Vec &a, Spd & P, Vec &K, double &F, double &v,
@@ -68,6 +76,15 @@ namespace BOOM{
 
     double initialize(ScalarKalmanStorage &s);
 
+    // Saves P as P[t] in s if t is a checkpoint.
+    void store_state_variance(ScalarKalmanStorage &s, const Spd &P, uint t);
+
+    // Returns P[t] for the output of fwd() held in f_.  With
+    // checkpointing the result is a reference into segment_P_, which
+    // is recomputed from the nearest checkpoint when t moves to a new
+    // segment.
+    Spd & state_variance(uint t);
+
     std::pair<Vec, Mat> simulate_fake_data(uint n);
     Vec simulate_initial_state()const;
 
@@ -85,5 +102,12 @@ namespace BOOM{
     Spd RQR_;
     std::vector<ScalarKalmanStorage> f_;
     uint n_;
+
+    uint checkpoint_interval_;
+    // P for the time points in [segment_start_, segment_start_ +
+    // checkpoint_interval_).  segment_start_ is -1 if segment_P_ is
+    // not current.
+    std::vector<Spd> segment_P_;
+    int segment_start_;
   };
 }
@@ -76,8 +76,7 @@ namespace BOOM{
    private:
     friend void intrusive_ptr_add_ref(SparseMatrixBlock *m){m->up_count();}
     friend void intrusive_ptr_release(SparseMatrixBlock *m){
-      m->down_count();
-      if(m->ref_count()==0) delete m;}
+      if(m->down_count()==0) delete m;}
   };
 
   //======================================================================
@@ -523,6 +522,10 @@ namespace BOOM{
     void replace_block(int which_block, Ptr<SparseMatrixBlock> b);
     void clear();
 
+    int nblocks()const{return blocks_.size();}
+    const SparseMatrixBlock * block(int which_block)const{
+      return blocks_[which_block].get();}
+
     virtual int nrow()const;
     virtual int ncol()const;
 
@@ -103,6 +103,10 @@ namespace BOOM{
     return ans;
   }
 
+  bool SparseVector::operator==(const SparseVector &rhs)const{
+    return size_ == rhs.size_ && elements_ == rhs.elements_;
+  }
+
   template <class VEC>
   double do_dot(const VEC &v, const std::map<int,double> &m, int size){
     if(v.size() != size){
@@ -139,6 +143,20 @@ namespace BOOM{
     return ans;
   }
 
+  void SparseVector::premultiply(const Spd &P, Vec &ans)const{
+    if(P.ncol() != size_){
+      report_error("incompatible matrix in SparseVector::premultiply");
+    }
+    int n = P.nrow();
+    if(ans.size() != n) ans.resize(n);
+    ans = 0.0;
+    for(Cit it = elements_.begin(); it != elements_.end(); ++it){
+      const double *column = P.data() + it->first * n;
+      double weight = it->second;
+      for(int i = 0; i < n; ++i) ans[i] += weight * column[i];
+    }
+  }
+
   Vec SparseVector::dense()const{
     Vec ans(size(), 0.0);
     for(Cit it = elements_.begin(); it != elements_.end(); ++it){
@@ -56,6 +56,10 @@ namespace BOOM{
     SparseVector & operator*=(double x);
     SparseVector & operator/=(double x);
     double sum()const;
+
+    // True if the vectors have the same size and the same nonzero
+    // elements.
+    bool operator==(const SparseVector &rhs)const;
     double dot(const Vec &v)const;
     double dot(const VectorView &v)const;
     double dot(const ConstVectorView &v)const;
@@ -68,6 +72,10 @@ namespace BOOM{
     // * this[i] * this[j]
     double sandwich(const Spd &P)const;
 
+    // Sets ans = P * this, reusing the memory in ans.  Only the
+    // columns of P matching nonzero elements of *this are touched.
+    void premultiply(const Spd &P, Vec &ans)const;
+
     // Return the dense vector equivalent to *this.
     Vec dense()const;
    private:
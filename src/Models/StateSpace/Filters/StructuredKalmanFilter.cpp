@@ -0,0 +1,372 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <Models/StateSpace/Filters/StructuredKalmanFilter.hpp>
+#include <Models/StateSpace/Filters/SparseKalmanTools.hpp>
+#include <LinAlg/SubMatrix.hpp>
+#include <distributions.hpp>
+#include <cpputil/report_error.hpp>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace BOOM{
+
+  typedef StructuredKalmanFilter SKF;
+
+  KalmanSteadyState::KalmanSteadyState()
+      : tolerance_(0),
+        converged_(false),
+        have_system_(false),
+        candidate_(false),
+        H_(0),
+        F_(0)
+  {}
+
+  void KalmanSteadyState::reset(double tolerance){
+    tolerance_ = tolerance;
+    converged_ = false;
+    have_system_ = false;
+    candidate_ = false;
+  }
+
+  namespace {
+    void get_blocks(const BlockDiagonalMatrix &m,
+                    std::vector<const SparseMatrixBlock *> &blocks){
+      blocks.resize(m.nblocks());
+      for(int b = 0; b < m.nblocks(); ++b) blocks[b] = m.block(b);
+    }
+
+    bool same_blocks(const BlockDiagonalMatrix &m,
+                     const std::vector<const SparseMatrixBlock *> &blocks){
+      if(m.nblocks() != blocks.size()) return false;
+      for(int b = 0; b < blocks.size(); ++b){
+        if(m.block(b) != blocks[b]) return false;
+      }
+      return true;
+    }
+  }  // namespace
+
+  bool KalmanSteadyState::same_system(const SparseVector &Z,
+                                      double H,
+                                      const BlockDiagonalMatrix &T,
+                                      const BlockDiagonalMatrix &RQR)const{
+    return have_system_
+        && H == H_
+        && same_blocks(T, transition_blocks_)
+        && same_blocks(RQR, variance_blocks_)
+        && Z == Z_;
+  }
+
+  void KalmanSteadyState::record(const SparseVector &Z,
+                                 double H,
+                                 const BlockDiagonalMatrix &T,
+                                 const BlockDiagonalMatrix &RQR){
+    Z_ = Z;
+    H_ = H;
+    get_blocks(T, transition_blocks_);
+    get_blocks(RQR, variance_blocks_);
+    have_system_ = true;
+  }
+
+  double KalmanSteadyState::threshold(const Spd &P)const{
+    double scale = 0;
+    for(int i = 0; i < P.nrow(); ++i) scale = std::max(scale, fabs(P(i, i)));
+    return tolerance_ * scale;
+  }
+
+  bool KalmanSteadyState::small_diagonal_change(const Spd &P)const{
+    int n = P.nrow();
+    if(previous_diagonal_.size() != n) return false;
+    double eps = threshold(P);
+    for(int i = 0; i < n; ++i){
+      if(fabs(P(i, i) - previous_diagonal_[i]) > eps) return false;
+    }
+    return true;
+  }
+
+  bool KalmanSteadyState::small_change(const Spd &P)const{
+    int n = P.nrow();
+    if(previous_P_.nrow() != n) return false;
+    const double *now = P.data();
+    const double *then = previous_P_.data();
+    double eps = threshold(P);
+    for(int i = 0; i < n * n; ++i){
+      if(fabs(now[i] - then[i]) > eps) return false;
+    }
+    return true;
+  }
+
+  //======================================================================
+
+  SKF::StructuredKalmanFilter()
+      : dim_(0)
+  {}
+
+  int SKF::number_of_fallback_blocks()const{
+    int ans = 0;
+    for(int i = 0; i < schedule_.size(); ++i){
+      if(schedule_[i].kernel == GENERIC) ++ans;
+    }
+    return ans;
+  }
+
+  bool SKF::schedule_is_current(const BlockDiagonalMatrix &T)const{
+    if(T.nrow() != dim_ || T.nblocks() != compiled_blocks_.size()){
+      return false;
+    }
+    for(int b = 0; b < compiled_blocks_.size(); ++b){
+      if(T.block(b) != compiled_blocks_[b]) return false;
+    }
+    return true;
+  }
+
+  bool SKF::compile(const SparseKalmanMatrix &T){
+    const BlockDiagonalMatrix *block_diagonal =
+        dynamic_cast<const BlockDiagonalMatrix *>(&T);
+    if(!block_diagonal || block_diagonal->nrow() != block_diagonal->ncol()){
+      schedule_.clear();
+      compiled_blocks_.clear();
+      dim_ = 0;
+      return false;
+    }
+    if(schedule_is_current(*block_diagonal)) return true;
+
+    schedule_.clear();
+    compiled_blocks_.clear();
+    dim_ = block_diagonal->nrow();
+    int offset = 0;
+    for(int b = 0; b < block_diagonal->nblocks(); ++b){
+      const SparseMatrixBlock *block = block_diagonal->block(b);
+      compiled_blocks_.push_back(block);
+      if(block->nrow() != block->ncol()){
+        // Non-square blocks can't be applied in place.
+        schedule_.clear();
+        compiled_blocks_.clear();
+        dim_ = 0;
+        return false;
+      }
+      ScheduleEntry entry;
+      entry.offset = offset;
+      entry.size = block->nrow();
+      entry.block = block;
+      offset += entry.size;
+      if(dynamic_cast<const IdentityMatrix *>(block)){
+        continue;
+      }else if(dynamic_cast<const LocalLinearTrendMatrix *>(block)){
+        entry.kernel = LOCAL_LINEAR_TREND;
+      }else if(dynamic_cast<const SeasonalStateSpaceMatrix *>(block)){
+        entry.kernel = SEASONAL;
+      }else{
+        entry.kernel = GENERIC;
+      }
+      schedule_.push_back(entry);
+    }
+    return true;
+  }
+
+  //----------------------------------------------------------------------
+  void SKF::apply(const ScheduleEntry &e, double *x)const{
+    double *block = x + e.offset;
+    switch(e.kernel){
+      case LOCAL_LINEAR_TREND:
+        block[0] += block[1];
+        break;
+      case SEASONAL:{
+        double total = 0;
+        for(int i = e.size - 1; i > 0; --i){
+          total -= block[i];
+          block[i] = block[i-1];
+        }
+        block[0] = total - block[0];
+        break;
+      }
+      default:
+        e.block->multiply_inplace(VectorView(block, e.size, 1));
+    }
+  }
+
+  void SKF::transition(double *x)const{
+    for(int i = 0; i < schedule_.size(); ++i) apply(schedule_[i], x);
+  }
+
+  //----------------------------------------------------------------------
+  void SKF::apply_transpose_to_columns(const ScheduleEntry &e, Spd &P)const{
+    int n = P.nrow();
+    double *first_column = P.data() + e.offset * n;
+    switch(e.kernel){
+      case LOCAL_LINEAR_TREND:{
+        double *level = first_column;
+        const double *slope = first_column + n;
+        for(int i = 0; i < n; ++i) level[i] += slope[i];
+        break;
+      }
+      case SEASONAL:{
+        // The first column becomes minus the sum of the columns, and
+        // the others shift one place to the right.
+        column_workspace_.resize(n);
+        double *total = column_workspace_.data();
+        for(int i = 0; i < n; ++i) total[i] = 0;
+        for(int j = e.size - 1; j >= 0; --j){
+          double *column = first_column + j * n;
+          for(int i = 0; i < n; ++i) total[i] -= column[i];
+          if(j > 0) std::memcpy(column, column - n, n * sizeof(double));
+        }
+        std::memcpy(first_column, total, n * sizeof(double));
+        break;
+      }
+      default:
+        e.block->matrix_transpose_premultiply_inplace(
+            SubMatrix(P, 0, n - 1, e.offset, e.offset + e.size - 1));
+    }
+  }
+
+  void SKF::sandwich(Spd &P)const{
+    int n = P.nrow();
+    double *data = P.data();
+    // P = T * P, one column at a time.
+    for(int j = 0; j < n; ++j) transition(data + j * n);
+    // P = P * T.transpose(), one block of columns at a time.
+    for(int i = 0; i < schedule_.size(); ++i){
+      apply_transpose_to_columns(schedule_[i], P);
+    }
+  }
+
+  //----------------------------------------------------------------------
+  double SKF::update(double y,
+                     Vec &a,
+                     Spd &P,
+                     Vec &K,
+                     double &F,
+                     double &v,
+                     bool missing,
+                     const SparseVector &Z,
+                     double H,
+                     const SparseKalmanMatrix &T,
+                     const SparseKalmanMatrix &RQR){
+    if(!compile(T) || a.size() != dim_ || P.nrow() != dim_){
+      return sparse_scalar_kalman_update(
+          y, a, P, K, F, v, missing, Z, H, T, RQR);
+    }
+
+    Z.premultiply(P, PZ_);
+    F = Z.dot(PZ_) + H;
+    if(F <= 0) {
+      std::ostringstream err;
+      err << "Found a zero forecast variance:" << endl
+          << "missing = " << missing << endl
+          << "a = " << a << endl
+          << "P = " << endl << P << endl
+          << "y = " << y << endl
+          << "H = " << H << endl
+          << "ZPZ = " << Z.dot(PZ_) << endl
+          << "Z = " << Z.dense() << endl;
+      report_error(err.str());
+    }
+    TPZ_ = PZ_;
+    transition(TPZ_.data());
+
+    double loglike = 0;
+    if(!missing){
+      K = TPZ_;
+      K /= F;
+      double mu = Z.dot(a);
+      v = y - mu;
+      loglike = dnorm(y, mu, sqrt(F), true);
+    }else{
+      if(K.size() != dim_) K.resize(dim_);
+      K = 0.0;
+      v = 0;
+    }
+
+    transition(a.data());           // a = T * a
+    if(!missing) a.axpy(K, v);      // a += K * v
+    sandwich(P);                    // P = T P T.transpose()
+    if(!missing){
+      P.Mat::add_outer(TPZ_, K, -1); // P -= T*P*Z*K.transpose();
+    }
+    RQR.add_to(P);                  // P += RQR
+    return loglike;
+  }
+
+  //----------------------------------------------------------------------
+  double SKF::update(double y,
+                     Vec &a,
+                     Spd &P,
+                     Vec &K,
+                     double &F,
+                     double &v,
+                     bool missing,
+                     const SparseVector &Z,
+                     double H,
+                     const SparseKalmanMatrix &T,
+                     const SparseKalmanMatrix &RQR,
+                     KalmanSteadyState *steady_state){
+    const BlockDiagonalMatrix *block_T =
+        dynamic_cast<const BlockDiagonalMatrix *>(&T);
+    const BlockDiagonalMatrix *block_RQR =
+        dynamic_cast<const BlockDiagonalMatrix *>(&RQR);
+    if(!steady_state || steady_state->tolerance_ <= 0
+       || !block_T || !block_RQR || missing){
+      if(steady_state){
+        steady_state->converged_ = false;
+        steady_state->have_system_ = false;
+      }
+      return update(y, a, P, K, F, v, missing, Z, H, T, RQR);
+    }
+
+    KalmanSteadyState &monitor(*steady_state);
+    bool same_system = monitor.same_system(Z, H, *block_T, *block_RQR);
+    if(same_system && monitor.converged_ && compile(T)
+       && a.size() == dim_){
+      // Fixed gain update.  P keeps its converged value.
+      double mu = Z.dot(a);
+      F = monitor.F_;
+      v = y - mu;
+      K = monitor.K_;
+      transition(a.data());
+      a.axpy(K, v);
+      return dnorm(y, mu, sqrt(F), true);
+    }
+
+    monitor.converged_ = false;
+    if(!same_system){
+      monitor.record(Z, H, *block_T, *block_RQR);
+      monitor.candidate_ = false;
+    }
+    int n = P.nrow();
+    monitor.previous_diagonal_.resize(n);
+    for(int i = 0; i < n; ++i) monitor.previous_diagonal_[i] = P(i, i);
+
+    double loglike = update(y, a, P, K, F, v, missing, Z, H, T, RQR);
+
+    if(!same_system) return loglike;
+    if(monitor.candidate_ && monitor.small_change(P)){
+      monitor.converged_ = true;
+      monitor.K_ = K;
+      monitor.F_ = F;
+    }else if(monitor.small_diagonal_change(P)){
+      monitor.candidate_ = true;
+      monitor.previous_P_ = P;
+    }else{
+      monitor.candidate_ = false;
+    }
+    return loglike;
+  }
+
+}
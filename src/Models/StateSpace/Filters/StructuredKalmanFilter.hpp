@@ -0,0 +1,216 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_STRUCTURED_KALMAN_FILTER_HPP
+#define BOOM_STRUCTURED_KALMAN_FILTER_HPP
+
+#include <LinAlg/Vector.hpp>
+#include <LinAlg/SpdMatrix.hpp>
+#include <Models/StateSpace/Filters/SparseVector.hpp>
+#include <Models/StateSpace/Filters/SparseMatrix.hpp>
+#include <vector>
+
+namespace BOOM{
+
+  // Convergence monitor for the steady state shortcut in
+  // StructuredKalmanFilter::update().  Each pass of the filter over a
+  // series needs its own KalmanSteadyState, reset() at the start of
+  // the pass.
+  //
+  // Once the system matrices (Z, H, T, RQR) are the same for two
+  // consecutive observed time points, and P changes between them by
+  // no more than 'tolerance' times its largest diagonal element, the
+  // filter freezes P, F, and the Kalman gain.  The diagonal of P is
+  // checked at every step, and the full matrix only once the diagonal
+  // has settled, so monitoring a filter that never converges is cheap.
+  // Later updates cost O(state dimension) instead of O(state
+  // dimension^2).  The full update resumes at the first missing
+  // observation or change in the system matrices.
+  //
+  // Matrices are identified by their SparseMatrixBlock objects, not by
+  // their contents.  A block that is modified in place between time
+  // points looks unchanged, so filters whose blocks can change this
+  // way must not use a KalmanSteadyState.  StateSpaceModelBase turns
+  // the shortcut off for state models with
+  // has_time_varying_blocks().
+  class KalmanSteadyState{
+   public:
+    KalmanSteadyState();
+
+    // Starts a new pass of the filter.  A non-positive tolerance turns
+    // the shortcut off.
+    void reset(double tolerance);
+
+    bool converged()const{return converged_;}
+
+   private:
+    friend class StructuredKalmanFilter;
+
+    // Returns true if the arguments match the system matrices saved by
+    // the most recent call to record().
+    bool same_system(const SparseVector &Z,
+                     double H,
+                     const BlockDiagonalMatrix &T,
+                     const BlockDiagonalMatrix &RQR)const;
+    void record(const SparseVector &Z,
+                double H,
+                const BlockDiagonalMatrix &T,
+                const BlockDiagonalMatrix &RQR);
+
+    // Returns the convergence threshold for P.
+    double threshold(const Spd &P)const;
+    // Returns true if the diagonal of P is within tolerance of
+    // previous_diagonal_.
+    bool small_diagonal_change(const Spd &P)const;
+    // Returns true if P is within tolerance of previous_P_.
+    bool small_change(const Spd &P)const;
+
+    double tolerance_;
+    bool converged_;
+    bool have_system_;
+    // True if the diagonal of P settled in the previous step, in which
+    // case previous_P_ holds the value of P at the start of this step.
+    bool candidate_;
+
+    SparseVector Z_;
+    double H_;
+    std::vector<const SparseMatrixBlock *> transition_blocks_;
+    std::vector<const SparseMatrixBlock *> variance_blocks_;
+
+    Vec previous_diagonal_;
+    Spd previous_P_;
+    Vec K_;
+    double F_;
+  };
+
+  // A drop-in replacement for sparse_scalar_kalman_update() that
+  // exploits the block diagonal structure of the state transition
+  // matrix T.
+  //
+  // The first time it sees a BlockDiagonalMatrix the filter compiles
+  // the blocks into a flat schedule of (kernel, offset, size) entries.
+  // Identity blocks are dropped from the schedule, and blocks with
+  // known structure (local linear trend, seasonal) are applied by
+  // inline kernels working directly on the memory in a, P, and the
+  // workspace vectors.  Other blocks are applied through their
+  // virtual multiply_inplace() methods.  The schedule is reused until
+  // the blocks in T change, which in a StateSpaceModelBase happens
+  // only when state models are added.
+  //
+  // The forecast, gain, and state variance updates are done in place
+  // using workspace owned by the filter, so a time step does not
+  // allocate any vectors or matrices (beyond whatever the fallback
+  // blocks allocate).  State transition matrices that are not
+  // BlockDiagonalMatrix objects are handled by
+  // sparse_scalar_kalman_update().
+  //
+  // The filter holds workspace, so each thread needs its own
+  // StructuredKalmanFilter.
+  class StructuredKalmanFilter{
+   public:
+    StructuredKalmanFilter();
+
+    // Arguments and return value are the same as
+    // sparse_scalar_kalman_update().
+    double update(double y,
+                  Vec &a,
+                  Spd &P,
+                  Vec &kalman_gain,
+                  double &forecast_error_variance,
+                  double &forecast_error,
+                  bool missing,
+                  const SparseVector &Z,
+                  double observation_variance,
+                  const SparseKalmanMatrix &T,
+                  const SparseKalmanMatrix &RQR);
+
+    // The same as the update above, but switches to a fixed gain
+    // update once 'steady_state' finds that P has converged.  P is left
+    // at its converged value while the shortcut is in use.  If
+    // 'steady_state' is NULL this is the update above.
+    double update(double y,
+                  Vec &a,
+                  Spd &P,
+                  Vec &kalman_gain,
+                  double &forecast_error_variance,
+                  double &forecast_error,
+                  bool missing,
+                  const SparseVector &Z,
+                  double observation_variance,
+                  const SparseKalmanMatrix &T,
+                  const SparseKalmanMatrix &RQR,
+                  KalmanSteadyState *steady_state);
+
+    // Number of entries in the compiled schedule, and the number of
+    // those entries handled by a virtual SparseMatrixBlock call.
+    // Mainly for testing.
+    int schedule_size()const{return schedule_.size();}
+    int number_of_fallback_blocks()const;
+
+    // Replace x with T * x, where T is the most recently compiled
+    // transition matrix.
+    void transition(double *x)const;
+
+    // Replace P with T * P * T.transpose(), where T is the most
+    // recently compiled transition matrix.
+    void sandwich(Spd &P)const;
+
+    // Compiles the schedule for T if it is not already current.
+    // Returns false if T is not a BlockDiagonalMatrix, in which case
+    // the schedule is left empty.
+    bool compile(const SparseKalmanMatrix &T);
+
+   private:
+    enum Kernel {
+      LOCAL_LINEAR_TREND,
+      SEASONAL,
+      GENERIC
+    };
+
+    struct ScheduleEntry{
+      Kernel kernel;
+      int offset;
+      int size;
+      const SparseMatrixBlock *block;
+    };
+
+    bool schedule_is_current(const BlockDiagonalMatrix &T)const;
+
+    // Apply schedule entry 'e' to the vector of length dim_ starting
+    // at x.
+    void apply(const ScheduleEntry &e, double *x)const;
+
+    // Replace the columns of P belonging to entry e with
+    // P.cols * block.transpose().  This is the row-wise half of the
+    // sandwich operation, rearranged so that it works on whole
+    // columns of P.
+    void apply_transpose_to_columns(const ScheduleEntry &e, Spd &P)const;
+
+    std::vector<ScheduleEntry> schedule_;
+    // The blocks T was compiled from, including identity blocks.
+    std::vector<const SparseMatrixBlock *> compiled_blocks_;
+    int dim_;
+
+    // Workspace.
+    Vec PZ_;
+    Vec TPZ_;
+    mutable Vec column_workspace_;
+  };
+
+}
+#endif// BOOM_STRUCTURED_KALMAN_FILTER_HPP
@@ -16,6 +16,7 @@
   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
 */
 
+#include <algorithm>
 #include <cassert>
 #include <cpputil/report_error.hpp>
 #include <Models/StateSpace/StateModels/Holiday.hpp>
@@ -41,6 +42,46 @@ namespace BOOM{
         && d <= latest_influence(holiday_date);
   }
 
+  //======================================================================
+  HolidayCalendar::HolidayCalendar(const Date &time_zero)
+      : time_zero_(time_zero),
+        number_of_time_points_(0)
+  {}
+
+  int HolidayCalendar::add_holiday(const boost::shared_ptr<Holiday> &holiday){
+    holidays_.push_back(holiday);
+    // The table layout depends on the number of holidays.
+    positions_.clear();
+    number_of_time_points_ = 0;
+    return holidays_.size() - 1;
+  }
+
+  void HolidayCalendar::set_time_zero(const Date &time_zero){
+    time_zero_ = time_zero;
+    positions_.clear();
+    number_of_time_points_ = 0;
+  }
+
+  int HolidayCalendar::compute_position(int which, int t)const{
+    const Holiday &holiday(*holidays_[which]);
+    Date now = time_zero_ + t;
+    if(!holiday.active(now)) return -1;
+    return now - holiday.earliest_influence(holiday.nearest(now));
+  }
+
+  void HolidayCalendar::extend(int t)const{
+    int new_size = std::max(t + 1, 2 * number_of_time_points_);
+    new_size = std::max(new_size, 366);
+    int number_of_holidays = holidays_.size();
+    positions_.resize(new_size * number_of_holidays);
+    for(int s = number_of_time_points_; s < new_size; ++s){
+      for(int h = 0; h < number_of_holidays; ++h){
+        positions_[s * number_of_holidays + h] = compute_position(h, s);
+      }
+    }
+    number_of_time_points_ = new_size;
+  }
+
   //======================================================================
 
   OrdinaryAnnualHoliday::OrdinaryAnnualHoliday(int days_before, int days_after)
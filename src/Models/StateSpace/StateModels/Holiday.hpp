@@ -20,6 +20,8 @@
 #define BOOM_HOLIDAY_HPP_
 
 #include <map>
+#include <vector>
+#include <boost/shared_ptr.hpp>
 #include <cpputil/Date.hpp>
 
 namespace BOOM{
@@ -81,6 +83,58 @@ namespace BOOM{
                                int days_before,
                                int days_after);
 
+  //======================================================================
+  // A HolidayCalendar maps integer time points (days since time_zero)
+  // to positions in the influence windows of a set of holidays.
+  // State models ask whether time t is in a holiday window once per
+  // time point per MCMC iteration, and answering that question from
+  // the Holiday involves several Date computations and map lookups.
+  // The calendar answers it once for each time point and stores the
+  // answer in a table, so later lookups are a single array read.
+  //
+  // The table is filled lazily, and grows (at least doubling) when a
+  // time point past its end is requested, so the number of time
+  // points need not be known in advance.  Negative time points are
+  // computed from the holiday directly and are not stored.  Because
+  // lookups can extend the table, a calendar should not be shared
+  // across threads.
+  class HolidayCalendar{
+   public:
+    explicit HolidayCalendar(const Date &time_zero);
+
+    // Adds a holiday to the calendar, and returns its index.
+    int add_holiday(const boost::shared_ptr<Holiday> &holiday);
+    int number_of_holidays()const{return holidays_.size();}
+    const Holiday *holiday(int which)const{return holidays_[which].get();}
+
+    const Date &time_zero()const{return time_zero_;}
+    void set_time_zero(const Date &time_zero);
+
+    // The position of time point t in the influence window of holiday
+    // 'which'.  The position is the number of days since the earliest
+    // influence of the nearest incidence of the holiday.  Returns -1
+    // if the holiday is not active at time t.
+    int position(int which, int t)const{
+      if(t < 0) return compute_position(which, t);
+      if(t >= number_of_time_points_) extend(t);
+      return positions_[t * holidays_.size() + which];
+    }
+
+    bool active(int which, int t)const{return position(which, t) >= 0;}
+
+   private:
+    int compute_position(int which, int t)const;
+    // Fills the table through at least time point t.
+    void extend(int t)const;
+
+    Date time_zero_;
+    std::vector<boost::shared_ptr<Holiday> > holidays_;
+    // Element t * number_of_holidays() + h is position(h, t), so the
+    // entries for a single time point are adjacent.
+    mutable std::vector<int> positions_;
+    mutable int number_of_time_points_;
+  };
+
   //======================================================================
   // An OrdinaryAnnualHoliday is a Holiday that occurs once per year,
   // with a fixed-sized window of influence.  An OrdinaryAnnualHoliday
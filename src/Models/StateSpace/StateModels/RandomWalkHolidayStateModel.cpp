@@ -24,8 +24,9 @@ namespace BOOM {
   typedef RandomWalkHolidayStateModel RWHSM;
   RWHSM::RandomWalkHolidayStateModel(Holiday *holiday, const Date &time_zero)
       : holiday_(holiday),
-        time_zero_(time_zero)
+        calendar_(time_zero)
   {
+    calendar_.add_holiday(holiday_);
     int dim = holiday->maximum_window_width();
     initial_state_mean_.resize(dim);
     initial_state_variance_.resize(dim);
@@ -43,11 +44,9 @@ namespace BOOM {
   void RWHSM::observe_state(const ConstVectorView then,
                             const ConstVectorView now,
                             int time_now){
-    Date today = time_zero_ + time_now;
-    if(holiday_->active(today)){
-      Date holiday_date = holiday_->nearest(today);
-      int position = today - holiday_->earliest_influence(holiday_date);
-      double delta = now[position] - then[position];
+    int pos = position(time_now);
+    if(pos >= 0){
+      double delta = now[pos] - then[pos];
       suf()->update_raw(delta);
     }
   }
@@ -57,13 +56,9 @@ namespace BOOM {
   }
 
   void RWHSM::simulate_state_error(VectorView eta, int t)const{
-    Date now = time_zero_ + t;
     eta = 0;
-    if(holiday_->active(now)){
-      Date holiday_date(holiday_->nearest(now));
-      int position = now - holiday_->earliest_influence(holiday_date);
-      eta[position] = rnorm(0, sigma());
-    }
+    int pos = position(t);
+    if(pos >= 0) eta[pos] = rnorm(0, sigma());
   }
 
   Ptr<SparseMatrixBlock>  RWHSM::state_transition_matrix(int t)const{
@@ -71,23 +66,15 @@ namespace BOOM {
   }
 
   Ptr<SparseMatrixBlock> RWHSM::state_variance_matrix(int t)const{
-    Date now = time_zero_ + t;
-    if(holiday_->active(now)){
-      Date holiday_date(holiday_->nearest(now));
-      int position = now - holiday_->earliest_influence(holiday_date);
-      return active_state_variance_matrix_[position];
-    }
+    int pos = position(t);
+    if(pos >= 0) return active_state_variance_matrix_[pos];
     return zero_state_variance_matrix_;
   }
 
   SparseVector RWHSM::observation_matrix(int t)const{
-    Date now = time_zero_ + t;
     SparseVector ans(state_dimension());
-    if(holiday_->active(now)){
-      Date holiday_date(holiday_->nearest(now));
-      int position = now - holiday_->earliest_influence(holiday_date);
-      ans[position] = 1.0;
-    }
+    int pos = position(t);
+    if(pos >= 0) ans[pos] = 1.0;
     return ans;
   }
 
@@ -115,7 +102,7 @@ namespace BOOM {
   }
 
   void RWHSM::set_time_zero(const Date &time_zero){
-    time_zero_ = time_zero;
+    calendar_.set_time_zero(time_zero);
   }
 
 }  // namespace BOOM
@@ -48,6 +48,9 @@ namespace BOOM {
   // the holiday influences).  The transition matrix is always the
   // identity.  The error variance matrix is sigma^2 * outer(e[t]),
   // where e[t] is column t of the identity matrix.
+  //
+  // The position of each time point in the holiday window is looked up
+  // in a HolidayCalendar, so it is only computed from Dates once.
   class RandomWalkHolidayStateModel :
       public StateModel,
       public ZeroMeanGaussianModel{
@@ -79,9 +82,13 @@ namespace BOOM {
 
     virtual void set_sigsq(double sigsq);
    private:
+    // Position of time t in the holiday window, or -1 if t is outside
+    // the window.
+    int position(int t)const{return calendar_.position(0, t);}
+
     // TODO(stevescott): Make this a unique_ptr once available.
     boost::shared_ptr<Holiday> holiday_;
-    Date time_zero_;
+    HolidayCalendar calendar_;
     Vec initial_state_mean_;
     Spd initial_state_variance_;
     Ptr<IdentityMatrix> identity_transition_matrix_;
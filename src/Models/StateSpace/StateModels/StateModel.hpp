@@ -76,6 +76,12 @@ namespace BOOM{
     virtual Ptr<SparseMatrixBlock> state_transition_matrix(int t)const = 0;
     virtual Ptr<SparseMatrixBlock> state_variance_matrix(int t)const = 0;
 
+    // Returns true if the two functions above can return the same
+    // block, with different contents, for different values of t.  The
+    // steady state shortcut in the Kalman filter identifies matrices by
+    // their blocks, so it is turned off for models where this is true.
+    virtual bool has_time_varying_blocks()const{return false;}
+
     //  For now, limit models to have constant observation matrices.
     //  This will prevent true DLM's with coefficients in the Kalman
     //  filter, because this is where the x's would go, but we'll need
@@ -325,4 +325,8 @@ namespace BOOM {
       StateModel::Behavior behavior){
     behavior_ = behavior;
   }
+
+  bool StudentLocalLinearTrendStateModel::has_time_varying_blocks()const{
+    return behavior_ == MIXTURE;
+  }
 }
@@ -95,6 +95,10 @@ namespace BOOM{
     // chi-square variables.
     virtual void set_behavior(StateModel::Behavior behavior);
 
+    // In MIXTURE mode the state variance matrix is rewritten for each
+    // t using the latent scale factors.
+    virtual bool has_time_varying_blocks()const;
+
     Ptr<UnivParams> SigsqLevel_prm();
     Ptr<UnivParams> NuLevel_prm();
     Ptr<UnivParams> SigsqSlope_prm();
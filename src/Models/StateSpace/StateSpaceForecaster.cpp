@@ -0,0 +1,237 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <Models/StateSpace/StateSpaceForecaster.hpp>
+#include <Models/StateSpace/StateSpaceRegressionModel.hpp>
+#include <distributions.hpp>
+#include <cpputil/report_error.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+
+namespace BOOM{
+
+  typedef StateSpaceForecaster SSF;
+
+  namespace {
+    // The same default as IQagent.
+    std::vector<double> default_probs(){
+      double probs[] = {.01, .025, .05, .10, .25, .5, .75, .9, .95, .975, .99};
+      return std::vector<double>(probs, probs + 11);
+    }
+  }  // namespace
+
+  SSF::StateSpaceForecaster(const Ptr<StateSpaceModelBase> &model,
+                            int horizon,
+                            const std::vector<double> &probs,
+                            int number_of_threads)
+      : model_(model),
+        horizon_(horizon),
+        time_zero_(model->time_dimension()),
+        probs_(probs.empty() ? default_probs() : probs),
+        block_size_(64),
+        number_of_paths_(0)
+  {
+    if(horizon < 1){
+      report_error("The forecast horizon must be positive in "
+                   "StateSpaceForecaster.");
+    }
+    std::sort(probs_.begin(), probs_.end());
+    set_number_of_threads(number_of_threads);
+  }
+
+  void SSF::add_draw(const Vec &parameters, const Vec &final_state){
+    if(final_state.size() != model_->state_dimension()){
+      report_error("The final state has the wrong dimension in "
+                   "StateSpaceForecaster::add_draw.");
+    }
+    parameters_.push_back(parameters);
+    final_states_.push_back(final_state);
+  }
+
+  void SSF::clear_draws(){
+    parameters_.clear();
+    final_states_.clear();
+  }
+
+  void SSF::set_predictors(const Mat &newX){
+    if(nrow(newX) != horizon_){
+      report_error("The predictor matrix must have one row per forecast "
+                   "period in StateSpaceForecaster::set_predictors.");
+    }
+    if(!dynamic_cast<StateSpaceRegressionModel *>(model_.get())){
+      report_error("Predictors can only be used with a "
+                   "StateSpaceRegressionModel in StateSpaceForecaster.");
+    }
+    predictors_ = newX;
+  }
+
+  void SSF::set_number_of_threads(int number_of_threads){
+    if(number_of_threads < 1){
+      report_error("The number of threads must be positive in "
+                   "StateSpaceForecaster.");
+    }
+    thread_pool_.set_number_of_threads(number_of_threads);
+    workers_.resize(number_of_threads);
+  }
+
+  void SSF::set_block_size(int block_size){
+    if(block_size < 1){
+      report_error("The block size must be positive in "
+                   "StateSpaceForecaster.");
+    }
+    block_size_ = block_size;
+  }
+
+  //----------------------------------------------------------------------
+  void SSF::forecast(){
+    if(dynamic_cast<StateSpaceRegressionModel *>(model_.get())
+       && nrow(predictors_) != horizon_){
+      report_error("Call set_predictors() before forecasting from a "
+                   "StateSpaceRegressionModel.");
+    }
+    quantile_agents_.assign(horizon_, IQagent(probs_, block_size_));
+    mean_.resize(horizon_);
+    mean_ = 0.0;
+    sum_of_squared_deviations_.resize(horizon_);
+    sum_of_squared_deviations_ = 0.0;
+    number_of_paths_ = 0;
+
+    int number_of_blocks = (number_of_draws() + block_size_ - 1) / block_size_;
+    block_rngs_ = rng_streams(seed_rng(), number_of_blocks);
+    // Each worker simulates with its own copy of the model, so setting
+    // parameters does not disturb other threads.  The copies are made
+    // afresh for each call, in case the model has changed.
+    for(int i = 0; i < workers_.size(); ++i) workers_[i].model.reset();
+    thread_pool_.parallel_for(
+        number_of_blocks, boost::bind(&SSF::simulate_block, this, _1, _2));
+    for(int t = 0; t < horizon_; ++t) quantile_agents_[t].update_cdf();
+  }
+
+  //----------------------------------------------------------------------
+  void SSF::simulate_block(int block, int worker_number){
+    Worker &worker(workers_[worker_number]);
+    if(!worker.model){
+      worker.model = model_->clone();
+      worker.model->set_state_model_behavior(StateModel::MARGINAL);
+    }
+    worker.paths.resize(block_size_, horizon_);
+    RNG &rng(block_rngs_[block]);
+    // State models draw their errors from the default RNG.
+    ThreadRngScope rng_scope(rng);
+    int begin = block * block_size_;
+    int end = std::min<int>(begin + block_size_, number_of_draws());
+    for(int draw = begin; draw < end; ++draw){
+      simulate_path(draw, *worker.model, worker.filter, rng,
+                    worker.paths.row(draw - begin));
+    }
+    add_paths(worker.paths, end - begin);
+  }
+
+  // Follows StateSpaceModel::simulate_forecast().
+  void SSF::simulate_path(int draw,
+                          StateSpaceModelBase &model,
+                          StructuredKalmanFilter &filter,
+                          RNG &rng,
+                          VectorView path)const{
+    model.unvectorize_params(parameters_[draw]);
+    const StateSpaceRegressionModel *regression =
+        dynamic_cast<const StateSpaceRegressionModel *>(&model);
+    Vec state = final_states_[draw];
+    for(int t = 0; t < horizon_; ++t){
+      int time = time_zero_ + t;
+      const SparseKalmanMatrix *T = model.state_transition_matrix(time - 1);
+      if(filter.compile(*T)){
+        filter.transition(state.data());
+      }else{
+        state = (*T) * state;
+      }
+      state += model.simulate_state_error(time - 1);
+      double y = rnorm_mt(rng,
+                          model.observation_matrix(time).dot(state),
+                          sqrt(model.observation_variance(time)));
+      if(regression){
+        y += regression->regression_model()->predict(predictors_.row(t));
+      }
+      path[t] = y;
+    }
+  }
+
+  // The block's mean and sum of squared deviations are computed in two
+  // passes over the block, and then merged with the running summaries
+  // using the pairwise update of Chan, Golub and LeVeque (1979).
+  void SSF::add_paths(const Mat &paths, int number_of_paths){
+    if(number_of_paths <= 0) return;
+    Vec block_mean(horizon_, 0.0);
+    Vec block_ssd(horizon_, 0.0);
+    for(int i = 0; i < number_of_paths; ++i){
+      for(int t = 0; t < horizon_; ++t) block_mean[t] += paths(i, t);
+    }
+    block_mean /= number_of_paths;
+    for(int i = 0; i < number_of_paths; ++i){
+      for(int t = 0; t < horizon_; ++t){
+        double deviation = paths(i, t) - block_mean[t];
+        block_ssd[t] += deviation * deviation;
+      }
+    }
+
+#ifndef NO_BOOST_THREADS
+    boost::mutex::scoped_lock lock(summary_mutex_);
+#endif
+    for(int i = 0; i < number_of_paths; ++i){
+      for(int t = 0; t < horizon_; ++t) quantile_agents_[t].add(paths(i, t));
+    }
+    double n = number_of_paths_;
+    double total = n + number_of_paths;
+    for(int t = 0; t < horizon_; ++t){
+      double delta = block_mean[t] - mean_[t];
+      mean_[t] += delta * number_of_paths / total;
+      sum_of_squared_deviations_[t] +=
+          block_ssd[t] + delta * delta * n * number_of_paths / total;
+    }
+    number_of_paths_ += number_of_paths;
+  }
+
+  //----------------------------------------------------------------------
+  Mat SSF::quantiles()const{
+    Mat ans(horizon_, probs_.size(), 0.0);
+    if(number_of_paths_ == 0) return ans;
+    for(int t = 0; t < quantile_agents_.size(); ++t){
+      for(int j = 0; j < probs_.size(); ++j){
+        ans(t, j) = quantile_agents_[t].quantile(probs_[j]);
+      }
+    }
+    return ans;
+  }
+
+  Vec SSF::mean()const{
+    Vec ans(horizon_, 0.0);
+    if(number_of_paths_ == 0) return ans;
+    ans = mean_;
+    return ans;
+  }
+
+  Vec SSF::standard_deviation()const{
+    Vec ans(horizon_, 0.0);
+    if(number_of_paths_ < 2) return ans;
+    for(int t = 0; t < horizon_; ++t){
+      ans[t] = sqrt(sum_of_squared_deviations_[t] / (number_of_paths_ - 1));
+    }
+    return ans;
+  }
+
+}
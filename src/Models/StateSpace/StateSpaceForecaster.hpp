@@ -0,0 +1,145 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_STATE_SPACE_FORECASTER_HPP_
+#define BOOM_STATE_SPACE_FORECASTER_HPP_
+
+#include <Models/StateSpace/StateSpaceModelBase.hpp>
+#include <stats/IQagent.hpp>
+#include <distributions/rng.hpp>
+#include <cpputil/ThreadPool.hpp>
+#ifndef NO_BOOST_THREADS
+#include <boost/thread/mutex.hpp>
+#endif
+#include <vector>
+
+namespace BOOM{
+
+  // Summarizes the posterior predictive distribution of a state space
+  // model over the next 'horizon' time periods, given stored posterior
+  // draws of the model parameters and the final state.
+  //
+  // Each draw simulates one future path, in the same way as
+  // StateSpaceModel::simulate_forecast().  Paths are simulated in
+  // blocks of draws on a ThreadPool.  Each worker in the pool uses its
+  // own clone of the model and applies the state transition with a
+  // StructuredKalmanFilter.  A finished block is folded into running
+  // summaries for each horizon and then discarded.  The summaries are
+  // an IQagent for quantiles, and a mean and sum of squared deviations
+  // that are merged block by block, so the variance does not lose
+  // precision when the level of the series is large relative to its
+  // spread.  Memory use is therefore proportional to the block size
+  // rather than to the number of draws.
+  //
+  // Each block of draws has its own stream of random numbers from
+  // rng_streams(), with a seed drawn when forecast() is called, so the
+  // simulated paths do not depend on the number of threads.  The
+  // summaries depend slightly on the order in which blocks finish.
+  class StateSpaceForecaster{
+   public:
+    // Args:
+    //   model:  The model the draws were taken from.  It supplies the
+    //     model structure and the time of the first forecast
+    //     (model->time_dimension()).
+    //   horizon:  The number of time periods to forecast.
+    //   probs:  The probabilities of the quantiles to report.  If
+    //     empty, IQagent's default set is used.
+    //   number_of_threads:  The number of threads to simulate with.
+    StateSpaceForecaster(const Ptr<StateSpaceModelBase> &model,
+                         int horizon,
+                         const std::vector<double> &probs =
+                         std::vector<double>(),
+                         int number_of_threads = 1);
+
+    // Adds a posterior draw.  'parameters' is model->vectorize_params()
+    // at the time of the draw, and 'final_state' is the state at the
+    // last observed time point.
+    void add_draw(const Vec &parameters, const Vec &final_state);
+    int number_of_draws()const{return parameters_.size();}
+    void clear_draws();
+
+    // If the model is a StateSpaceRegressionModel, the predictors for
+    // the forecast periods must be supplied, one row per period.
+    void set_predictors(const Mat &newX);
+
+    void set_number_of_threads(int number_of_threads);
+
+    // The number of draws simulated together before their paths are
+    // added to the summaries.
+    void set_block_size(int block_size);
+
+    // Simulates one path for each draw, and summarizes the paths.
+    // Summaries from an earlier call are discarded.
+    void forecast();
+
+    // Summaries of the paths simulated by the last call to forecast().
+    // Element t corresponds to t + 1 periods past the end of the
+    // data.
+    const std::vector<double> &probs()const{return probs_;}
+    // Row t is horizon t, column j is quantile probs()[j].
+    Mat quantiles()const;
+    Vec mean()const;
+    Vec standard_deviation()const;
+
+   private:
+    // The state used by one worker in thread_pool_.
+    struct Worker{
+      Ptr<StateSpaceModelBase> model;
+      StructuredKalmanFilter filter;
+      Mat paths;
+    };
+
+    // Simulates the draws in block number 'block' using the worker's
+    // model, and adds their paths to the summaries.  This is a task
+    // for thread_pool_.
+    void simulate_block(int block, int worker);
+    void simulate_path(int draw,
+                       StateSpaceModelBase &model,
+                       StructuredKalmanFilter &filter,
+                       RNG &rng,
+                       VectorView path)const;
+    void add_paths(const Mat &paths, int number_of_paths);
+
+    Ptr<StateSpaceModelBase> model_;
+    int horizon_;
+    int time_zero_;
+    std::vector<double> probs_;
+    Mat predictors_;
+
+    std::vector<Vec> parameters_;
+    std::vector<Vec> final_states_;
+
+    int block_size_;
+
+    // Summaries, one element per horizon.
+    std::vector<IQagent> quantile_agents_;
+    Vec mean_;
+    Vec sum_of_squared_deviations_;
+    int number_of_paths_;
+
+    ThreadPool thread_pool_;
+    std::vector<Worker> workers_;
+    // One RNG per block of draws.
+    std::vector<RNG> block_rngs_;
+#ifndef NO_BOOST_THREADS
+    boost::mutex summary_mutex_;
+#endif
+  };
+
+}
+#endif// BOOM_STATE_SPACE_FORECASTER_HPP_
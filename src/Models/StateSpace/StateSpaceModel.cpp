@@ -58,7 +58,12 @@ namespace BOOM{
         PriorPolicy(rhs),
         observation_model_(rhs.observation_model_->clone())
   {
+    // The base class registered the state models first.  Register
+    // the observation model first, as in the original, so that
+    // vectorize_params() gives the same layout for a clone.
+    ParamPolicy::clear();
     setup();
+    for(int s = 0; s < nstate(); ++s) ParamPolicy::add_model(state_model(s));
   }
 
   SSM * SSM::clone()const{return new SSM(*this);}
@@ -100,17 +105,12 @@ namespace BOOM{
     int t0 = time_dimension();
     for(int t = 0; t < n; ++t){
       ans(t,0) = observation_matrix(t+t0).dot(ks.a);
-      sparse_scalar_kalman_update(0,    // y is missing, so fill in a dummy value
-                                  ks.a,
-                                  ks.P,
-                                  ks.K,
-                                  ks.F,
-                                  ks.v,
-                                  true,  // forecasts are missing data
-                                  observation_matrix(t+t0),
-                                  observation_variance(t+t0),
-                                  *state_transition_matrix(t+t0),
-                                  *state_variance_matrix(t+t0));
+      kalman_update(0,  // y is missing, so fill in a dummy value
+                    ks.a,
+                    ks.P,
+                    ks,
+                    true,  // forecasts are missing data
+                    t+t0);
       ans(t,1) = sqrt(ks.F);
     }
     return ans;
@@ -121,10 +121,11 @@ namespace BOOM{
     Vec ans(n);
     int t0 = time_dimension();
     Vec state = final_state;
+    RNG &rng(default_rng());
     for(int t = 0; t < n; ++t) {
       state = simulate_next_state(state, t + t0);
-      ans[t] = rnorm(observation_matrix(t+t0).dot(state),
-                     sqrt(observation_variance(t+t0)));
+      ans[t] = rnorm_mt(rng, observation_matrix(t+t0).dot(state),
+                        sqrt(observation_variance(t+t0)));
     }
     return ans;
   }
@@ -136,9 +137,10 @@ namespace BOOM{
     int t0 = observed_data.size();
     ScalarKalmanStorage ks(filter_observed_data(observed_data));
     Vec state(rmvn(ks.a, ks.P));  //  this is state[t0], one after the final state
+    RNG &rng(default_rng());
     for(int t = 0; t < n; ++t){
-      ans[t] = rnorm(observation_matrix(t+t0).dot(state),
-                     sqrt(observation_variance(t+t0)));
+      ans[t] = rnorm_mt(rng, observation_matrix(t+t0).dot(state),
+                        sqrt(observation_variance(t+t0)));
       state = simulate_next_state(state, t + t0 + 1);
     }
     StateSpaceModelBase::set_state_model_behavior(StateModel::MIXTURE);
@@ -156,17 +158,12 @@ namespace BOOM{
     for(int t = 0; t < n; ++t){
       double y = observed_data[t];
       bool missing(y == BOOM::negative_infinity());
-      sparse_scalar_kalman_update(y,
-                                  ks.a,
-                                  ks.P,
-                                  ks.K,
-                                  ks.F,
-                                  ks.v,
-                                  missing,
-                                  observation_matrix(t0 + t),
-                                  observation_variance(t0 + t),
-                                  *state_transition_matrix(t0 + t),
-                                  *state_variance_matrix(t0 + t));
+      kalman_update(y,
+                    ks.a,
+                    ks.P,
+                    ks,
+                    missing,
+                    t0 + t);
     }
     return ks;
   }
@@ -181,17 +178,12 @@ namespace BOOM{
     ks.P = Spd(state_variance_matrix(t0-1)->dense());
     for(int t = 0; t < ans.size(); ++t){
       bool missing = false;
-      sparse_scalar_kalman_update(newY[t],
-                                  ks.a,
-                                  ks.P,
-                                  ks.K,
-                                  ks.F,
-                                  ks.v,
-                                  missing,
-                                  observation_matrix(t + t0),
-                                  observation_variance(t+t0),
-                                  *state_transition_matrix(t+t0),
-                                  *state_variance_matrix(t+t0));
+      kalman_update(newY[t],
+                    ks.a,
+                    ks.P,
+                    ks,
+                    missing,
+                    t + t0);
       ans[t] = ks.v;
     }
     return ans;
@@ -36,8 +36,10 @@ namespace BOOM{
         mcmc_kalman_storage_is_current_(false),
         pedantic_(true),
         kalman_filter_is_current_(false),
+        filtered_time_dimension_(0),
         default_state_transition_matrix_(new BlockDiagonalMatrix),
-        default_state_variance_matrix_(new BlockDiagonalMatrix)
+        default_state_variance_matrix_(new BlockDiagonalMatrix),
+        steady_state_tolerance_(0)
   {}
 
   //----------------------------------------------------------------------
@@ -50,8 +52,10 @@ namespace BOOM{
         mcmc_kalman_storage_is_current_(false),
         pedantic_(rhs.pedantic_),
         kalman_filter_is_current_(false),
+        filtered_time_dimension_(0),
         default_state_transition_matrix_(new BlockDiagonalMatrix),
-        default_state_variance_matrix_(new BlockDiagonalMatrix)
+        default_state_variance_matrix_(new BlockDiagonalMatrix),
+        steady_state_tolerance_(rhs.steady_state_tolerance_)
   {
     for(int s = 0; s < rhs.nstate(); ++s) {
       add_state(rhs.state_model(s)->clone());
@@ -122,27 +126,24 @@ namespace BOOM{
         simulate_initial_state(state_.col(0));
         a_ = initial_state_mean();
         P_ = initial_state_variance();
+        steady_state_.reset(steady_state_tolerance_);
         if(!use_shortcut){
           supplemental_a_ = a_;
           supplemental_P_ = P_;
+          supplemental_steady_state_.reset(steady_state_tolerance_);
         }
       }else{
         simulate_next_state(state_.col(t-1), state_.col(t), t);
       }
       double y_sim = simulate_adjusted_observation(t);
       double ystar = use_shortcut ? adjusted_observation(t) - y_sim : y_sim;
-      sparse_scalar_kalman_update(
-          ystar,
-          a_,
-          P_,
-          kalman_storage_[t].K,
-          kalman_storage_[t].F,
-          kalman_storage_[t].v,
-          is_missing_observation(t),
-          observation_matrix(t),
-          observation_variance(t),
-          *state_transition_matrix(t),
-          *state_variance_matrix(t));
+      kalman_update(ystar,
+                    a_,
+                    P_,
+                    kalman_storage_[t],
+                    is_missing_observation(t),
+                    t,
+                    &steady_state_);
       if(!use_shortcut){
         ////////////////////////
         // TODO(stevescott): The actual one step ahead prediction
@@ -150,18 +151,13 @@ namespace BOOM{
         // and not kalman_storage_.  We should eventually get rid of
         // the 'use_shortcut' option and keep the prediction errors in
         // the right place.
-        sparse_scalar_kalman_update(
-            adjusted_observation(t),
-            supplemental_a_,
-            supplemental_P_,
-            supplemental_kalman_storage_[t].K,
-            supplemental_kalman_storage_[t].F,
-            supplemental_kalman_storage_[t].v,
-            is_missing_observation(t),
-            observation_matrix(t),
-            observation_variance(t),
-            (*state_transition_matrix(t)),
-            (*state_variance_matrix(t)));
+        kalman_update(adjusted_observation(t),
+                      supplemental_a_,
+                      supplemental_P_,
+                      supplemental_kalman_storage_[t],
+                      is_missing_observation(t),
+                      t,
+                      &supplemental_steady_state_);
       }
       // The Kalman update sets a_ to a[t+1] and P to P[t+1], so they
       // will be current for the next iteration.
@@ -290,7 +286,7 @@ namespace BOOM{
     Vec errors(n);
     if(n==0) return errors;
 
-    if (mcmc_kalman_storage_is_current_) {
+    if (mcmc_kalman_storage_is_current_ && ncol(state_) == n) {
       for (int i = 0; i < n; ++i) {
         // TODO(stevescott): Clean up this hack by making sure the one
         // step prediction errors are stored in kalman_storage_
@@ -301,27 +297,48 @@ namespace BOOM{
     }
     initialize_final_kalman_storage();
     ScalarKalmanStorage &ks(final_kalman_storage_);
+    steady_state_.reset(steady_state_tolerance_);
 
     for(int i = 0; i < n; ++i){
       double resid = adjusted_observation(i);
       bool missing = is_missing_observation(i);
-      loglike_ += sparse_scalar_kalman_update(resid,
-                                              ks.a,
-                                              ks.P,
-                                              ks.K,
-                                              ks.F,
-                                              ks.v,
-                                              missing,
-                                              observation_matrix(i),
-                                              observation_variance(i),
-                                              (*state_transition_matrix(i)),
-                                              (*state_variance_matrix(i)));
+      loglike_ += kalman_update(resid,
+                                ks.a,
+                                ks.P,
+                                ks,
+                                missing,
+                                i,
+                                &steady_state_);
       errors[i] = ks.v;
     }
     kalman_filter_is_current_ = true;
+    filtered_time_dimension_ = n;
     return errors;
   }
 
+  //----------------------------------------------------------------------
+  double SSMB::kalman_update(double y,
+                             Vec &a,
+                             Spd &P,
+                             LightKalmanStorage &storage,
+                             bool missing,
+                             int t,
+                             KalmanSteadyState *steady_state)const{
+    if(steady_state && has_time_varying_blocks()) steady_state = 0;
+    return structured_filter_.update(y,
+                                     a,
+                                     P,
+                                     storage.K,
+                                     storage.F,
+                                     storage.v,
+                                     missing,
+                                     observation_matrix(t),
+                                     observation_variance(t),
+                                     *state_transition_matrix(t),
+                                     *state_variance_matrix(t),
+                                     steady_state);
+  }
+
   //----------------------------------------------------------------------
   void SSMB::clear_client_data(){
     observation_model()->clear_data();
@@ -389,6 +406,20 @@ namespace BOOM{
   //----------------------------------------------------------------------
   int SSMB::state_dimension()const{return state_dimension_;}
 
+  //----------------------------------------------------------------------
+  bool SSMB::has_time_varying_blocks()const{
+    for(int s = 0; s < state_models_.size(); ++s){
+      if(state_models_[s]->has_time_varying_blocks()) return true;
+    }
+    return false;
+  }
+
+  //----------------------------------------------------------------------
+  void SSMB::set_steady_state_tolerance(double tolerance){
+    steady_state_tolerance_ = tolerance;
+    kalman_filter_is_not_current();
+  }
+
   //----------------------------------------------------------------------
   double SSMB::loglike()const{
     filter();
@@ -397,32 +428,42 @@ namespace BOOM{
 
   //----------------------------------------------------------------------
   const ScalarKalmanStorage & SSMB::filter()const{
-    if(kalman_filter_is_current_) return final_kalman_storage_;
-    loglike_ = 0;
-    initialize_final_kalman_storage();
     int n = time_dimension();
+    int start = 0;
+    if(kalman_filter_is_current_){
+      if(filtered_time_dimension_ == n) return final_kalman_storage_;
+      // If data have been appended, pick up where the last run left
+      // off.
+      if(filtered_time_dimension_ < n) start = filtered_time_dimension_;
+    }
+    if(start == 0){
+      loglike_ = 0;
+      initialize_final_kalman_storage();
+    }
     if(n==0) return final_kalman_storage_;
     ScalarKalmanStorage &ks(final_kalman_storage_);
+    steady_state_.reset(steady_state_tolerance_);
 
-    for(int i = 0; i < n; ++i){
+    for(int i = start; i < n; ++i){
       double resid = adjusted_observation(i);
       bool missing = is_missing_observation(i);
-      loglike_ += sparse_scalar_kalman_update(resid,
-                                              ks.a,
-                                              ks.P,
-                                              ks.K,
-                                              ks.F,
-                                              ks.v,
-                                              missing,
-                                              observation_matrix(i),
-                                              observation_variance(i),
-                                              (*state_transition_matrix(i)),
-                                              (*state_variance_matrix(i)));
+      loglike_ += kalman_update(resid,
+                                ks.a,
+                                ks.P,
+                                ks,
+                                missing,
+                                i,
+                                &steady_state_);
     }
     kalman_filter_is_current_ = true;
+    filtered_time_dimension_ = n;
     return final_kalman_storage_;
   }
 
+  int SSMB::filtered_time_dimension()const{
+    return kalman_filter_is_current_ ? filtered_time_dimension_ : 0;
+  }
+
   //----------------------------------------------------------------------
   Vec SSMB::simulate_initial_state()const{
     Vec ans(state_dimension_);
@@ -21,6 +21,7 @@
 #include <Models/StateSpace/Filters/SparseVector.hpp>
 #include <Models/StateSpace/Filters/SparseMatrix.hpp>
 #include <Models/StateSpace/Filters/ScalarKalmanStorage.hpp>
+#include <Models/StateSpace/Filters/StructuredKalmanFilter.hpp>
 #include <Models/Policies/CompositeParamPolicy.hpp>
 #include <LinAlg/Matrix.hpp>
 #include <LinAlg/Vector.hpp>
@@ -128,8 +129,23 @@ namespace BOOM{
 
     // filter() evaluates log likelihood and computes the final values
     // a[t+1] and P[t+1] needed for future forecasting.
+    //
+    // If observations have been appended (with add_data) since the
+    // last call, and the parameters have not changed, the filter is
+    // extended from the stored a and P over the new observations
+    // instead of being rerun from t = 0.  So loglike() and forecasts
+    // after adding one observation cost one filter step.  Changing
+    // existing observations in place is not detected; call
+    // clear_filter() afterwards.
     const ScalarKalmanStorage & filter()const;
 
+    // The number of time points covered by the stored output of
+    // filter().  Zero if the stored output is out of date.
+    int filtered_time_dimension()const;
+
+    // Forces the next call to filter() to start from t = 0.
+    void clear_filter(){kalman_filter_is_not_current();}
+
     virtual void simulate_initial_state(VectorView v)const;
     virtual Vec simulate_initial_state()const;
 
@@ -185,6 +201,17 @@ namespace BOOM{
 
     void be_pedantic(bool tf){pedantic_ = tf;}
 
+    // Once P has converged (changes by less than 'tolerance' times its
+    // largest diagonal element between consecutive time points with
+    // the same model matrices), the Kalman filter switches to a fixed
+    // gain update that costs O(state_dimension()) per time point.  The
+    // full update resumes at missing observations and wherever the
+    // model matrices change.  See KalmanSteadyState.  A non-positive
+    // tolerance (the default) turns the shortcut off.  The shortcut is
+    // never used if a state model has time varying blocks (see
+    // StateModel::has_time_varying_blocks).
+    void set_steady_state_tolerance(double tolerance);
+
     // Sets the behavior of all client state models to 'behavior.'
     void set_state_model_behavior(StateModel::Behavior behavior);
 
@@ -195,8 +222,28 @@ namespace BOOM{
     // analysis.
     void permanently_set_state(const Mat &m);
     void observe_fixed_state();
+
+   protected:
+    // One step of the Kalman filter for time t, using the model
+    // matrices for time t.  Updates a and P from a[t], P[t] to
+    // a[t+1], P[t+1], fills K, F, and v in 'storage', and returns the
+    // log likelihood contribution of y.  See
+    // sparse_scalar_kalman_update for details.  If 'steady_state' is
+    // non-NULL it must have been reset at the start of the filter pass,
+    // and the steady state shortcut is used once P converges.
+    double kalman_update(double y,
+                         Vec &a,
+                         Spd &P,
+                         LightKalmanStorage &storage,
+                         bool missing,
+                         int t,
+                         KalmanSteadyState *steady_state = 0)const;
+
    private:
     void check_kalman_storage(std::vector<LightKalmanStorage> &);
+    // Returns true if any state model has time varying blocks, in
+    // which case the steady state shortcut cannot be used.
+    bool has_time_varying_blocks()const;
     void initialize_final_kalman_storage()const;
     void kalman_filter_is_not_current(){
       kalman_filter_is_current_ = false;
@@ -260,12 +307,24 @@ namespace BOOM{
     mutable ScalarKalmanStorage final_kalman_storage_;
     mutable double loglike_;
     mutable bool kalman_filter_is_current_;
+    // The number of observations summarized by final_kalman_storage_
+    // and loglike_.
+    mutable int filtered_time_dimension_;
 
     mutable boost::scoped_ptr<BlockDiagonalMatrix>
     default_state_transition_matrix_;
 
     mutable boost::scoped_ptr<BlockDiagonalMatrix>
     default_state_variance_matrix_;
+
+    // Workspace and compiled transition schedule for kalman_update().
+    mutable StructuredKalmanFilter structured_filter_;
+
+    // Convergence monitors for the steady state shortcut, one for each
+    // pass of the filter that can be running at once.
+    double steady_state_tolerance_;
+    mutable KalmanSteadyState steady_state_;
+    mutable KalmanSteadyState supplemental_steady_state_;
   };
 }
 
@@ -0,0 +1,498 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <Models/StateSpace/StateSpaceModelBatch.hpp>
+#include <distributions.hpp>
+#include <cpputil/report_error.hpp>
+#include <LinAlg/SubMatrix.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <algorithm>
+#include <cstring>
+#include <typeinfo>
+#include <sstream>
+
+namespace BOOM{
+
+  typedef StateSpaceModelBatch SSMBatch;
+
+  namespace {
+    // The kinds of transition blocks that are applied to every series
+    // in a block at once.  Everything else is GENERIC, and is applied
+    // series by series.
+    enum BlockKind { IDENTITY, LOCAL_LINEAR_TREND, SEASONAL, GENERIC };
+
+    BlockKind classify(const SparseMatrixBlock *block){
+      if(dynamic_cast<const IdentityMatrix *>(block)) return IDENTITY;
+      if(dynamic_cast<const LocalLinearTrendMatrix *>(block)){
+        return LOCAL_LINEAR_TREND;
+      }
+      if(dynamic_cast<const SeasonalStateSpaceMatrix *>(block)){
+        return SEASONAL;
+      }
+      return GENERIC;
+    }
+
+    // Returns true if 'block' can only have nonzero elements on its
+    // diagonal, so that adding it to a matrix only touches the
+    // diagonal.
+    bool is_diagonal(const SparseMatrixBlock *block){
+      return dynamic_cast<const UpperLeftCornerMatrix *>(block)
+          || dynamic_cast<const DiagonalMatrixBlock *>(block)
+          || dynamic_cast<const ConstantMatrix *>(block)
+          || dynamic_cast<const IdentityMatrix *>(block)
+          || dynamic_cast<const SingleSparseDiagonalElementMatrix *>(block)
+          || dynamic_cast<const UpperLeftDiagonalMatrix *>(block);
+    }
+
+    struct ScheduleEntry{
+      BlockKind kind;
+      int block;
+      int offset;
+      int size;
+    };
+
+    void call_impute_state(StateSpaceModelBase *model){
+      model->impute_state();
+    }
+    void call_sample_posterior(StateSpaceModelBase *model){
+      model->sample_posterior();
+    }
+
+    // Stable sort of model indices by time dimension.
+    struct ShorterSeries{
+      ShorterSeries(const std::vector<Ptr<StateSpaceModelBase> > &models)
+          : models_(models){}
+      bool operator()(int i, int j)const{
+        return models_[i]->time_dimension() < models_[j]->time_dimension();
+      }
+      const std::vector<Ptr<StateSpaceModelBase> > &models_;
+    };
+  }  // namespace
+
+  //======================================================================
+  // Lock-step filter storage for one block of series.  'width' is the
+  // number of series.  Element i of lane (series) s of a vector
+  // quantity is stored at [i * width + s].  Element (i, j) of lane s
+  // of P is stored at [(j * dim + i) * width + s].
+  struct SSMBatch::Workspace{
+    void resize(int state_dimension, int number_of_series){
+      dim = state_dimension;
+      width = number_of_series;
+      a.assign(dim * width, 0.0);
+      P.assign(dim * dim * width, 0.0);
+      Z.assign(dim * width, 0.0);
+      PZ.assign(dim * width, 0.0);
+      TPZ.assign(dim * width, 0.0);
+      K.assign(dim * width, 0.0);
+      F.assign(width, 0.0);
+      v.assign(width, 0.0);
+      y.assign(width, 0.0);
+      H.assign(width, 0.0);
+      mu.assign(width, 0.0);
+      gain_scale.assign(width, 0.0);
+      lane_buffer.assign(dim * width, 0.0);
+      loglike.assign(width, 0.0);
+      missing.assign(width, 0);
+      active.assign(width, 0);
+      transition.assign(width, 0);
+      variance.assign(width, 0);
+      nonzero_z.assign(dim, 0);
+    }
+
+    // Replace x with T * x, for every series at once.  Element e of
+    // lane s of x is at x[e * width + s].
+    void apply_transition(double *x){
+      apply_structured_blocks(x, width);
+      apply_generic_blocks(x, width);
+    }
+
+    // Apply the blocks that are handled for all lanes at once.
+    // Element e of lane l of x is at x[e * lanes + l], for l in [0,
+    // lanes), so the elements of a block are contiguous.  The lanes
+    // need not all be series: the second half of the sandwich product
+    // uses one lane for each (row, series) pair.
+    void apply_structured_blocks(double *x, int lanes){
+      for(int k = 0; k < schedule.size(); ++k){
+        const ScheduleEntry &entry(schedule[k]);
+        double *first = x + entry.offset * lanes;
+        if(entry.kind == LOCAL_LINEAR_TREND){
+          double *level = first;
+          const double *slope = first + lanes;
+          for(int l = 0; l < lanes; ++l) level[l] += slope[l];
+        }else if(entry.kind == SEASONAL){
+          // The first element becomes minus the sum of the elements,
+          // and the others shift down one place.
+          double *total = &lane_buffer[0];
+          for(int l = 0; l < lanes; ++l) total[l] = -first[l];
+          for(int i = 1; i < entry.size; ++i){
+            const double *element = first + i * lanes;
+            for(int l = 0; l < lanes; ++l) total[l] -= element[l];
+          }
+          std::memmove(first + lanes, first,
+                       (entry.size - 1) * lanes * sizeof(double));
+          std::memcpy(first, total, lanes * sizeof(double));
+        }
+      }
+    }
+
+    // Apply the remaining blocks one series at a time, through their
+    // virtual methods.
+    void apply_generic_blocks(double *x, int stride){
+      for(int k = 0; k < schedule.size(); ++k){
+        const ScheduleEntry &entry(schedule[k]);
+        if(entry.kind != GENERIC) continue;
+        double *first = x + entry.offset * stride;
+        for(int s = 0; s < width; ++s){
+          if(!active[s]) continue;
+          transition[s]->block(entry.block)->multiply_inplace(
+              VectorView(first + s, entry.size, stride));
+        }
+      }
+    }
+
+    // P = T * P * T.transpose()
+    void sandwich(){
+      for(int j = 0; j < dim; ++j) apply_transition(&P[j * dim * width]);
+      // Right multiplication by T.transpose() applies T to each row of
+      // P.  Treating the (row, series) pairs as lanes lets the
+      // structured blocks work on whole columns at once.
+      apply_structured_blocks(&P[0], dim * width);
+      for(int i = 0; i < dim; ++i) apply_generic_blocks(&P[i * width], dim * width);
+    }
+
+    // Add lane s of RQR to lane s of P.
+    void add_state_variance(int s){
+      const BlockDiagonalMatrix *block_diagonal =
+          dynamic_cast<const BlockDiagonalMatrix *>(variance[s]);
+      if(!block_diagonal){
+        Mat &dense(dense_variance_scratch);
+        if(dense.nrow() != dim) dense = Mat(dim, dim);
+        dense = 0.0;
+        variance[s]->add_to(dense);
+        scatter(dense, 0, s);
+        return;
+      }
+      if(variance_scratch.size() < block_diagonal->nblocks()){
+        variance_scratch.resize(block_diagonal->nblocks());
+      }
+      int offset = 0;
+      for(int b = 0; b < block_diagonal->nblocks(); ++b){
+        const SparseMatrixBlock *block = block_diagonal->block(b);
+        int size = block->nrow();
+        // Scratch matrices are kept at zero between uses.
+        Mat &scratch(variance_scratch[b]);
+        if(scratch.nrow() != size) scratch = Mat(size, size, 0.0);
+        block->add_to(SubMatrix(scratch));
+        if(is_diagonal(block)){
+          for(int i = 0; i < size; ++i){
+            P[((offset + i) * dim + offset + i) * width + s] += scratch(i, i);
+            scratch(i, i) = 0;
+          }
+        }else{
+          scatter(scratch, offset, s);
+          scratch = 0.0;
+        }
+        offset += size;
+      }
+    }
+
+    void scatter(const Mat &m, int offset, int s){
+      int size = m.nrow();
+      for(int j = 0; j < size; ++j){
+        for(int i = 0; i < size; ++i){
+          double value = m(i, j);
+          if(value != 0){
+            P[((offset + j) * dim + offset + i) * width + s] += value;
+          }
+        }
+      }
+    }
+
+    int dim;
+    int width;
+    std::vector<double> a, P, Z, PZ, TPZ, K;
+    std::vector<double> F, v, y, H, mu, gain_scale, lane_buffer, loglike;
+    std::vector<int> missing;
+    std::vector<int> active;
+    std::vector<const BlockDiagonalMatrix *> transition;
+    std::vector<const SparseKalmanMatrix *> variance;
+    std::vector<int> nonzero_z;
+    std::vector<ScheduleEntry> schedule;
+    std::vector<Mat> variance_scratch;
+    Mat dense_variance_scratch;
+  };
+
+  //======================================================================
+  SSMBatch::StateSpaceModelBatch(int number_of_threads, int block_size)
+      : block_size_(1)
+  {
+    set_number_of_threads(number_of_threads);
+    set_block_size(block_size);
+  }
+
+  void SSMBatch::add_model(const Ptr<StateSpaceModelBase> &model){
+    if(!models_.empty()) check_structure(*model);
+    models_.push_back(model);
+    rngs_.push_back(RNG(seed_rng()));
+  }
+
+  int SSMBatch::number_of_models()const{return models_.size();}
+
+  Ptr<StateSpaceModelBase> SSMBatch::model(int i){return models_[i];}
+
+  void SSMBatch::set_number_of_threads(int number_of_threads){
+    if(number_of_threads < 1){
+      report_error("The number of threads must be positive in "
+                   "StateSpaceModelBatch.");
+    }
+    thread_pool_.set_number_of_threads(number_of_threads);
+    while(workspaces_.size() < number_of_threads){
+      workspaces_.push_back(boost::shared_ptr<Workspace>(new Workspace));
+    }
+  }
+
+  void SSMBatch::set_block_size(int block_size){
+    if(block_size < 1){
+      report_error("The block size must be positive in "
+                   "StateSpaceModelBatch.");
+    }
+    block_size_ = block_size;
+  }
+
+  void SSMBatch::check_structure(const StateSpaceModelBase &model)const{
+    const StateSpaceModelBase &reference(*models_[0]);
+    bool ok = model.state_dimension() == reference.state_dimension()
+        && model.nstate() == reference.nstate();
+    for(int s = 0; ok && s < model.nstate(); ++s){
+      const StateModel &lhs(*model.state_model(s));
+      const StateModel &rhs(*reference.state_model(s));
+      ok = typeid(lhs) == typeid(rhs)
+          && lhs.state_dimension() == rhs.state_dimension();
+    }
+    if(!ok){
+      report_error("All models in a StateSpaceModelBatch must have the "
+                   "same state models, in the same order.");
+    }
+  }
+
+  //----------------------------------------------------------------------
+  Vec SSMBatch::loglike(){
+    int n = models_.size();
+    loglike_.resize(n);
+    order_.resize(n);
+    for(int i = 0; i < n; ++i) order_[i] = i;
+    std::stable_sort(order_.begin(), order_.end(), ShorterSeries(models_));
+    int number_of_blocks = (n + block_size_ - 1) / block_size_;
+    run_jobs(number_of_blocks,
+             boost::bind(&SSMBatch::filter_block, this, _1, _2));
+    return loglike_;
+  }
+
+  void SSMBatch::impute_state(){
+    run_jobs(models_.size(),
+             boost::bind(&SSMBatch::run_model, this, _1, &call_impute_state));
+  }
+
+  void SSMBatch::sample_posterior(){
+    run_jobs(models_.size(),
+             boost::bind(&SSMBatch::run_model, this, _1,
+                         &call_sample_posterior));
+  }
+
+  void SSMBatch::run_model(int i, void (*f)(StateSpaceModelBase *)){
+    ThreadRngScope rng_scope(rngs_[i]);
+    f(models_[i].get());
+  }
+
+  //----------------------------------------------------------------------
+  void SSMBatch::filter_block(int block, Workspace &ws){
+    int begin = block * block_size_;
+    int end = std::min<int>(begin + block_size_, models_.size());
+    int width = end - begin;
+    int dim = models_[order_[begin]]->state_dimension();
+    ws.resize(dim, width);
+    std::vector<StateSpaceModelBase *> lane(width);
+    std::vector<int> time_dimension(width);
+    int max_time = 0;
+    for(int s = 0; s < width; ++s){
+      lane[s] = models_[order_[begin + s]].get();
+      time_dimension[s] = lane[s]->time_dimension();
+      max_time = std::max(max_time, time_dimension[s]);
+      Vec a0 = lane[s]->initial_state_mean();
+      Spd P0 = lane[s]->initial_state_variance();
+      for(int j = 0; j < dim; ++j){
+        ws.a[j * width + s] = a0[j];
+        for(int i = 0; i < dim; ++i) ws.P[(j * dim + i) * width + s] = P0(i, j);
+      }
+    }
+
+    for(int t = 0; t < max_time; ++t){
+      //--- Collect the model matrices for time t.
+      int reference = -1;
+      for(int s = 0; s < width; ++s){
+        ws.active[s] = t < time_dimension[s];
+        for(int i = 0; i < dim; ++i) ws.Z[i * width + s] = 0;
+        if(!ws.active[s]){
+          ws.y[s] = 0;
+          ws.H[s] = 1.0;
+          ws.missing[s] = 1;
+          ws.transition[s] = 0;
+          ws.variance[s] = 0;
+          continue;
+        }
+        if(reference < 0) reference = s;
+        StateSpaceModelBase *model = lane[s];
+        ws.missing[s] = model->is_missing_observation(t);
+        ws.y[s] = ws.missing[s] ? 0 : model->adjusted_observation(t);
+        ws.H[s] = model->observation_variance(t);
+        model->observation_matrix(t).add_this_to(
+            VectorView(&ws.Z[s], dim, width), 1.0);
+        ws.transition[s] = dynamic_cast<const BlockDiagonalMatrix *>(
+            model->state_transition_matrix(t));
+        if(!ws.transition[s]){
+          report_error("StateSpaceModelBatch requires block diagonal "
+                       "state transition matrices.");
+        }
+        ws.variance[s] = model->state_variance_matrix(t);
+      }
+
+      //--- Build the schedule for this time step.  A block is handled
+      //--- for all series at once if it has the same kind in every
+      //--- series.
+      ws.schedule.clear();
+      const BlockDiagonalMatrix *T0 = ws.transition[reference];
+      int offset = 0;
+      for(int b = 0; b < T0->nblocks(); ++b){
+        ScheduleEntry entry;
+        entry.kind = classify(T0->block(b));
+        entry.block = b;
+        entry.offset = offset;
+        entry.size = T0->block(b)->nrow();
+        offset += entry.size;
+        for(int s = reference + 1; s < width; ++s){
+          if(!ws.active[s]) continue;
+          const BlockDiagonalMatrix *T = ws.transition[s];
+          if(T->nblocks() != T0->nblocks()
+             || T->block(b)->nrow() != entry.size){
+            report_error("Transition matrices have different block "
+                         "structures in StateSpaceModelBatch.");
+          }
+          if(classify(T->block(b)) != entry.kind) entry.kind = GENERIC;
+        }
+        if(entry.kind != IDENTITY) ws.schedule.push_back(entry);
+      }
+
+      //--- Forecast variance: F = Z'PZ + H.
+      for(int j = 0; j < dim; ++j){
+        ws.nonzero_z[j] = 0;
+        for(int s = 0; s < width; ++s){
+          if(ws.Z[j * width + s] != 0){
+            ws.nonzero_z[j] = 1;
+            break;
+          }
+        }
+      }
+      std::fill(ws.PZ.begin(), ws.PZ.end(), 0.0);
+      for(int s = 0; s < width; ++s){
+        ws.F[s] = ws.H[s];
+        ws.mu[s] = 0;
+      }
+      for(int j = 0; j < dim; ++j){
+        if(!ws.nonzero_z[j]) continue;
+        const double *z = &ws.Z[j * width];
+        const double *a = &ws.a[j * width];
+        for(int s = 0; s < width; ++s) ws.mu[s] += z[s] * a[s];
+        for(int i = 0; i < dim; ++i){
+          const double *p = &ws.P[(j * dim + i) * width];
+          double *pz = &ws.PZ[i * width];
+          for(int s = 0; s < width; ++s) pz[s] += p[s] * z[s];
+        }
+      }
+      for(int j = 0; j < dim; ++j){
+        if(!ws.nonzero_z[j]) continue;
+        const double *z = &ws.Z[j * width];
+        const double *pz = &ws.PZ[j * width];
+        for(int s = 0; s < width; ++s) ws.F[s] += z[s] * pz[s];
+      }
+
+      //--- Forecast errors, log likelihood, and Kalman gain.
+      for(int s = 0; s < width; ++s){
+        if(ws.active[s] && ws.F[s] <= 0){
+          std::ostringstream err;
+          err << "Found a zero forecast variance in StateSpaceModelBatch "
+              << "at time " << t << "." << endl;
+          report_error(err.str());
+        }
+        if(ws.missing[s]){
+          ws.v[s] = 0;
+          ws.gain_scale[s] = 0;
+        }else{
+          ws.v[s] = ws.y[s] - ws.mu[s];
+          ws.gain_scale[s] = 1.0 / ws.F[s];
+          ws.loglike[s] += dnorm(ws.y[s], ws.mu[s], sqrt(ws.F[s]), true);
+        }
+      }
+      ws.TPZ = ws.PZ;
+      ws.apply_transition(&ws.TPZ[0]);
+      for(int i = 0; i < dim; ++i){
+        const double *tpz = &ws.TPZ[i * width];
+        double *k = &ws.K[i * width];
+        for(int s = 0; s < width; ++s) k[s] = tpz[s] * ws.gain_scale[s];
+      }
+
+      //--- a = T * a + K * v
+      ws.apply_transition(&ws.a[0]);
+      for(int i = 0; i < dim; ++i){
+        const double *k = &ws.K[i * width];
+        double *a = &ws.a[i * width];
+        for(int s = 0; s < width; ++s) a[s] += k[s] * ws.v[s];
+      }
+
+      //--- P = T * P * T' - T * P * Z * K' + RQR
+      ws.sandwich();
+      for(int j = 0; j < dim; ++j){
+        const double *k = &ws.K[j * width];
+        for(int i = 0; i < dim; ++i){
+          const double *tpz = &ws.TPZ[i * width];
+          double *p = &ws.P[(j * dim + i) * width];
+          for(int s = 0; s < width; ++s) p[s] -= tpz[s] * k[s];
+        }
+      }
+      for(int s = 0; s < width; ++s){
+        if(ws.active[s]) ws.add_state_variance(s);
+      }
+    }
+
+    for(int s = 0; s < width; ++s) loglike_[order_[begin + s]] = ws.loglike[s];
+  }
+
+  //----------------------------------------------------------------------
+  void SSMBatch::run_jobs(int number_of_jobs,
+                          const boost::function<void(int, Workspace &)> &job){
+    thread_pool_.parallel_for(
+        number_of_jobs,
+        boost::bind(&SSMBatch::run_job, this, boost::cref(job), _1, _2));
+  }
+
+  void SSMBatch::run_job(const boost::function<void(int, Workspace &)> &job,
+                         int i, int worker){
+    job(i, *workspaces_[worker]);
+  }
+
+}
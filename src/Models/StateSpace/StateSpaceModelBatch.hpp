@@ -0,0 +1,127 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_STATE_SPACE_MODEL_BATCH_HPP_
+#define BOOM_STATE_SPACE_MODEL_BATCH_HPP_
+
+#include <Models/StateSpace/StateSpaceModelBase.hpp>
+#include <distributions/rng.hpp>
+#include <cpputil/ThreadPool.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+namespace BOOM{
+
+  // A collection of structurally identical state space models (the
+  // same state models in the same order, but different data and
+  // parameters), such as a large number of series fit with the same
+  // bsts specification.
+  //
+  // loglike() runs the Kalman filter for blocks of 'block_size'
+  // models in lock-step.  The filter state for a block is stored in
+  // struct-of-arrays form: element i of the state mean is a
+  // contiguous array holding a[i] for every series in the block, and
+  // likewise for P, Z, K, and the other filter quantities.  The
+  // arithmetic in each step is then a set of loops across series,
+  // which the compiler can vectorize.  Transition blocks with known
+  // structure (local linear trend, seasonal) are applied to all
+  // series at once.  Other blocks are applied series by series through
+  // their virtual methods, as are the state variance matrices.  When
+  // the state dimension is large (e.g. a 52 period seasonal) the
+  // block's copy of P no longer fits in cache, and the lock-step
+  // filter can be slower than filtering the models one at a time with
+  // StructuredKalmanFilter, so most of the gain comes from the threads.
+  //
+  // impute_state() and sample_posterior() distribute whole models
+  // across the threads, because they call back into the state models
+  // (to observe the imputed state and draw parameters) once per time
+  // period.
+  //
+  // Blocks and models are the tasks of a ThreadPool, whose threads
+  // persist between calls.
+  // Models are grouped into blocks by length, so series of different
+  // lengths can be mixed.  Within a block, a series that has ended
+  // is carried along without touching its model.
+  //
+  // The state transition and state variance matrices must be
+  // BlockDiagonalMatrix objects (as in StateSpaceModelBase), with
+  // blocks of the same sizes across models.
+  class StateSpaceModelBatch{
+   public:
+    explicit StateSpaceModelBatch(int number_of_threads = 1,
+                                  int block_size = 16);
+
+    // Adds a model to the batch.  Its structure is checked against the
+    // first model added.
+    void add_model(const Ptr<StateSpaceModelBase> &model);
+
+    int number_of_models()const;
+    Ptr<StateSpaceModelBase> model(int i);
+
+    void set_number_of_threads(int number_of_threads);
+    void set_block_size(int block_size);
+
+    // Returns the log likelihood of each model, in the order the
+    // models were added.
+    Vec loglike();
+
+    // Calls impute_state() on each model.
+    void impute_state();
+
+    // Calls sample_posterior() on each model.  This is one MCMC
+    // iteration for every model in the batch.
+    void sample_posterior();
+
+   private:
+    struct Workspace;
+
+    // Filters the models in block number 'block' of order_ in
+    // lock-step, and stores their log likelihoods in loglike_.
+    void filter_block(int block, Workspace &workspace);
+
+    // Runs job(i, workspace) for i = 0, ..., number_of_jobs - 1 on the
+    // thread pool.  Each thread owns a Workspace.  Errors are
+    // collected and reported once all jobs are finished.
+    void run_jobs(int number_of_jobs,
+                  const boost::function<void(int, Workspace &)> &job);
+    void run_job(const boost::function<void(int, Workspace &)> &job,
+                 int i, int worker);
+
+    // Runs 'f' for model i with the model's own RNG installed as the
+    // default RNG for the calling thread.
+    void run_model(int i, void (*f)(StateSpaceModelBase *));
+
+    void check_structure(const StateSpaceModelBase &model)const;
+
+    std::vector<Ptr<StateSpaceModelBase> > models_;
+    std::vector<RNG> rngs_;
+    // Models sorted by time dimension, so each block holds series of
+    // similar length.
+    std::vector<int> order_;
+    Vec loglike_;
+
+    int block_size_;
+
+    ThreadPool thread_pool_;
+    // One workspace per worker in thread_pool_.
+    std::vector<boost::shared_ptr<Workspace> > workspaces_;
+  };
+
+}
+#endif// BOOM_STATE_SPACE_MODEL_BATCH_HPP_
@@ -80,7 +80,11 @@ namespace BOOM{
         PriorPolicy(rhs),
         regression_(rhs.regression_->clone())
   {
+    // Keep the parameter layout of the original.  See the
+    // StateSpaceModel copy constructor.
+    ParamPolicy::clear();
     setup();
+    for(int s = 0; s < nstate(); ++s) ParamPolicy::add_model(state_model(s));
   }
 
   SSRM * SSRM::clone()const{return new SSRM(*this);}
@@ -120,17 +124,12 @@ namespace BOOM{
     int t0 = dat().size();
     for(int t = 0; t < nrow(ans); ++t){
       ans(t,0) = regression_->predict(newX.row(t)) + observation_matrix(t + t0).dot(ks.a);
-      sparse_scalar_kalman_update(0,    // y is missing, so fill in a dummy value
-                                  ks.a,
-                                  ks.P,
-                                  ks.K,
-                                  ks.F,
-                                  ks.v,
-                                  true,  // forecasts are missing data
-                                  observation_matrix(t + t0),
-                                  observation_variance(t+t0),
-                                  *state_transition_matrix(t+t0),
-                                  *state_variance_matrix(t+t0));
+      kalman_update(0,  // y is missing, so fill in a dummy value
+                    ks.a,
+                    ks.P,
+                    ks,
+                    true,  // forecasts are missing data
+                    t + t0);
       ans(t,1) = sqrt(ks.F);
     }
     return ans;
@@ -143,9 +142,11 @@ namespace BOOM{
     const std::vector<Ptr<RegressionData> > &data(dat());
     int t0 = data.size();
     Vec state = final_state;
+    RNG &rng(default_rng());
     for(int t = 0; t < ans.size(); ++t){
       state = simulate_next_state(state, t+t0);
-      ans[t] = rnorm(observation_matrix(t+t0).dot(state), sqrt(observation_variance(t+t0)));
+      ans[t] = rnorm_mt(rng, observation_matrix(t+t0).dot(state),
+                        sqrt(observation_variance(t+t0)));
       ans[t] += regression_->predict(newX.row(t));
     }
     return ans;
@@ -168,17 +169,12 @@ namespace BOOM{
 
     for(int t = 0; t < ans.size(); ++t){
       bool missing = false;
-      sparse_scalar_kalman_update(newY[t] - regression_model()->predict(newX.row(t)),
-                                  ks.a,
-                                  ks.P,
-                                  ks.K,
-                                  ks.F,
-                                  ks.v,
-                                  missing,
-                                  observation_matrix(t + t0),
-                                  observation_variance(t+t0),
-                                  *state_transition_matrix(t+t0),
-                                  *state_variance_matrix(t+t0));
+      kalman_update(newY[t] - regression_model()->predict(newX.row(t)),
+                    ks.a,
+                    ks.P,
+                    ks,
+                    missing,
+                    t + t0);
       ans[t] = ks.v;
     }
     return ans;
@@ -194,9 +190,10 @@ namespace BOOM{
     // next time period.  Since the observed data goes from 0 to t-1,
     // ks contains the forecast distribution for time t.
     Vec state = rmvn_robust(ks.a, ks.P);
+    RNG &rng(default_rng());
     for(int t = 0; t < ans.size(); ++t){
-      ans[t] = rnorm(observation_matrix(t+t0).dot(state),
-                     sqrt(observation_variance(t+t0)));
+      ans[t] = rnorm_mt(rng, observation_matrix(t+t0).dot(state),
+                        sqrt(observation_variance(t+t0)));
       ans[t] += regression_->predict(newX.row(t));
       state = simulate_next_state(state, t + t0 + 1);
     }
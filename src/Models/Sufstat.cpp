@@ -20,8 +20,7 @@
 
 namespace BOOM{
   void intrusive_ptr_add_ref(Sufstat *m){ m->up_count(); }
-  void intrusive_ptr_release(Sufstat *m){ m->down_count();
-    if(m->ref_count()==0) delete m; }
+  void intrusive_ptr_release(Sufstat *m){ if(m->down_count()==0) delete m; }
 
   Vec vectorize(const std::vector<Ptr<Sufstat> > &v, bool minimal){
     uint N = v.size();
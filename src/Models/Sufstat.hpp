@@ -47,7 +47,7 @@ namespace BOOM{
   private:
     RefCounted rc_;
     void up_count(){rc_.up_count();}
-    void down_count(){rc_.down_count();}
+    unsigned int down_count(){return rc_.down_count();}
     unsigned int ref_count(){return rc_.ref_count();}
     friend void intrusive_ptr_add_ref(Sufstat *s);
     friend void intrusive_ptr_release(Sufstat *s);
@@ -216,12 +216,13 @@ namespace BOOM{
     std::deque<double> lags(y0.rbegin(), y0.rend());
     Vec ans;
     ans.reserve(n);
+    RNG &rng(default_rng());
     for(int i = 0; i < n; ++i) {
       double mu = 0;
       for(int lag = 0; lag < number_of_lags(); ++lag) {
         mu += phi[lag] * lags[lag];
       }
-      double y = rnorm(mu, sigma());
+      double y = rnorm_mt(rng, mu, sigma());
       lags.push_front(y);
       lags.pop_back();
       ans.push_back(y);
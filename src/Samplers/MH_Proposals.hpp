@@ -37,7 +37,7 @@ namespace BOOM{
 
     friend void intrusive_ptr_add_ref(MH_Proposal *s){s->up_count();}
     friend void intrusive_ptr_release(MH_Proposal *s){
-      s->down_count(); if(s->ref_count()==0) delete s;}
+      if(s->down_count()==0) delete s;}
 
     RNG & rng()const{return rng_;}
    private:
@@ -115,7 +115,7 @@ namespace BOOM{
 
     friend void intrusive_ptr_add_ref(MH_ScalarProposal *s){s->up_count();}
     friend void intrusive_ptr_release(MH_ScalarProposal *s){
-      s->down_count(); if(s->ref_count()==0) delete s;}
+      if(s->down_count()==0) delete s;}
     RNG & rng()const{return rng_;}
    private:
     mutable RNG rng_;
@@ -30,7 +30,7 @@ namespace BOOM{
 
   RNG & SamplerBase::rng()const{
     if(rng_) return *rng_;
-    return GlobalRng::rng;
+    return default_rng();
   }
 
   void SamplerBase::set_rng(RNG *r, bool owner){
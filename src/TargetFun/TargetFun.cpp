@@ -27,8 +27,7 @@ namespace BOOM{
   void intrusive_ptr_add_ref(TargetFun *s){
     s->up_count();}
   void intrusive_ptr_release(TargetFun *s){
-    s->down_count();
-    if(s->ref_count()==0) delete s; }
+    if(s->down_count()==0) delete s; }
 
   dTargetFun::dTargetFun() : eps_scale(1e-5){}
 
@@ -55,8 +54,7 @@ namespace BOOM{
   void intrusive_ptr_add_ref(ScalarTargetFun *s){
     s->up_count();}
   void intrusive_ptr_release(ScalarTargetFun *s){
-    s->down_count();
-    if(s->ref_count()==0) delete s; }
+    if(s->down_count()==0) delete s; }
   //----------------------------------------------------------------------
   dScalarTargetFun::dScalarTargetFun() : eps_scale(1e-5){}
 
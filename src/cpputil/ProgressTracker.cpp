@@ -93,7 +93,6 @@ namespace BOOM{
   void intrusive_ptr_add_ref(ProgressTracker *s){
     s->up_count();}
   void intrusive_ptr_release(ProgressTracker *s){
-    s->down_count();
-    if(s->ref_count()==0) delete s; }
+    if(s->down_count()==0) delete s; }
 
 }
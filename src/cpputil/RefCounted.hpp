@@ -20,45 +20,62 @@
 #define BOOM_REF_COUNTED_HPP
 
 #ifndef NO_BOOST_THREADS
-#include <boost/thread/mutex.hpp>
-#include <boost/thread/locks.hpp>
+#include <boost/atomic.hpp>
 #endif
 
 namespace BOOM{
 
-#ifdef NO_BOOST_THREADS
-#define BOOM_LOCK(MUTEX)
-#else
-#define BOOM_LOCK(MUTEX) boost::lock_guard<boost::mutex> lock(MUTEX)
-#endif
-
+  // A base class for objects managed by intrusive Ptr's.  Derived
+  // classes supply intrusive_ptr_add_ref and intrusive_ptr_release,
+  // which should be written
+  //
+  //   friend void intrusive_ptr_add_ref(T *t){t->up_count();}
+  //   friend void intrusive_ptr_release(T *t){
+  //     if(t->down_count()==0) delete t;}
+  //
+  // Testing the value returned by down_count(), rather than calling
+  // ref_count() afterwards, is what makes release safe when two
+  // threads drop the last two references at the same time.
+  //
+  // The count is atomic unless the library is built with
+  // NO_BOOST_THREADS, in which case it is a plain unsigned int.
+  // Taking a new reference only needs atomicity, so up_count uses
+  // relaxed ordering.  down_count uses acquire-release ordering so
+  // that every write made through other references happens before
+  // the object is deleted.
   class RefCounted{
-    unsigned int cnt_;
 #ifdef NO_BOOST_THREADS
-    int ref_count_mutex_;
+    unsigned int cnt_;
 #else
-    boost::mutex ref_count_mutex_;
+    boost::atomic<unsigned int> cnt_;
 #endif
   public:
     RefCounted(): cnt_(0){}
-    RefCounted(const RefCounted &): cnt_(0), ref_count_mutex_() {}
+    RefCounted(const RefCounted &): cnt_(0) {}
 
     // If this object is assigned a new value, nothing is done to the
     // reference count, so assignment is a no-op.
     RefCounted & operator=(const RefCounted &rhs) { return *this; }
 
     virtual ~RefCounted(){}
+#ifdef NO_BOOST_THREADS
+    void up_count(){ ++cnt_; }
+    // Returns the reference count after the decrement.
+    unsigned int down_count(){ return --cnt_; }
+    unsigned int ref_count()const{return cnt_;}
+#else
     void up_count(){
-      BOOM_LOCK(ref_count_mutex_);
-      ++cnt_;
+      cnt_.fetch_add(1, boost::memory_order_relaxed);
     }
-    void down_count(){
-      BOOM_LOCK(ref_count_mutex_);
-      --cnt_;
+    // Returns the reference count after the decrement.
+    unsigned int down_count(){
+      return cnt_.fetch_sub(1, boost::memory_order_acq_rel) - 1;
     }
-    unsigned int ref_count()const{return cnt_;}
+    unsigned int ref_count()const{
+      return cnt_.load(boost::memory_order_acquire);
+    }
+#endif
   };
 
-#undef BOOM_LOCK
 }
 #endif // BOOM_REF_COUNTED_HPP
@@ -0,0 +1,219 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <cpputil/ThreadPool.hpp>
+#include <cpputil/report_error.hpp>
+#include <boost/bind.hpp>
+#include <exception>
+#include <sstream>
+
+namespace BOOM{
+
+#ifdef NO_BOOST_THREADS
+  ThreadPool::ThreadPool(int number_of_threads)
+      : number_of_threads_(1)
+  {
+    set_number_of_threads(number_of_threads);
+  }
+
+  ThreadPool::ThreadPool(const ThreadPool &rhs)
+      : number_of_threads_(rhs.number_of_threads_)
+  {}
+
+  ThreadPool & ThreadPool::operator=(const ThreadPool &rhs){
+    number_of_threads_ = rhs.number_of_threads_;
+    return *this;
+  }
+
+  ThreadPool::~ThreadPool(){}
+
+  void ThreadPool::set_number_of_threads(int number_of_threads){
+    if(number_of_threads < 1){
+      report_error("The number of threads must be positive in ThreadPool.");
+    }
+    number_of_threads_ = number_of_threads;
+  }
+
+  // Without threads the whole loop runs as worker 0.
+  void ThreadPool::parallel_for(int number_of_tasks, const Task &task){
+    for(int i = 0; i < number_of_tasks; ++i) task(i, 0);
+  }
+
+#else
+  ThreadPool::ThreadPool(int number_of_threads)
+      : number_of_threads_(1),
+        threads_started_(false),
+        task_(0),
+        generation_(0),
+        busy_threads_(0),
+        shutting_down_(false)
+  {
+    set_number_of_threads(number_of_threads);
+  }
+
+  ThreadPool::ThreadPool(const ThreadPool &rhs)
+      : number_of_threads_(1),
+        threads_started_(false),
+        task_(0),
+        generation_(0),
+        busy_threads_(0),
+        shutting_down_(false)
+  {
+    set_number_of_threads(rhs.number_of_threads_);
+  }
+
+  ThreadPool & ThreadPool::operator=(const ThreadPool &rhs){
+    if(&rhs != this) set_number_of_threads(rhs.number_of_threads_);
+    return *this;
+  }
+
+  ThreadPool::~ThreadPool(){
+    stop_threads();
+  }
+
+  void ThreadPool::set_number_of_threads(int number_of_threads){
+    if(number_of_threads < 1){
+      report_error("The number of threads must be positive in ThreadPool.");
+    }
+    if(number_of_threads == number_of_threads_) return;
+    stop_threads();
+    number_of_threads_ = number_of_threads;
+    ranges_.clear();
+    for(int i = 0; i < number_of_threads_; ++i){
+      ranges_.push_back(boost::shared_ptr<TaskRange>(new TaskRange));
+    }
+    error_messages_.assign(number_of_threads_, "");
+  }
+
+  void ThreadPool::start_threads(){
+    shutting_down_ = false;
+    for(int worker = 1; worker < number_of_threads_; ++worker){
+      boost::shared_ptr<boost::thread> thread(new boost::thread(
+          boost::bind(&ThreadPool::thread_main, this, worker, generation_)));
+      threads_.push_back(thread);
+    }
+    threads_started_ = true;
+  }
+
+  void ThreadPool::stop_threads(){
+    if(!threads_started_) return;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      shutting_down_ = true;
+    }
+    work_available_.notify_all();
+    for(int i = 0; i < threads_.size(); ++i) threads_[i]->join();
+    threads_.clear();
+    threads_started_ = false;
+  }
+
+  //----------------------------------------------------------------------
+  void ThreadPool::parallel_for(int number_of_tasks, const Task &task){
+    if(number_of_tasks <= 0) return;
+    if(number_of_threads_ == 1 || number_of_tasks == 1){
+      for(int i = 0; i < number_of_tasks; ++i) task(i, 0);
+      return;
+    }
+    if(!threads_started_) start_threads();
+
+    for(int worker = 0; worker < number_of_threads_; ++worker){
+      TaskRange &range(*ranges_[worker]);
+      boost::mutex::scoped_lock lock(range.mutex);
+      range.begin = (int)((long)number_of_tasks * worker / number_of_threads_);
+      range.end =
+          (int)((long)number_of_tasks * (worker + 1) / number_of_threads_);
+      error_messages_[worker].clear();
+    }
+
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      task_ = &task;
+      busy_threads_ = number_of_threads_ - 1;
+      ++generation_;
+    }
+    work_available_.notify_all();
+    run_tasks(0);
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      while(busy_threads_ > 0) work_finished_.wait(lock);
+      task_ = 0;
+    }
+
+    std::ostringstream err;
+    bool failed = false;
+    for(int worker = 0; worker < number_of_threads_; ++worker){
+      if(!error_messages_[worker].empty()){
+        failed = true;
+        err << error_messages_[worker];
+      }
+    }
+    if(failed) report_error(err.str());
+  }
+
+  void ThreadPool::thread_main(int worker, int last_generation){
+    while(true){
+      {
+        boost::mutex::scoped_lock lock(mutex_);
+        while(generation_ == last_generation && !shutting_down_){
+          work_available_.wait(lock);
+        }
+        if(shutting_down_) return;
+        last_generation = generation_;
+      }
+      run_tasks(worker);
+      {
+        boost::mutex::scoped_lock lock(mutex_);
+        if(--busy_threads_ == 0) work_finished_.notify_all();
+      }
+    }
+  }
+
+  void ThreadPool::run_tasks(int worker){
+    for(int i = claim_task(worker); i >= 0; i = claim_task(worker)){
+      try{
+        (*task_)(i, worker);
+      }catch(const std::exception &e){
+        std::ostringstream err;
+        err << "Task " << i << " failed in ThreadPool: " << e.what()
+            << std::endl;
+        error_messages_[worker] += err.str();
+      }catch(...){
+        std::ostringstream err;
+        err << "Task " << i << " failed in ThreadPool with an unknown "
+            << "exception." << std::endl;
+        error_messages_[worker] += err.str();
+      }
+    }
+  }
+
+  int ThreadPool::claim_task(int worker){
+    {
+      TaskRange &own(*ranges_[worker]);
+      boost::mutex::scoped_lock lock(own.mutex);
+      if(own.begin < own.end) return own.begin++;
+    }
+    for(int k = 1; k < number_of_threads_; ++k){
+      TaskRange &victim(*ranges_[(worker + k) % number_of_threads_]);
+      boost::mutex::scoped_lock lock(victim.mutex);
+      if(victim.begin < victim.end) return --victim.end;
+    }
+    return -1;
+  }
+#endif
+
+}
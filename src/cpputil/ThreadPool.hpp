@@ -0,0 +1,135 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_THREAD_POOL_HPP_
+#define BOOM_THREAD_POOL_HPP_
+
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#ifndef NO_BOOST_THREADS
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#endif
+#include <string>
+#include <vector>
+
+namespace BOOM{
+
+  // A ThreadPool runs data-parallel loops on a set of threads that
+  // persist between loops, so that an MCMC sampler that splits its
+  // data imputation across threads on every iteration does not pay to
+  // create and join threads each time.
+  //
+  // parallel_for(n, task) calls task(i, worker) once for each i in
+  // [0, n).  'worker' is in [0, number_of_threads()) and identifies
+  // the thread running the task.  No two tasks with the same worker
+  // run at the same time, so per-worker scratch space is safe.
+  //
+  // The calling thread is worker 0, so a pool with n threads starts
+  // n - 1 background threads, and a pool with one thread runs the
+  // loop in the calling thread.  The tasks are initially divided into
+  // one contiguous range per worker.  A worker that finishes its own
+  // range steals tasks from the end of the others' ranges, so uneven
+  // task costs are balanced.  Because of this, the worker that runs a
+  // given task can differ between calls.
+  //
+  // Loops that draw random numbers or accumulate sums should therefore
+  // key that state to the task rather than the worker, if results are
+  // to be reproducible.  The usual pattern splits the data into a
+  // fixed set of shards (see number_of_shards and shard_begin below),
+  // each with its own RNG and accumulators, runs one task per shard,
+  // and combines the shards in order once the loop is finished.
+  //
+  // If any task throws, the remaining tasks are still run, and an
+  // error describing each failure is reported when the loop is done.
+  //
+  // parallel_for must not be called from inside one of its own tasks,
+  // or from two threads at once.  Copying a pool creates a new pool
+  // with the same number of threads.
+  class ThreadPool{
+   public:
+    typedef boost::function<void(int task, int worker)> Task;
+
+    explicit ThreadPool(int number_of_threads = 1);
+    ThreadPool(const ThreadPool &rhs);
+    ThreadPool & operator=(const ThreadPool &rhs);
+    ~ThreadPool();
+
+    // Background threads are started by the first call to
+    // parallel_for after the number of threads is set.
+    void set_number_of_threads(int number_of_threads);
+    int number_of_threads()const{return number_of_threads_;}
+
+    void parallel_for(int number_of_tasks, const Task &task);
+
+   private:
+    int number_of_threads_;
+
+#ifndef NO_BOOST_THREADS
+    // The unclaimed tasks [begin, end) assigned to a worker.  The
+    // owner takes tasks from the front, and thieves from the back.
+    struct TaskRange{
+      boost::mutex mutex;
+      int begin;
+      int end;
+    };
+
+    void start_threads();
+    void stop_threads();
+    // The main loop of a background thread.  It waits for generation_
+    // to move past 'last_generation', which signals a new loop.
+    void thread_main(int worker, int last_generation);
+    // Runs tasks until there are none left to claim or steal.
+    void run_tasks(int worker);
+    // Claims a task for 'worker'.  Returns -1 if no tasks remain.
+    int claim_task(int worker);
+
+    std::vector<boost::shared_ptr<TaskRange> > ranges_;
+    std::vector<std::string> error_messages_;
+    std::vector<boost::shared_ptr<boost::thread> > threads_;
+    bool threads_started_;
+
+    // Guards the members below, which hand loops to the background
+    // threads.
+    boost::mutex mutex_;
+    boost::condition_variable work_available_;
+    boost::condition_variable work_finished_;
+    const Task *task_;
+    int generation_;
+    int busy_threads_;
+    bool shutting_down_;
+#endif
+  };
+
+  // The number of shards for a reproducible loop on a pool with
+  // number_of_threads threads.  Having several shards per thread lets
+  // the pool balance the load.
+  inline int number_of_shards(int number_of_threads){
+    return 4 * number_of_threads;
+  }
+
+  // The first of n items in shard 'shard', when the items are divided
+  // into number_of_shards contiguous shards whose sizes differ by at
+  // most one.  Shard i is [shard_begin(n, i, k), shard_begin(n, i+1, k)).
+  inline int shard_begin(int n, int shard, int number_of_shards){
+    return static_cast<int>(static_cast<double>(n) * shard / number_of_shards);
+  }
+
+}
+#endif// BOOM_THREAD_POOL_HPP_
@@ -15,20 +15,364 @@
   License along with this library; if not, write to the Free Software
   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
 */
+#include <cpputil/lse.hpp>
 #include <LinAlg/Vector.hpp>
 #include <LinAlg/Types.hpp>
 #include <cmath>
+#include <cfloat>
 #include <cpputil/math_utils.hpp>
 
+// The AVX2 kernels need GCC or clang (for the target attribute and
+// __builtin_cpu_supports) on x86.  Define BOOM_NO_AVX2 to disable
+// them.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) \
+    && !defined(BOOM_NO_AVX2)
+#define BOOM_LSE_AVX2
+#include <immintrin.h>
+#endif
+
 namespace BOOM{
 
+  namespace {
+    //----------------------------------------------------------------------
+    // Scalar kernels.  These are also used for the tails of the
+    // buffers in the vectorized kernels.
+    double scalar_max(const double *x, int n){
+      double ans = x[0];
+      for(int i = 1; i < n; ++i) if(x[i] > ans) ans = x[i];
+      return ans;
+    }
+
+    double scalar_sum_exp(const double *x, int n, double shift){
+      double ans = 0;
+      for(int i = 0; i < n; ++i) ans += std::exp(x[i] - shift);
+      return ans;
+    }
+
+    double scalar_shifted_exp(double *x, int n, double shift){
+      double ans = 0;
+      for(int i = 0; i < n; ++i){
+        x[i] = std::exp(x[i] - shift);
+        ans += x[i];
+      }
+      return ans;
+    }
+
+    void scalar_scale(double *x, int n, double scale){
+      for(int i = 0; i < n; ++i) x[i] *= scale;
+    }
+
+    void scalar_shift(double *x, int n, double shift){
+      for(int i = 0; i < n; ++i) x[i] -= shift;
+    }
+
+    void scalar_log(double *x, int n){
+      for(int i = 0; i < n; ++i) x[i] = std::log(x[i]);
+    }
+
+#ifdef BOOM_LSE_AVX2
+#define BOOM_AVX2 __attribute__((target("avx2,fma")))
+
+    bool cpu_has_avx2(){
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    }
+
+    // 2^52 + 2^51.  Adding this to a double of magnitude less than
+    // 2^51 rounds it to an integer held in the low order bits.
+    const double round_magic = 6755399441055744.0;
+    // log(2) split so that k * ln2_hi is exact for |k| < 2^11.
+    const double ln2_hi = 6.93145751953125e-1;
+    const double ln2_lo = 1.42860682030941723212e-6;
+
+    BOOM_AVX2 inline __m256d set(double x){ return _mm256_set1_pd(x); }
+
+    BOOM_AVX2 inline double horizontal_sum(__m256d x){
+      __m128d lo = _mm256_castpd256_pd128(x);
+      __m128d hi = _mm256_extractf128_pd(x, 1);
+      lo = _mm_add_pd(lo, hi);
+      return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+    }
+
+    BOOM_AVX2 inline double horizontal_max(__m256d x){
+      __m128d lo = _mm256_castpd256_pd128(x);
+      __m128d hi = _mm256_extractf128_pd(x, 1);
+      lo = _mm_max_pd(lo, hi);
+      return _mm_cvtsd_f64(_mm_max_sd(lo, _mm_unpackhi_pd(lo, lo)));
+    }
+
+    // Lanes where exp4 is not valid: x > 709 or x is NaN.
+    BOOM_AVX2 inline int exp4_special(__m256d x){
+      return _mm256_movemask_pd(_mm256_cmp_pd(x, set(709.0), _CMP_NLE_UQ));
+    }
+
+    // exp(x) for x <= 709.  See lse.hpp for the accuracy.
+    BOOM_AVX2 inline __m256d exp4(__m256d x){
+      __m256d underflow = _mm256_cmp_pd(x, set(-708.0), _CMP_LT_OQ);
+      x = _mm256_max_pd(x, set(-708.0));
+      __m256d magic = set(round_magic);
+      __m256d t = _mm256_fmadd_pd(x, set(1.4426950408889634), magic);
+      __m256d k = _mm256_sub_pd(t, magic);
+      __m256d r = _mm256_fnmadd_pd(k, set(ln2_hi), x);
+      r = _mm256_fnmadd_pd(k, set(ln2_lo), r);
+
+      // Taylor coefficients 1/12!, ..., 1/0!.
+      __m256d p = set(2.08767569878680989792e-9);
+      p = _mm256_fmadd_pd(p, r, set(2.50521083854417187751e-8));
+      p = _mm256_fmadd_pd(p, r, set(2.75573192239858906526e-7));
+      p = _mm256_fmadd_pd(p, r, set(2.75573192239858906526e-6));
+      p = _mm256_fmadd_pd(p, r, set(2.48015873015873015873e-5));
+      p = _mm256_fmadd_pd(p, r, set(1.98412698412698412698e-4));
+      p = _mm256_fmadd_pd(p, r, set(1.38888888888888888889e-3));
+      p = _mm256_fmadd_pd(p, r, set(8.33333333333333333333e-3));
+      p = _mm256_fmadd_pd(p, r, set(4.16666666666666666667e-2));
+      p = _mm256_fmadd_pd(p, r, set(1.66666666666666666667e-1));
+      p = _mm256_fmadd_pd(p, r, set(0.5));
+      p = _mm256_fmadd_pd(p, r, set(1.0));
+      p = _mm256_fmadd_pd(p, r, set(1.0));
+
+      // Multiply by 2^k by building the exponent bits directly.
+      __m256i ki = _mm256_sub_epi64(_mm256_castpd_si256(t),
+                                    _mm256_castpd_si256(magic));
+      __m256i two_to_k = _mm256_slli_epi64(
+          _mm256_add_epi64(ki, _mm256_set1_epi64x(1023)), 52);
+      __m256d ans = _mm256_mul_pd(p, _mm256_castsi256_pd(two_to_k));
+      return _mm256_andnot_pd(underflow, ans);
+    }
+
+    // Lanes where log4 is not valid: negative, subnormal, infinite or
+    // NaN.  Zero is handled by log4.
+    BOOM_AVX2 inline int log4_special(__m256d x){
+      __m256d zero = _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_EQ_OQ);
+      __m256d small = _mm256_andnot_pd(
+          zero, _mm256_cmp_pd(x, set(DBL_MIN), _CMP_LT_OQ));
+      __m256d big = _mm256_cmp_pd(x, set(DBL_MAX), _CMP_NLE_UQ);
+      return _mm256_movemask_pd(_mm256_or_pd(small, big));
+    }
+
+    BOOM_AVX2 inline __m256d log4(__m256d x){
+      __m256i bits = _mm256_castpd_si256(x);
+      __m256i exponent = _mm256_sub_epi64(
+          _mm256_srli_epi64(bits, 52), _mm256_set1_epi64x(1023));
+      __m256d m = _mm256_castsi256_pd(_mm256_or_si256(
+          _mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)),
+          _mm256_set1_epi64x(0x3FF0000000000000LL)));
+      // Move m from [1, 2) to [sqrt(.5), sqrt(2)).
+      __m256d big = _mm256_cmp_pd(m, set(M_SQRT2), _CMP_GT_OQ);
+      m = _mm256_blendv_pd(m, _mm256_mul_pd(m, set(0.5)), big);
+      exponent = _mm256_add_epi64(
+          exponent,
+          _mm256_and_si256(_mm256_castpd_si256(big), _mm256_set1_epi64x(1)));
+      __m256d magic = set(round_magic);
+      __m256d e = _mm256_sub_pd(
+          _mm256_castsi256_pd(
+              _mm256_add_epi64(exponent, _mm256_castpd_si256(magic))),
+          magic);
+
+      // log(m) = 2 * atanh(f) = 2 * (f + f^3/3 + f^5/5 + ...).
+      __m256d one = set(1.0);
+      __m256d f = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+      __m256d f2 = _mm256_mul_pd(f, f);
+      __m256d q = set(1.0 / 21);
+      q = _mm256_fmadd_pd(q, f2, set(1.0 / 19));
+      q = _mm256_fmadd_pd(q, f2, set(1.0 / 17));
+      q = _mm256_fmadd_pd(q, f2, set(1.0 / 15));
+      q = _mm256_fmadd_pd(q, f2, set(1.0 / 13));
+      q = _mm256_fmadd_pd(q, f2, set(1.0 / 11));
+      q = _mm256_fmadd_pd(q, f2, set(1.0 / 9));
+      q = _mm256_fmadd_pd(q, f2, set(1.0 / 7));
+      q = _mm256_fmadd_pd(q, f2, set(1.0 / 5));
+      q = _mm256_fmadd_pd(q, f2, set(1.0 / 3));
+      q = _mm256_fmadd_pd(q, f2, one);
+      __m256d log_m = _mm256_mul_pd(_mm256_add_pd(f, f), q);
+
+      __m256d ans = _mm256_fmadd_pd(e, set(ln2_lo), log_m);
+      ans = _mm256_fmadd_pd(e, set(ln2_hi), ans);
+      __m256d zero = _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_EQ_OQ);
+      return _mm256_blendv_pd(ans, set(-HUGE_VAL), zero);
+    }
+
+    BOOM_AVX2 double avx2_max(const double *x, int n){
+      if(n < 4) return scalar_max(x, n);
+      __m256d m = _mm256_loadu_pd(x);
+      int i = 4;
+      for(; i + 4 <= n; i += 4) m = _mm256_max_pd(m, _mm256_loadu_pd(x + i));
+      double ans = horizontal_max(m);
+      for(; i < n; ++i) if(x[i] > ans) ans = x[i];
+      return ans;
+    }
+
+    BOOM_AVX2 double avx2_sum_exp(const double *x, int n, double shift){
+      __m256d total = _mm256_setzero_pd();
+      __m256d s = set(shift);
+      int i = 0;
+      double ans = 0;
+      for(; i + 4 <= n; i += 4){
+        __m256d y = _mm256_sub_pd(_mm256_loadu_pd(x + i), s);
+        if(exp4_special(y)){
+          ans += scalar_sum_exp(x + i, 4, shift);
+        } else {
+          total = _mm256_add_pd(total, exp4(y));
+        }
+      }
+      return ans + horizontal_sum(total) + scalar_sum_exp(x + i, n - i, shift);
+    }
+
+    BOOM_AVX2 double avx2_shifted_exp(double *x, int n, double shift){
+      __m256d total = _mm256_setzero_pd();
+      __m256d s = set(shift);
+      int i = 0;
+      double ans = 0;
+      for(; i + 4 <= n; i += 4){
+        __m256d y = _mm256_sub_pd(_mm256_loadu_pd(x + i), s);
+        if(exp4_special(y)){
+          ans += scalar_shifted_exp(x + i, 4, shift);
+        } else {
+          y = exp4(y);
+          _mm256_storeu_pd(x + i, y);
+          total = _mm256_add_pd(total, y);
+        }
+      }
+      return ans + horizontal_sum(total)
+          + scalar_shifted_exp(x + i, n - i, shift);
+    }
+
+    BOOM_AVX2 void avx2_scale(double *x, int n, double scale){
+      __m256d s = set(scale);
+      int i = 0;
+      for(; i + 4 <= n; i += 4){
+        _mm256_storeu_pd(x + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), s));
+      }
+      scalar_scale(x + i, n - i, scale);
+    }
+
+    BOOM_AVX2 void avx2_shift(double *x, int n, double shift){
+      __m256d s = set(shift);
+      int i = 0;
+      for(; i + 4 <= n; i += 4){
+        _mm256_storeu_pd(x + i, _mm256_sub_pd(_mm256_loadu_pd(x + i), s));
+      }
+      scalar_shift(x + i, n - i, shift);
+    }
+
+    BOOM_AVX2 void avx2_log(double *x, int n){
+      int i = 0;
+      for(; i + 4 <= n; i += 4){
+        __m256d y = _mm256_loadu_pd(x + i);
+        if(log4_special(y)){
+          scalar_log(x + i, 4);
+        } else {
+          _mm256_storeu_pd(x + i, log4(y));
+        }
+      }
+      scalar_log(x + i, n - i);
+    }
+
+#undef BOOM_AVX2
+#endif  // BOOM_LSE_AVX2
+
+    //----------------------------------------------------------------------
+    // Dispatch to the best available kernel.
+    bool use_avx2(){
+#ifdef BOOM_LSE_AVX2
+      static const bool ans = cpu_has_avx2();
+      return ans;
+#else
+      return false;
+#endif
+    }
+
+    double buffer_max(const double *x, int n){
+#ifdef BOOM_LSE_AVX2
+      if(use_avx2()) return avx2_max(x, n);
+#endif
+      return scalar_max(x, n);
+    }
+
+    double sum_exp(const double *x, int n, double shift){
+#ifdef BOOM_LSE_AVX2
+      if(use_avx2()) return avx2_sum_exp(x, n, shift);
+#endif
+      return scalar_sum_exp(x, n, shift);
+    }
+
+    double shifted_exp(double *x, int n, double shift){
+#ifdef BOOM_LSE_AVX2
+      if(use_avx2()) return avx2_shifted_exp(x, n, shift);
+#endif
+      return scalar_shifted_exp(x, n, shift);
+    }
+
+    void scale_buffer(double *x, int n, double scale){
+#ifdef BOOM_LSE_AVX2
+      if(use_avx2()) return avx2_scale(x, n, scale);
+#endif
+      scalar_scale(x, n, scale);
+    }
+
+    void shift_buffer(double *x, int n, double shift){
+#ifdef BOOM_LSE_AVX2
+      if(use_avx2()) return avx2_shift(x, n, shift);
+#endif
+      scalar_shift(x, n, shift);
+    }
+  }  // namespace
+
+  double lse(const double *x, int n){
+    if(n <= 0) return negative_infinity();
+    double m = buffer_max(x, n);
+    if(!std::isfinite(m)) return m;
+    return m + std::log(sum_exp(x, n, m));
+  }
+
+  double softmax_in_place(double *x, int n){
+    if(n <= 0) return negative_infinity();
+    double m = buffer_max(x, n);
+    if(m == negative_infinity()){
+      // Every element has probability zero, so there is nothing to
+      // normalize.  Return the uniform distribution.
+      for(int i = 0; i < n; ++i) x[i] = 1.0 / n;
+      return m;
+    } else if(m == infinity()){
+      // The infinite elements share the mass equally.
+      int count = 0;
+      for(int i = 0; i < n; ++i){
+        x[i] = (x[i] == m);
+        count += x[i];
+      }
+      scale_buffer(x, n, 1.0 / count);
+      return m;
+    }
+    double nc = shifted_exp(x, n, m);
+    scale_buffer(x, n, 1.0 / nc);
+    return m + std::log(nc);
+  }
+
+  double log_normalize_in_place(double *x, int n){
+    double ans = lse(x, n);
+    if(std::isfinite(ans)) shift_buffer(x, n, ans);
+    return ans;
+  }
+
+  void exp_in_place(double *x, int n){
+    // Shifting by zero makes the shifted exp an ordinary exp.
+    shifted_exp(x, n, 0.0);
+  }
+
+  void log_in_place(double *x, int n){
+#ifdef BOOM_LSE_AVX2
+    if(use_avx2()) return avx2_log(x, n);
+#endif
+    scalar_log(x, n);
+  }
+
+  bool lse_kernels_use_avx2(){
+    return use_avx2();
+  }
+
+  //======================================================================
   double lse_safe(const Vec &eta){
-    double m = eta.max();
-    if (m == negative_infinity()) return m;
-    double tmp=0;
-    uint n = eta.size();
-    for (uint i=0; i<n; ++i) tmp+= exp(eta[i]-m);
-    return m + log(tmp);
+    return lse(eta.data(), eta.size());
   }
 
   double lse_fast(const Vec & eta){
@@ -30,5 +30,47 @@ namespace BOOM{
     if(x<y){ double tmp(x); x=y; y=tmp; }
     return x + ::log1p(::exp(y-x));
   }
+
+  //======================================================================
+  // Kernels over contiguous buffers of n doubles, for the inner loops
+  // of mixture models and HMM filters.  On x86 processors with AVX2
+  // and FMA (detected at run time) they process four elements at a
+  // time using the exp and log approximations below.  Elsewhere they
+  // are scalar loops calling std::exp and std::log.
+  //
+  // Accuracy of the vectorized approximations:
+  //   exp: Range reduction to [-log(2)/2, log(2)/2] followed by a
+  //     degree 12 Taylor polynomial.  Relative error is below 1e-15
+  //     (a few ulp) for x in [-708, 709].  x < -708 returns 0 (there
+  //     are no subnormal results).  Larger x and NaN are computed
+  //     with std::exp.
+  //   log: Range reduction to [sqrt(.5), sqrt(2)) followed by the
+  //     atanh series through degree 21.  Relative error is below
+  //     1e-15.  0 returns -infinity.  Negative, subnormal, infinite
+  //     and NaN arguments are computed with std::log.
+  // Results can therefore differ in the last few bits between
+  // machines with and without AVX2.
+
+  // Returns log(sum(exp(x))).  Returns the maximum element if it is
+  // infinite, and negative infinity if n == 0.
+  double lse(const double *x, int n);
+
+  // Replaces x with exp(x - lse(x)), so it sums to 1.  Returns lse(x)
+  // from before the replacement.  If every element of x is negative
+  // infinity then x is replaced by the uniform distribution.  If any
+  // elements are positive infinity then they share the mass equally.
+  double softmax_in_place(double *x, int n);
+
+  // Replaces x with x - lse(x), so exp(x) sums to 1.  Returns lse(x)
+  // from before the replacement.
+  double log_normalize_in_place(double *x, int n);
+
+  // Elementwise exp and log.
+  void exp_in_place(double *x, int n);
+  void log_in_place(double *x, int n);
+
+  // Returns true if the kernels above use the AVX2 code path on this
+  // machine.
+  bool lse_kernels_use_avx2();
 }
 #endif // BOOM_LSE_HPP
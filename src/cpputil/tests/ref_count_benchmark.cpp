@@ -0,0 +1,120 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+// Reports Ptr copies per second and the per-object size of the
+// reference count, for RefCounted and for the mutex-based counter it
+// replaced.
+//
+//   make ref_count_benchmark && ./ref_count_benchmark [ncopies]
+//
+// The copy loop takes a Ptr to each of a vector of objects in turn,
+// as an imputation loop over a data set does.  Build with
+// CXXFLAGS="-Isrc -O2 -DNO_BOOST_THREADS" to time the non-atomic
+// count.
+
+#include <cpputil/Ptr.hpp>
+#include <cpputil/RefCounted.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+namespace {
+  using namespace BOOM;
+
+  // The reference count used by RefCounted before it was made atomic.
+  class MutexRefCounted{
+    unsigned int cnt_;
+    boost::mutex ref_count_mutex_;
+   public:
+    MutexRefCounted(): cnt_(0){}
+    virtual ~MutexRefCounted(){}
+    void up_count(){
+      boost::lock_guard<boost::mutex> lock(ref_count_mutex_);
+      ++cnt_;
+    }
+    void down_count(){
+      boost::lock_guard<boost::mutex> lock(ref_count_mutex_);
+      --cnt_;
+    }
+    unsigned int ref_count()const{return cnt_;}
+  };
+
+  class AtomicObject : public RefCounted{
+   public:
+    double value;
+    friend void intrusive_ptr_add_ref(AtomicObject *d){d->up_count();}
+    friend void intrusive_ptr_release(AtomicObject *d){
+      if(d->down_count()==0) delete d;}
+  };
+
+  class MutexObject : public MutexRefCounted{
+   public:
+    double value;
+    friend void intrusive_ptr_add_ref(MutexObject *d){d->up_count();}
+    friend void intrusive_ptr_release(MutexObject *d){
+      d->down_count(); if(d->ref_count()==0) delete d;}
+  };
+
+  template <class OBJECT>
+  void time_copies(const char *name, size_t counter_size, long ncopies){
+    const int nobjects = 100000;
+    std::vector<Ptr<OBJECT> > objects;
+    objects.reserve(nobjects);
+    for(int i = 0; i < nobjects; ++i){
+      Ptr<OBJECT> obj(new OBJECT);
+      obj->value = i;
+      objects.push_back(obj);
+    }
+
+    double total = 0;
+    clock_t start = clock();
+    for(long i = 0; i < ncopies; ++i){
+      Ptr<OBJECT> copy = objects[i % nobjects];
+      total += copy->value;
+    }
+    clock_t end = clock();
+
+    double seconds = double(end - start) / CLOCKS_PER_SEC;
+    std::cout << name << "\t" << counter_size << " bytes\t";
+    if(seconds > 0) {
+      std::cout << ncopies / seconds;
+    } else {
+      std::cout << "inf";
+    }
+    // Printing the checksum keeps the compiler from discarding the
+    // copies.
+    std::cout << " copies/sec\t(checksum " << total << ")" << std::endl;
+  }
+}  // namespace
+
+int main(int argc, char **argv){
+  long ncopies = 100000000;
+  if(argc > 1) ncopies = atol(argv[1]);
+
+#ifdef NO_BOOST_THREADS
+  const char *name = "non-atomic";
+#else
+  const char *name = "atomic";
+#endif
+  time_copies<MutexObject>("mutex", sizeof(MutexRefCounted), ncopies);
+  time_copies<AtomicObject>(name, sizeof(RefCounted), ncopies);
+  return 0;
+}
@@ -158,12 +158,12 @@ namespace BOOM{
   }
 
   void rmultinom(int n, const std::vector<double> &prob, std::vector<int> &result){
-    Rmath::rmultinom_mt(BOOM::GlobalRng::rng, n, prob, result);
+    Rmath::rmultinom_mt(BOOM::default_rng(), n, prob, result);
   }
 
   std::vector<int> rmultinom(int n, const std::vector<double> &prob){
     std::vector<int> result;
-    Rmath::rmultinom_mt(BOOM::GlobalRng::rng, n, prob, result);
+    Rmath::rmultinom_mt(BOOM::default_rng(), n, prob, result);
     return result;
   }
 
@@ -37,7 +37,7 @@ namespace BOOM{
   }
 
   Spd rWish(double nu, const Spd &sumsq_inv, bool inv){
-    return rWish_mt(GlobalRng::rng, nu, sumsq_inv, inv);  }
+    return rWish_mt(default_rng(), nu, sumsq_inv, inv);  }
 
   Spd rWish_mt(RNG & rng, double nu, const Spd &sumsq_inv, bool inv){
     uint d = sumsq_inv.nrow();
@@ -54,7 +54,7 @@ namespace BOOM{
   }
 
   Spd rWishChol(double nu, const Mat & sumsq_upper_chol, bool inv){
-    return rWishChol_mt(GlobalRng::rng, nu, sumsq_upper_chol, inv);
+    return rWishChol_mt(default_rng(), nu, sumsq_upper_chol, inv);
   }
 
   // sumsq_chol is the cholesky decomposition of the centered sum of
@@ -0,0 +1,292 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <distributions/batch_draws.hpp>
+#include <cpputil/report_error.hpp>
+#include <cmath>
+#include <sstream>
+
+namespace BOOM{
+
+  namespace {
+    // The layers of a ziggurat covering the right half of a
+    // monotone decreasing density f with 'nlayers' equal-area
+    // layers.  x[1] = R is the start of the tail, x[nlayers] = 0, and
+    // x[0] = V / f(R) is the width of a rectangle with the same area
+    // V as the base layer (which includes the tail).  ratio[i] =
+    // x[i+1] / x[i] is the fraction of layer i lying entirely under
+    // the density.
+    struct Ziggurat{
+      Ziggurat(int nlayers, double R, double V, bool normal)
+          : x(nlayers + 1),
+            ratio(nlayers)
+      {
+        double f = density(R, normal);
+        x[0] = V / f;
+        x[1] = R;
+        x[nlayers] = 0;
+        for(int i = 2; i < nlayers; ++i){
+          // Solve f(x[i]) = V / x[i-1] + f(x[i-1]).
+          double y = V / x[i-1] + f;
+          x[i] = normal ? sqrt(-2 * log(y)) : -log(y);
+          f = density(x[i], normal);
+        }
+        for(int i = 0; i < nlayers; ++i) ratio[i] = x[i+1] / x[i];
+      }
+
+      static double density(double z, bool normal){
+        return normal ? exp(-0.5 * z * z) : exp(-z);
+      }
+
+      std::vector<double> x;
+      std::vector<double> ratio;
+    };
+
+    // Constants from Doornik (2005) and Marsaglia and Tsang (2000).
+    const int normal_layers = 128;
+    const double normal_R = 3.442619855899;
+    const double normal_V = 9.91256303526217e-3;
+    const int exponential_layers = 256;
+    const double exponential_R = 7.69711747013104972;
+    const double exponential_V = 3.949659822581572e-3;
+
+    const Ziggurat & normal_ziggurat(){
+      static const Ziggurat ans(normal_layers, normal_R, normal_V, true);
+      return ans;
+    }
+
+    const Ziggurat & exponential_ziggurat(){
+      static const Ziggurat ans(
+          exponential_layers, exponential_R, exponential_V, false);
+      return ans;
+    }
+
+    // A uniform draw on (0, 1], safe to take the log of.
+    inline double positive_uniform(RNG &rng){
+      return 1.0 - rng();
+    }
+
+    // Splits a uniform draw into a layer index and a uniform on
+    // [-1, 1) (or [0, 1) if 'symmetric' is false) using its high and
+    // low order bits respectively.
+    inline int split_uniform(double uniform, int nlayers, bool symmetric,
+                             double *u){
+      double w = uniform * nlayers;
+      int layer = static_cast<int>(w);
+      *u = symmetric ? 2 * (w - layer) - 1 : w - layer;
+      return layer;
+    }
+
+    // Handles the rare normal draws that fall outside the fast path.
+    double normal_ziggurat_slow_path(RNG &rng, const Ziggurat &zig,
+                                     int layer, double u){
+      const std::vector<double> &x(zig.x);
+      for(;;){
+        if(layer == 0){
+          // Marsaglia's (1964) method for the tail beyond R.
+          double z, y;
+          do{
+            z = log(positive_uniform(rng)) / normal_R;
+            y = log(positive_uniform(rng));
+          }while(-2 * y < z * z);
+          return u < 0 ? z - normal_R : normal_R - z;
+        }
+        double z = u * x[layer];
+        double f0 = exp(-0.5 * (x[layer] * x[layer] - z * z));
+        double f1 = exp(-0.5 * (x[layer + 1] * x[layer + 1] - z * z));
+        if(f1 + rng() * (f0 - f1) < 1.0) return z;
+        layer = split_uniform(rng(), normal_layers, true, &u);
+        if(fabs(u) < zig.ratio[layer]) return u * x[layer];
+      }
+    }
+
+    double exponential_ziggurat_slow_path(RNG &rng, const Ziggurat &zig,
+                                          int layer, double u){
+      const std::vector<double> &x(zig.x);
+      for(;;){
+        if(layer == 0){
+          // The exponential distribution is memoryless, so the tail
+          // beyond R is R plus another exponential.
+          return exponential_R - log(positive_uniform(rng));
+        }
+        double z = u * x[layer];
+        double f0 = exp(z - x[layer]);
+        double f1 = exp(z - x[layer + 1]);
+        if(f1 + rng() * (f0 - f1) < 1.0) return z;
+        layer = split_uniform(rng(), exponential_layers, false, &u);
+        if(u < zig.ratio[layer]) return u * x[layer];
+      }
+    }
+
+    void fill_uniform(RNG &rng, double *buffer, int n){
+      for(int i = 0; i < n; ++i) buffer[i] = rng();
+    }
+
+    void standard_normal_batch(RNG &rng, double *buffer, int n){
+      const Ziggurat &zig(normal_ziggurat());
+      const double *x = &zig.x[0];
+      const double *ratio = &zig.ratio[0];
+      fill_uniform(rng, buffer, n);
+      for(int i = 0; i < n; ++i){
+        double u;
+        int layer = split_uniform(buffer[i], normal_layers, true, &u);
+        if(fabs(u) < ratio[layer]){
+          buffer[i] = u * x[layer];
+        } else {
+          buffer[i] = normal_ziggurat_slow_path(rng, zig, layer, u);
+        }
+      }
+    }
+
+    void standard_exponential_batch(RNG &rng, double *buffer, int n){
+      const Ziggurat &zig(exponential_ziggurat());
+      const double *x = &zig.x[0];
+      const double *ratio = &zig.ratio[0];
+      fill_uniform(rng, buffer, n);
+      for(int i = 0; i < n; ++i){
+        double u;
+        int layer = split_uniform(buffer[i], exponential_layers, false, &u);
+        if(u < ratio[layer]){
+          buffer[i] = u * x[layer];
+        } else {
+          buffer[i] = exponential_ziggurat_slow_path(rng, zig, layer, u);
+        }
+      }
+    }
+
+    // Marsaglia and Tsang's method for shape >= 1, with unit scale.
+    void standard_gamma_batch(RNG &rng, double *buffer, int n, double shape){
+      const double d = shape - 1.0 / 3.0;
+      const double c = 1.0 / sqrt(9 * d);
+      std::vector<double> uniforms(n);
+      int filled = 0;
+      while(filled < n){
+        int remaining = n - filled;
+        double *z = buffer + filled;
+        standard_normal_batch(rng, z, remaining);
+        fill_uniform(rng, &uniforms[0], remaining);
+        // Accepted draws are packed to the front of the unfilled part
+        // of the buffer.  The write position never passes the read
+        // position, so the candidates can live in the buffer itself.
+        int position = filled;
+        for(int i = 0; i < remaining; ++i){
+          double x = z[i];
+          double v = 1 + c * x;
+          if(v <= 0) continue;
+          v = v * v * v;
+          double x2 = x * x;
+          double u = uniforms[i];
+          if(u < 1 - 0.0331 * x2 * x2
+             || log(u) < 0.5 * x2 + d * (1 - v + log(v))){
+            buffer[position++] = d * v;
+          }
+        }
+        filled = position;
+      }
+    }
+  }  // namespace
+
+  void rnorm_batch_mt(RNG &rng, double *buffer, int n,
+                      double mu, double sigma){
+    if(!std::isfinite(mu) || !std::isfinite(sigma) || sigma < 0){
+      std::ostringstream err;
+      err << "Illegal value for mu: " << mu << " or sigma: " << sigma
+          << " in rnorm_batch_mt." << std::endl;
+      report_error(err.str());
+    }
+    if(n <= 0) return;
+    standard_normal_batch(rng, buffer, n);
+    if(mu != 0 || sigma != 1){
+      for(int i = 0; i < n; ++i) buffer[i] = mu + sigma * buffer[i];
+    }
+  }
+
+  void rnorm_batch_mt(RNG &rng, Vector &ans, double mu, double sigma){
+    rnorm_batch_mt(rng, ans.data(), ans.size(), mu, sigma);
+  }
+
+  void rexp_batch_mt(RNG &rng, double *buffer, int n, double rate){
+    if(!std::isfinite(rate) || rate <= 0){
+      std::ostringstream err;
+      err << "Illegal value for rate: " << rate << " in rexp_batch_mt."
+          << std::endl;
+      report_error(err.str());
+    }
+    if(n <= 0) return;
+    standard_exponential_batch(rng, buffer, n);
+    if(rate != 1){
+      const double scale = 1.0 / rate;
+      for(int i = 0; i < n; ++i) buffer[i] *= scale;
+    }
+  }
+
+  void rexp_batch_mt(RNG &rng, Vector &ans, double rate){
+    rexp_batch_mt(rng, ans.data(), ans.size(), rate);
+  }
+
+  void rgamma_batch_mt(RNG &rng, double *buffer, int n,
+                       double shape, double rate){
+    if(!std::isfinite(shape) || !std::isfinite(rate)
+       || shape <= 0 || rate <= 0){
+      std::ostringstream err;
+      err << "Illegal value for shape: " << shape << " or rate: " << rate
+          << " in rgamma_batch_mt." << std::endl;
+      report_error(err.str());
+    }
+    if(n <= 0) return;
+    if(shape >= 1){
+      standard_gamma_batch(rng, buffer, n, shape);
+    } else {
+      // If X ~ Ga(shape + 1) and U ~ U(0, 1) then X * U^(1/shape) ~
+      // Ga(shape).
+      standard_gamma_batch(rng, buffer, n, shape + 1);
+      for(int i = 0; i < n; ++i){
+        buffer[i] *= exp(log(positive_uniform(rng)) / shape);
+      }
+    }
+    if(rate != 1){
+      const double scale = 1.0 / rate;
+      for(int i = 0; i < n; ++i) buffer[i] *= scale;
+    }
+  }
+
+  void rgamma_batch_mt(RNG &rng, Vector &ans, double shape, double rate){
+    rgamma_batch_mt(rng, ans.data(), ans.size(), shape, rate);
+  }
+
+  //======================================================================
+  BatchDrawBuffer::BatchDrawBuffer(Distribution distribution, int batch_size)
+      : distribution_(distribution),
+        buffer_(batch_size > 0 ? batch_size : 1),
+        position_(buffer_.size())
+  {}
+
+  void BatchDrawBuffer::clear(){
+    position_ = buffer_.size();
+  }
+
+  void BatchDrawBuffer::refill(RNG &rng){
+    if(distribution_ == STANDARD_NORMAL){
+      standard_normal_batch(rng, &buffer_[0], buffer_.size());
+    } else {
+      standard_exponential_batch(rng, &buffer_[0], buffer_.size());
+    }
+    position_ = 0;
+  }
+
+}
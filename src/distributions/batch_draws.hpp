@@ -0,0 +1,90 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#ifndef BOOM_DISTRIBUTIONS_BATCH_DRAWS_HPP
+#define BOOM_DISTRIBUTIONS_BATCH_DRAWS_HPP
+
+#include <distributions/rng.hpp>
+#include <LinAlg/Vector.hpp>
+#include <vector>
+
+namespace BOOM{
+
+  // Functions that fill a buffer with n independent draws.  They are
+  // much faster than n calls to rnorm_mt, rexp_mt, or rgamma_mt: the
+  // uniforms are generated in one pass over the buffer, and the
+  // transformation to the target distribution is a short, branch-light
+  // loop that usually needs a single uniform per draw.  Normal and
+  // exponential draws use the ziggurat method (Marsaglia and Tsang
+  // 2000, in the floating point form given by Doornik 2005).  Gamma
+  // draws use the Marsaglia and Tsang (2000) squeeze method, applied
+  // to the whole buffer at once, with rejected slots redrawn in a
+  // second (much shorter) pass.
+  //
+  // The draws have the same distribution as the scalar versions, but
+  // not the same values for a given RNG state.
+
+  // Fills buffer[0..n) with N(mu, sigma^2) draws.
+  void rnorm_batch_mt(RNG &rng, double *buffer, int n,
+                      double mu = 0, double sigma = 1);
+  void rnorm_batch_mt(RNG &rng, Vector &ans, double mu = 0, double sigma = 1);
+
+  // Fills buffer[0..n) with exponential draws with the given rate
+  // (mean 1/rate).
+  void rexp_batch_mt(RNG &rng, double *buffer, int n, double rate = 1);
+  void rexp_batch_mt(RNG &rng, Vector &ans, double rate = 1);
+
+  // Fills buffer[0..n) with gamma draws with mean shape/rate.
+  void rgamma_batch_mt(RNG &rng, double *buffer, int n,
+                       double shape, double rate = 1);
+  void rgamma_batch_mt(RNG &rng, Vector &ans, double shape, double rate = 1);
+
+  //======================================================================
+  // Serves standard normal or standard exponential draws one at a
+  // time, refilling an internal buffer with the batch functions above
+  // when it runs dry.  This is for loops over observations that need
+  // one or two draws each and are not easily restructured to draw
+  // everything up front, such as the data imputers used by the
+  // auxiliary mixture samplers.
+  //
+  // Not thread safe.  Each thread needs its own BatchDrawBuffer.
+  class BatchDrawBuffer{
+   public:
+    enum Distribution { STANDARD_NORMAL, STANDARD_EXPONENTIAL };
+    explicit BatchDrawBuffer(Distribution distribution,
+                             int batch_size = 256);
+
+    double draw(RNG &rng){
+      if(position_ >= buffer_.size()) refill(rng);
+      return buffer_[position_++];
+    }
+
+    // Discards any unused draws, so that the next call to draw()
+    // starts a fresh batch.
+    void clear();
+
+   private:
+    void refill(RNG &rng);
+
+    Distribution distribution_;
+    std::vector<double> buffer_;
+    std::vector<double>::size_type position_;
+  };
+
+}
+#endif// BOOM_DISTRIBUTIONS_BATCH_DRAWS_HPP
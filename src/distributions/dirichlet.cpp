@@ -115,19 +115,19 @@ namespace BOOM{
     return rdirichlet_impl(rng, nu);}
   //======================================================================
   Vec rdirichlet(const Vec & nu){
-    return rdirichlet_impl(GlobalRng::rng, nu); }
+    return rdirichlet_impl(default_rng(), nu); }
   //======================================================================
   Vec rdirichlet_mt(RNG & rng, const VectorView & nu){
     return rdirichlet_impl(rng, nu);}
   //======================================================================
   Vec rdirichlet(const VectorView & nu){
-    return rdirichlet_impl(GlobalRng::rng, nu); }
+    return rdirichlet_impl(default_rng(), nu); }
   //======================================================================
   Vec rdirichlet_mt(RNG & rng, const ConstVectorView & nu){
     return rdirichlet_impl(rng, nu);}
   //======================================================================
   Vec rdirichlet(const ConstVectorView & nu){
-    return rdirichlet_impl(GlobalRng::rng, nu); }
+    return rdirichlet_impl(default_rng(), nu); }
   //======================================================================
 
   double ddirichlet(const Vec & x, const Vec & nu, bool logscale){
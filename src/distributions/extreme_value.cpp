@@ -32,7 +32,7 @@ namespace BOOM{
   }
 
   double rexv(double loc, double scale){
-    return rexv_mt(GlobalRng::rng, loc, scale);}
+    return rexv_mt(default_rng(), loc, scale);}
 
   double rexv_mt(RNG & rng, double loc, double scale){
     if(scale==0.0) return loc;
@@ -25,7 +25,7 @@ namespace BOOM{
   double pig(double x, double mu, double lambda, bool logscale);
   double rig_mt(RNG & rng, double mu, double lambda);
   inline double rig(double mu, double lambda){
-    return rig_mt(GlobalRng::rng, mu, lambda);}
+    return rig_mt(default_rng(), mu, lambda);}
 
 }
 #endif // BOOM_INVERSE_GAUSSIAN_HPP_
@@ -70,7 +70,7 @@ namespace BOOM{
   }
 
   Mat rmatrix_normal_ivar(const Mat & Mu, const Spd &Siginv, const Spd &Ominv){
-    return rmatrix_normal_ivar_mt(GlobalRng::rng, Mu, Siginv, Ominv);}
+    return rmatrix_normal_ivar_mt(default_rng(), Mu, Siginv, Ominv);}
 
   Mat rmatrix_normal_ivar_mt(RNG & rng, const Mat & Mu,
                              const Spd &Siginv, const Spd &Ominv){
@@ -30,7 +30,7 @@
 namespace BOOM{
 
   Vec rmvn_robust(const Vec &mu, const Spd &V){
-    return rmvn_robust_mt(GlobalRng::rng, mu, V); }
+    return rmvn_robust_mt(default_rng(), mu, V); }
   Vec rmvn_robust_mt(RNG &rng, const Vec &mu, const Spd &V){
     uint n = V.nrow();
     Mat Q(n,n);
@@ -47,7 +47,7 @@ namespace BOOM{
   }
 
   Vec rmvn_L(const Vec &mu, const Mat &L){
-    return rmvn_L_mt(GlobalRng::rng, mu, L);}
+    return rmvn_L_mt(default_rng(), mu, L);}
 
   Vec rmvn_L_mt(RNG & rng, const Vec &mu, const Mat &L){
     // L is the lower cholesky triange of Sigma
@@ -58,7 +58,7 @@ namespace BOOM{
   }
   //======================================================================
   Vec rmvn(const Vec &mu, const Spd &V){
-    return rmvn_mt(GlobalRng::rng, mu, V); }
+    return rmvn_mt(default_rng(), mu, V); }
 
   Vec rmvn_mt(RNG & rng, const Vec &mu, const Spd &V){
     bool okay=true;
@@ -68,7 +68,7 @@ namespace BOOM{
   }
   //======================================================================
   Vec rmvn_ivar(const Vec &mu, const Spd &ivar){
-    return rmvn_ivar_mt(GlobalRng::rng, mu, ivar);  }
+    return rmvn_ivar_mt(default_rng(), mu, ivar);  }
 
   Vec rmvn_ivar_mt(RNG & rng, const Vec &mu, const Spd &ivar){
     // draws a multivariate normal with mean mu and inverse variance
@@ -78,7 +78,7 @@ namespace BOOM{
   }
 
   Vec rmvn_ivar_U(const Vec &mu, const Mat &U){
-    return rmvn_ivar_U_mt(GlobalRng::rng, mu, U); }
+    return rmvn_ivar_U_mt(default_rng(), mu, U); }
 
   Vec rmvn_ivar_U_mt(RNG & rng, const Vec &mu, const Mat &U){
     // U is the upper cholesky factor of the inverse variance Matrix
@@ -90,14 +90,14 @@ namespace BOOM{
   }
 
   Vec rmvn_ivar_L(const Vec &mu, const Mat &L){
-    return rmvn_ivar_L_mt(GlobalRng::rng, mu, L);  }
+    return rmvn_ivar_L_mt(default_rng(), mu, L);  }
   Vec rmvn_ivar_L_mt(RNG & rng, const Vec &mu, const Mat &L){
     // L is the lower cholesky triangle  of the inverse variance Matrix
     return rmvn_ivar_U_mt(rng, mu, L.t());  }
 
 
   Vec rmvn_suf(const Spd & Ivar, const Vec & IvarMu){
-    return rmvn_suf_mt(GlobalRng::rng, Ivar, IvarMu);  }
+    return rmvn_suf_mt(default_rng(), Ivar, IvarMu);  }
 
   Vec rmvn_suf_mt(RNG & rng, const Spd & Ivar, const Vec & IvarMu){
     Chol L(Ivar);
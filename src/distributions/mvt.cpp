@@ -43,7 +43,7 @@ namespace BOOM{
   //======================================================================
 
   Vec rmvt(const Vec &mu, const Spd &Sigma, double nu){
-    return rmvt_mt(GlobalRng::rng, mu, Sigma, nu);}
+    return rmvt_mt(default_rng(), mu, Sigma, nu);}
 
   Vec rmvt_mt(RNG & rng, const Vec &mu, const Spd &Sigma, double nu){
     double w = rgamma_mt(rng, nu/2, nu/2);
@@ -51,7 +51,7 @@ namespace BOOM{
   }
 
   Vec rmvt_ivar(const Vec &mu, const Spd &ivar, double nu){
-    return rmvt_ivar_mt(GlobalRng::rng, mu, ivar, nu);  }
+    return rmvt_ivar_mt(default_rng(), mu, ivar, nu);  }
 
   Vec rmvt_ivar_mt(RNG & rng, const Vec &mu, const Spd &ivar, double nu){
     double w = rgamma_mt(rng, nu/2,nu/2);
@@ -0,0 +1,41 @@
+/*
+  Copyright (C) 2005-2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+#ifndef BOOM_POLYA_GAMMA_HPP_
+#define BOOM_POLYA_GAMMA_HPP_
+#include <distributions.hpp>
+
+namespace BOOM{
+
+  // Draws from the Polya-Gamma distribution PG(b, z) of Polson,
+  // Scott and Windle (2013, JASA), the mixing distribution that makes
+  // the logistic likelihood conditionally Gaussian.  If omega ~
+  // PG(b, z) then E(omega) = b * tanh(z/2) / (2z).
+  //
+  // b must be a positive integer.  PG(1, z) is drawn exactly using
+  // Devroye's alternating series method, and PG(b, z) is the sum of b
+  // independent PG(1, z) draws, so the cost is linear in b.
+  double rpg_mt(RNG &rng, int b, double z);
+  inline double rpg(int b, double z){
+    return rpg_mt(default_rng(), b, z);}
+
+  // The mean and variance of PG(b, z).
+  double pg_mean(double b, double z);
+  double pg_variance(double b, double z);
+
+}
+#endif // BOOM_POLYA_GAMMA_HPP_
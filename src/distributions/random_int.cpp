@@ -19,7 +19,7 @@
 #include <cmath>
 namespace BOOM{
   int random_int(int lo, int hi){
-    return random_int_mt(GlobalRng::rng, lo, hi);  }
+    return random_int_mt(default_rng(), lo, hi);  }
 
   int random_int_mt(RNG & rng, int lo, int hi){
     double tmp = runif_mt(rng, lo, hi+1);
@@ -20,7 +20,7 @@
 namespace BOOM{
 
   double rlexp(double loglam){
-    return rlexp_mt(GlobalRng::rng, loglam); }
+    return rlexp_mt(default_rng(), loglam); }
 
   double rlexp_mt(RNG & rng, double loglam){
     double ans;
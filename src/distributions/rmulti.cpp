@@ -29,7 +29,7 @@ using namespace std;
 namespace BOOM{
 
   int rmulti(int lo, int hi){
-    return rmulti_mt(GlobalRng::rng, lo, hi);}
+    return rmulti_mt(default_rng(), lo, hi);}
 
   int rmulti_mt(RNG & rng, int lo, int hi){
     // draw a random integer between lo and hi with equal probability
@@ -79,8 +79,8 @@ namespace BOOM{
   uint rmulti_mt(RNG &rng, const VectorView &prob){ return rmulti_mt_impl(rng, prob); }
   uint rmulti_mt(RNG &rng, const ConstVectorView &prob){ return rmulti_mt_impl(rng, prob); }
 
-  uint rmulti(const Vec &prob){return rmulti_mt_impl(GlobalRng::rng, prob);}
-  uint rmulti(const VectorView &prob){return rmulti_mt_impl(GlobalRng::rng, prob);}
-  uint rmulti(const ConstVectorView &prob){return rmulti_mt_impl(GlobalRng::rng, prob);}
+  uint rmulti(const Vec &prob){return rmulti_mt_impl(default_rng(), prob);}
+  uint rmulti(const VectorView &prob){return rmulti_mt_impl(default_rng(), prob);}
+  uint rmulti(const ConstVectorView &prob){return rmulti_mt_impl(default_rng(), prob);}
 
 }
@@ -21,6 +21,9 @@
 #include <distributions.hpp>
 #include <cpputil/math_utils.hpp>
 #include <ctime>
+#ifndef NO_BOOST_THREADS
+#include <boost/thread/tss.hpp>
+#endif
 
 namespace BOOM{
 
@@ -34,11 +37,75 @@ namespace BOOM{
   }
 
   unsigned long seed_rng(){
-    return seed_rng(GlobalRng::rng);
+    return seed_rng(default_rng());
+  }
+
+  RNG rng_stream(unsigned long seed, unsigned int stream){
+#ifdef BOOM_USE_XOSHIRO_RNG
+    RNG ans(seed);
+    for(unsigned int i = 0; i < stream; ++i) ans.jump();
+    return ans;
+#else
+    // Mix seed and stream with the splitmix64 finalizer so that
+    // consecutive streams get unrelated seeds.
+    unsigned long long z = seed + 0x9e3779b97f4a7c15ULL * (stream + 1ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    return RNG(static_cast<unsigned long>(z));
+#endif
+  }
+
+  std::vector<RNG> rng_streams(unsigned long seed, int number_of_streams){
+    std::vector<RNG> ans;
+    ans.reserve(number_of_streams);
+#ifdef BOOM_USE_XOSHIRO_RNG
+    RNG rng(seed);
+    for(int i = 0; i < number_of_streams; ++i){
+      ans.push_back(rng);
+      rng.jump();
+    }
+#else
+    for(int i = 0; i < number_of_streams; ++i){
+      ans.push_back(rng_stream(seed, i));
+    }
+#endif
+    return ans;
   }
 
   RNG GlobalRng::rng(8675309);
 
+  namespace {
+    // The RNG installed by the innermost ThreadRngScope in the
+    // current thread, or NULL if there is none.  The cleanup function
+    // does nothing because the RNG is owned by the caller.
+    void do_not_delete_rng(RNG *) {}
+#ifndef NO_BOOST_THREADS
+    boost::thread_specific_ptr<RNG> thread_rng(do_not_delete_rng);
+    RNG * get_thread_rng() { return thread_rng.get(); }
+    void set_thread_rng(RNG *rng) { thread_rng.reset(rng); }
+#else
+    RNG *thread_rng = NULL;
+    RNG * get_thread_rng() { return thread_rng; }
+    void set_thread_rng(RNG *rng) { thread_rng = rng; }
+#endif
+  }  // namespace
+
+  RNG & default_rng(){
+    RNG *rng = get_thread_rng();
+    return rng ? *rng : GlobalRng::rng;
+  }
+
+  ThreadRngScope::ThreadRngScope(RNG &rng)
+      : previous_(get_thread_rng())
+  {
+    set_thread_rng(&rng);
+  }
+
+  ThreadRngScope::~ThreadRngScope(){
+    set_thread_rng(previous_);
+  }
+
   void GlobalRng::seed_with_timestamp(){
     long seed = static_cast<long>(time(NULL));
     rng.seed(seed);
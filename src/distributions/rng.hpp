@@ -19,10 +19,26 @@
 #ifndef BOOM_DISTRIBUTIONS_RNG_HPP
 #define BOOM_DISTRIBUTIONS_RNG_HPP
 
+// The engine behind the RNG typedef is chosen at compile time.  The
+// default is boost's ranlux64_base_01.  Define BOOM_USE_XOSHIRO_RNG to
+// use the much faster xoshiro256++ generator instead.  Both engines
+// return doubles on [0, 1) from operator(), so code using RNG works
+// with either, but the streams produced from a given seed differ.
+//
+// ranlux.hpp is included in either case because many files rely on
+// the standard headers that it brings in.
 #include <boost/random/ranlux.hpp>
+#include <vector>
+#ifdef BOOM_USE_XOSHIRO_RNG
+#include <distributions/xoshiro.hpp>
+#endif
 
 namespace BOOM{
+#ifdef BOOM_USE_XOSHIRO_RNG
+typedef Xoshiro256PlusPlus RNG;
+#else
 typedef boost::random::ranlux64_base_01 RNG;
+#endif
 
 struct GlobalRng{
  public:
@@ -33,6 +49,43 @@ struct GlobalRng{
 unsigned long seed_rng();  // generates a random seed from the global RNG
                            // used to seed other RNG's
 unsigned long seed_rng(RNG &);
+
+// Returns an RNG for stream number 'stream' of the given seed, for use
+// by one of several threads or MCMC chains.  With xoshiro256++ the
+// stream is obtained by jumping ahead 'stream' * 2^128 steps, so
+// streams from the same seed never overlap.  ranlux64_base_01 cannot
+// jump ahead, so its streams are seeded from a hash of (seed, stream),
+// which makes overlap unlikely but not impossible.
+RNG rng_stream(unsigned long seed, unsigned int stream);
+
+// Returns streams 0, 1, ..., number_of_streams - 1 of the given seed,
+// the same RNG's as rng_stream() would give one at a time.  With
+// xoshiro256++ this takes one jump per stream instead of 'stream'.
+std::vector<RNG> rng_streams(unsigned long seed, int number_of_streams);
+
+// Returns the RNG used by random number functions that are called
+// without an explicit RNG argument (e.g. rnorm(mu, sigma)).  This is
+// GlobalRng::rng unless the calling thread has installed its own RNG
+// with a ThreadRngScope.  Each call costs a thread-local lookup, so
+// loops that make many draws should call it once and pass the result
+// to the _mt functions.
+RNG & default_rng();
+
+// While a ThreadRngScope is alive, default_rng() returns 'rng' in the
+// thread that created the scope.  Other threads are unaffected.
+// Worker threads should create one at the top of their entry point,
+// so that library code calling rnorm(), rmulti(), etc. without an
+// explicit RNG never touches the shared GlobalRng::rng.  Scopes may
+// be nested.  The RNG must outlive the scope.
+class ThreadRngScope {
+ public:
+  explicit ThreadRngScope(RNG &rng);
+  ~ThreadRngScope();
+ private:
+  RNG *previous_;
+  ThreadRngScope(const ThreadRngScope &);
+  ThreadRngScope & operator=(const ThreadRngScope &);
+};
 }
 
 #endif// BOOM_DISTRIBUTIONS_RNG_HPP
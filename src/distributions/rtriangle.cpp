@@ -26,7 +26,7 @@
 
 namespace BOOM{
    double rtriangle(double x0, double x1, double xm){
-     return rtriangle_mt(GlobalRng::rng, x0, x1, xm);}
+     return rtriangle_mt(default_rng(), x0, x1, xm);}
 
    double rtriangle_mt(RNG & rng, double x0, double x1, double xm){
 
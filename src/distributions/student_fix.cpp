@@ -41,7 +41,7 @@ namespace BOOM{
   /*======================================================================*/
 
   double rstudent(double mu, double sigma, double df){
-    return rstudent_mt(GlobalRng::rng, mu, sigma, df);  }
+    return rstudent_mt(default_rng(), mu, sigma, df);  }
 
   double rstudent_mt(RNG & rng, double mu, double sigma, double df){
     double w=rgamma_mt(rng, df/2.0, df/2.0);
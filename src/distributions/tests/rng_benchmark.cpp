@@ -0,0 +1,100 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+// Reports draws per second for runif, rnorm and rgamma.
+//
+// The raw uniform rate is measured for both engines in every build.
+// The Bmath draws can only use the engine behind the RNG typedef, so
+// to compare them build the library and this program twice:
+//
+//   make rng_benchmark && ./rng_benchmark
+//   make clean
+//   make CXXFLAGS="-Isrc -O2 -DBOOM_USE_XOSHIRO_RNG" rng_benchmark
+//   ./rng_benchmark
+
+#include <distributions.hpp>
+#include <distributions/xoshiro.hpp>
+#include <boost/random/ranlux.hpp>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+
+namespace {
+  using namespace BOOM;
+
+  void report(const char *engine, const char *what, long ndraws,
+              clock_t start, clock_t end, double checksum){
+    double seconds = double(end - start) / CLOCKS_PER_SEC;
+    std::cout << engine << "\t" << what << "\t";
+    if(seconds > 0) {
+      std::cout << ndraws / seconds;
+    } else {
+      std::cout << "inf";
+    }
+    // Printing the checksum keeps the compiler from discarding the
+    // draws.
+    std::cout << " draws/sec\t(checksum " << checksum << ")" << std::endl;
+  }
+
+  template <class ENGINE>
+  void time_engine(const char *engine, long ndraws){
+    ENGINE rng(8675309);
+    double total = 0;
+    clock_t start = clock();
+    for(long i = 0; i < ndraws; ++i) total += rng();
+    clock_t end = clock();
+    report(engine, "engine", ndraws, start, end, total);
+  }
+
+  void time_bmath_draws(long ndraws){
+#ifdef BOOM_USE_XOSHIRO_RNG
+    const char *engine = "xoshiro256++";
+#else
+    const char *engine = "ranlux64_base_01";
+#endif
+    RNG rng(8675309);
+
+    double total = 0;
+    clock_t start = clock();
+    for(long i = 0; i < ndraws; ++i) total += runif_mt(rng, 0, 1);
+    clock_t end = clock();
+    report(engine, "runif", ndraws, start, end, total);
+
+    total = 0;
+    start = clock();
+    for(long i = 0; i < ndraws; ++i) total += rnorm_mt(rng, 0, 1);
+    end = clock();
+    report(engine, "rnorm", ndraws, start, end, total);
+
+    total = 0;
+    start = clock();
+    for(long i = 0; i < ndraws; ++i) total += rgamma_mt(rng, 2.5, 1.0);
+    end = clock();
+    report(engine, "rgamma", ndraws, start, end, total);
+  }
+}  // namespace
+
+int main(int argc, char **argv){
+  long ndraws = 10000000;
+  if(argc > 1) ndraws = atol(argv[1]);
+
+  time_engine<boost::random::ranlux64_base_01>("ranlux64_base_01", ndraws);
+  time_engine<BOOM::Xoshiro256PlusPlus>("xoshiro256++", ndraws);
+  time_bmath_draws(ndraws);
+  return 0;
+}
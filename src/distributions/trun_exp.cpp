@@ -34,6 +34,6 @@ double rtrun_exp_mt(RNG & rng, double lam, double lo, double hi){
 }
 
 double rtrun_exp(double lam, double lo, double hi){
-  return rtrun_exp_mt(GlobalRng::rng, lam, lo, hi); }
+  return rtrun_exp_mt(default_rng(), lam, lo, hi); }
 
 }
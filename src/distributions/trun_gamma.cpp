@@ -63,7 +63,7 @@ namespace BOOM{
 
 
   double rtrun_gamma(double a,double b,double cut, unsigned n){
-    return rtrun_gamma_mt(GlobalRng::rng, a, b, cut, n);}
+    return rtrun_gamma_mt(default_rng(), a, b, cut, n);}
 
   double rtrun_gamma_mt(RNG & rng, double a,double b,double cut, unsigned n){
     double mode = (a-1)/b;
@@ -27,10 +27,10 @@
  /*======================================================================*/
  namespace BOOM{
    double trun_norm(double a){
-     return trun_norm_mt(GlobalRng::rng, a);}
+     return trun_norm_mt(default_rng(), a);}
 
    double rtrun_norm(double mu, double sigma, double a, bool gt){
-     return rtrun_norm_mt(GlobalRng::rng, mu, sigma, a, gt);}
+     return rtrun_norm_mt(default_rng(), mu, sigma, a, gt);}
 
    double rtrun_norm_mt(RNG & rng, double mu, double sigma, double a, bool gt){
      /* draws a truncated normal deviate from the normal distribution
@@ -329,6 +329,6 @@
   }
 
   double rtrun_norm_2(double mu, double sigma, double lo, double hi){
-    return rtrun_norm_2_mt(GlobalRng::rng, mu, sigma, lo, hi);
+    return rtrun_norm_2_mt(default_rng(), mu, sigma, lo, hi);
   }
 }
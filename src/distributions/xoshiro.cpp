@@ -0,0 +1,92 @@
+/*
+  Copyright (C) 2013 Steven L. Scott
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+*/
+
+#include <distributions/xoshiro.hpp>
+
+namespace BOOM{
+
+  namespace {
+    boost::uint64_t splitmix64(boost::uint64_t &x){
+      boost::uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      return z ^ (z >> 31);
+    }
+
+    // The characteristic polynomials used by jump() and long_jump(),
+    // from the reference implementation.
+    const boost::uint64_t jump_polynomial[] = {
+      0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+      0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+    const boost::uint64_t long_jump_polynomial[] = {
+      0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL,
+      0x77710069854ee241ULL, 0x39109bb02acbe635ULL };
+
+    // The seed used by the default constructor, chosen to match the
+    // default seed of GlobalRng::rng.
+    const unsigned long default_seed = 8675309;
+  }  // namespace
+
+  typedef Xoshiro256PlusPlus XRNG;
+
+  XRNG::Xoshiro256PlusPlus(){
+    seed();
+  }
+
+  XRNG::Xoshiro256PlusPlus(unsigned long s){
+    seed(s);
+  }
+
+  void XRNG::seed(){
+    seed(default_seed);
+  }
+
+  void XRNG::seed(unsigned long s){
+    boost::uint64_t x = s;
+    for(int i = 0; i < 4; ++i) state_[i] = splitmix64(x);
+  }
+
+  void XRNG::jump(){
+    apply_jump(jump_polynomial);
+  }
+
+  void XRNG::long_jump(){
+    apply_jump(long_jump_polynomial);
+  }
+
+  void XRNG::apply_jump(const boost::uint64_t *polynomial){
+    boost::uint64_t s[4] = {0, 0, 0, 0};
+    for(int i = 0; i < 4; ++i){
+      for(int b = 0; b < 64; ++b){
+        if(polynomial[i] & (boost::uint64_t(1) << b)){
+          for(int j = 0; j < 4; ++j) s[j] ^= state_[j];
+        }
+        next();
+      }
+    }
+    for(int j = 0; j < 4; ++j) state_[j] = s[j];
+  }
+
+  bool operator==(const XRNG &lhs, const XRNG &rhs){
+    for(int i = 0; i < 4; ++i){
+      if(lhs.state_[i] != rhs.state_[i]) return false;
+    }
+    return true;
+  }
+
+}